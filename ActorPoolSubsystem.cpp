@@ -0,0 +1,227 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ActorPoolSubsystem.h"
+#include "FirstProyect2.h"
+#include "Poolable.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Actor Pool Acquire"), STAT_ActorPoolAcquire, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("Actor Pool Release"), STAT_ActorPoolRelease, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool Hits"), STAT_ActorPoolHits, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool Misses (Spawned)"), STAT_ActorPoolMisses, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool Exhausted"), STAT_ActorPoolExhausted, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Actors Free"), STAT_ActorPoolFree, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Actors Active"), STAT_ActorPoolActive, STATGROUP_FirstProyect2);
+
+UActorPoolSubsystem::UActorPoolSubsystem()
+{
+	MaxFreePerClass = 128;
+}
+
+void UActorPoolSubsystem::Deinitialize()
+{
+	Pools.Reset();
+	ActiveActors.Reset();
+
+	Super::Deinitialize();
+}
+
+void UActorPoolSubsystem::Prewarm(TSubclassOf<AActor> Class, int32 Count, const FTransform& Transform)
+{
+	if (!Class || !Class->ImplementsInterface(UPoolable::StaticClass())) return;
+
+	Count = FMath::Min(Count, MaxFreePerClass);
+
+	while (Pools.FindOrAdd(Class).Free.Num() < Count)
+	{
+		AActor* Actor = SpawnForPool(Class, Transform);
+		if (!Actor) break;
+
+		Deactivate(Actor);
+
+		FClassPool& Pool = Pools.FindOrAdd(Class);
+		Pool.Free.Add(Actor);
+		Pool.NumPrewarmed++;
+	}
+
+	UpdateStats();
+}
+
+AActor* UActorPoolSubsystem::SpawnForPool(UClass* Class, const FTransform& Transform)
+{
+	// Prewarmed instances all start stacked on the same spot
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld()->SpawnActor<AActor>(Class, Transform, SpawnParams);
+}
+
+void UActorPoolSubsystem::Activate(AActor* Actor)
+{
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+
+	if (Actor->GetClass()->ImplementsInterface(UPoolable::StaticClass()))
+	{
+		IPoolable::Execute_OnAcquiredFromPool(Actor);
+	}
+}
+
+void UActorPoolSubsystem::Deactivate(AActor* Actor)
+{
+	if (Actor->GetClass()->ImplementsInterface(UPoolable::StaticClass()))
+	{
+		IPoolable::Execute_OnReleasedToPool(Actor);
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+}
+
+AActor* UActorPoolSubsystem::AcquireActor(TSubclassOf<AActor> Class, const FTransform& Transform)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ActorPoolAcquire);
+
+	if (!Class) return nullptr;
+
+	FClassPool& Pool = Pools.FindOrAdd(Class);
+
+	AActor* Actor = nullptr;
+	while (!Actor && Pool.Free.Num() > 0)
+	{
+		Actor = Pool.Free.Pop(false).Get();
+	}
+
+	if (Actor)
+	{
+		Pool.Hits++;
+		INC_DWORD_STAT(STAT_ActorPoolHits);
+
+		Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+		Activate(Actor);
+	}
+	else
+	{
+		Pool.Misses++;
+		INC_DWORD_STAT(STAT_ActorPoolMisses);
+		if (Pool.NumPrewarmed > 0)
+		{
+			Pool.Exhausted++;
+			INC_DWORD_STAT(STAT_ActorPoolExhausted);
+		}
+
+		Actor = GetWorld()->SpawnActor<AActor>(Class, Transform);
+		if (!Actor) return nullptr;
+	}
+
+	// BeginPlay of a fresh spawn may have added pools, so look it up again
+	FClassPool& ActivePool = Pools.FindOrAdd(Class);
+	ActivePool.NumActive++;
+	ActivePool.PeakActive = FMath::Max(ActivePool.PeakActive, ActivePool.NumActive);
+	ActiveActors.Add(Actor);
+
+	UpdateStats();
+	return Actor;
+}
+
+void UActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ActorPoolRelease);
+
+	if (!Actor || Actor->IsPendingKillPending()) return;
+
+	FClassPool& Pool = Pools.FindOrAdd(Actor->GetClass());
+	if (ActiveActors.Remove(Actor) > 0)
+	{
+		Pool.NumActive--;
+	}
+
+	if (!Actor->GetClass()->ImplementsInterface(UPoolable::StaticClass()))
+	{
+		Actor->Destroy();
+	}
+	else if (Actor->HasAnyFlags(RF_WasLoaded))
+	{
+		// Level placed actors are parked instead of joining the free list, UWorldStateSubsystem finds them by name and may unpark them
+		if (!Actor->IsHidden())
+		{
+			Deactivate(Actor);
+		}
+	}
+	else if (Pool.Free.Num() >= MaxFreePerClass)
+	{
+		Actor->Destroy();
+	}
+	else if (!Pool.Free.Contains(Actor))
+	{
+		Deactivate(Actor);
+		Pool.Free.Add(Actor);
+	}
+
+	UpdateStats();
+}
+
+void UActorPoolSubsystem::ReleaseOrDestroy(AActor* Actor)
+{
+	if (!Actor) return;
+
+	UWorld* World = Actor->GetWorld();
+	UActorPoolSubsystem* Pool = World ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr;
+	if (Pool)
+	{
+		Pool->ReleaseActor(Actor);
+	}
+	else
+	{
+		Actor->Destroy();
+	}
+}
+
+void UActorPoolSubsystem::UnparkActor(AActor* Actor)
+{
+	if (!Actor || Actor->IsPendingKillPending() || !Actor->HasAnyFlags(RF_WasLoaded) || !Actor->IsHidden()) return;
+	if (!Actor->GetClass()->ImplementsInterface(UPoolable::StaticClass())) return;
+
+	Activate(Actor);
+}
+
+void UActorPoolSubsystem::UpdateStats() const
+{
+	int32 NumFree = 0;
+	int32 NumActive = 0;
+	for (const TPair<UClass*, FClassPool>& Pair : Pools)
+	{
+		NumFree += Pair.Value.Free.Num();
+		NumActive += Pair.Value.NumActive;
+	}
+
+	SET_DWORD_STAT(STAT_ActorPoolFree, NumFree);
+	SET_DWORD_STAT(STAT_ActorPoolActive, NumActive);
+}
+
+void UActorPoolSubsystem::DumpStats() const
+{
+	UE_LOG(LogTemp, Display, TEXT("Actor pools (%d classes)"), Pools.Num());
+	for (const TPair<UClass*, FClassPool>& Pair : Pools)
+	{
+		const FClassPool& Pool = Pair.Value;
+		UE_LOG(LogTemp, Display, TEXT("  %-40s free %4d  active %4d  peak %4d  prewarmed %4d  hits %6d  misses %6d  exhausted %6d"),
+			*GetNameSafe(Pair.Key), Pool.Free.Num(), Pool.NumActive, Pool.PeakActive, Pool.NumPrewarmed, Pool.Hits, Pool.Misses, Pool.Exhausted);
+	}
+}
+
+static void DumpActorPoolStats(UWorld* World)
+{
+	if (UActorPoolSubsystem* Pool = World ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr)
+	{
+		Pool->DumpStats();
+	}
+}
+
+static FAutoConsoleCommandWithWorld ActorPoolStatsCommand(
+	TEXT("FirstProyect2.PoolStats"),
+	TEXT("Logs free/active counts, hits, misses and exhaustion for every actor pool."),
+	FConsoleCommandWithWorldDelegate::CreateStatic(&DumpActorPoolStats));
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ActorPoolSubsystem.generated.h"
+
+/**
+ * Per-class pools of hidden, collision-less actors. Acquire hands out a pooled instance when one is
+ * free and spawns otherwise; Release parks actors that implement IPoolable and destroys the rest.
+ * Released level placed actors stay parked where they are instead of joining the free list.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UActorPoolSubsystem();
+
+	virtual void Deinitialize() override;
+
+	/** Spawns instances of Class at Transform until Count are waiting in its pool */
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	void Prewarm(TSubclassOf<AActor> Class, int32 Count, const FTransform& Transform);
+
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	AActor* AcquireActor(TSubclassOf<AActor> Class, const FTransform& Transform);
+
+	template<class T>
+	T* Acquire(TSubclassOf<AActor> Class, const FTransform& Transform)
+	{
+		return Cast<T>(AcquireActor(Class, Transform));
+	}
+
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	void ReleaseActor(AActor* Actor);
+
+	/** Pooled instances kept per class, anything released beyond this is destroyed */
+	int32 MaxFreePerClass;
+
+	/** Writes per-class hit/miss/exhaustion counts to the log */
+	void DumpStats() const;
+
+	/** Release with a Destroy() fallback for worlds without the subsystem */
+	static void ReleaseOrDestroy(AActor* Actor);
+
+	/** Brings a parked level placed actor back where it is, for restoring a save from before it was released */
+	void UnparkActor(AActor* Actor);
+
+private:
+
+	struct FClassPool
+	{
+		TArray<TWeakObjectPtr<AActor>> Free;
+
+		int32 NumActive = 0;
+		int32 PeakActive = 0;
+		int32 NumPrewarmed = 0;
+
+		int32 Hits = 0;
+		int32 Misses = 0;
+
+		/** Misses after the pool had been prewarmed, i.e. the prewarm count was too low */
+		int32 Exhausted = 0;
+	};
+
+	AActor* SpawnForPool(UClass* Class, const FTransform& Transform);
+
+	void Activate(AActor* Actor);
+	void Deactivate(AActor* Actor);
+
+	void UpdateStats() const;
+
+	TMap<UClass*, FClassPool> Pools;
+
+	/** Handed out by Acquire and not released yet, level placed actors are not counted as active */
+	TSet<TWeakObjectPtr<AActor>> ActiveActors;
+};
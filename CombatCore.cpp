@@ -0,0 +1,314 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatCore.h"
+
+namespace CombatCore
+{
+	bool StepStamina(FStamina& State, const FStaminaRules& Rules, bool bSprintHeld, bool bMoving, float DeltaTime)
+	{
+		const float DeltaStamina = Rules.DrainRate * DeltaTime;
+		const bool bWantsSprint = bSprintHeld && bMoving;
+
+		switch (State.Status)
+		{
+		case EStaminaStatus::Normal:
+			if (bWantsSprint)
+			{
+				if (State.Stamina - DeltaStamina <= Rules.MinSprintStamina)
+				{
+					State.Status = EStaminaStatus::BelowMinimum;
+				}
+				State.Stamina -= DeltaStamina;
+				return true;
+			}
+			State.Stamina = State.Stamina + DeltaStamina >= Rules.MaxStamina ? Rules.MaxStamina : State.Stamina + DeltaStamina;
+			return false;
+
+		case EStaminaStatus::BelowMinimum:
+			if (bWantsSprint)
+			{
+				if (State.Stamina - DeltaStamina <= 0.f)
+				{
+					State.Status = EStaminaStatus::Exhausted;
+					State.Stamina = 0.f;
+					return false;
+				}
+				State.Stamina -= DeltaStamina;
+				return true;
+			}
+			if (State.Stamina + DeltaStamina >= Rules.MinSprintStamina)
+			{
+				State.Status = EStaminaStatus::Normal;
+			}
+			State.Stamina += DeltaStamina;
+			return false;
+
+		case EStaminaStatus::Exhausted:
+			if (bSprintHeld)
+			{
+				State.Stamina = 0.f;
+			}
+			else
+			{
+				State.Status = EStaminaStatus::ExhaustedRecovering;
+				State.Stamina += DeltaStamina;
+			}
+			return false;
+
+		case EStaminaStatus::ExhaustedRecovering:
+			if (State.Stamina + DeltaStamina >= Rules.MinSprintStamina)
+			{
+				State.Status = EStaminaStatus::Normal;
+			}
+			State.Stamina += DeltaStamina;
+			return false;
+		}
+
+		return false;
+	}
+
+	namespace
+	{
+		bool WantsSprint(const FStaminaTimeline& Timeline)
+		{
+			return Timeline.bSprintHeld && Timeline.bMoving;
+		}
+
+		/** Value Seconds after the anchor, assuming no transition happens before */
+		float StaminaAfter(const FStaminaTimeline& Timeline, const FStaminaRules& Rules, double Seconds)
+		{
+			const float Delta = static_cast<float>(Rules.DrainRate * Seconds);
+
+			switch (Timeline.Status)
+			{
+			case EStaminaStatus::Normal:
+				if (WantsSprint(Timeline)) return Timeline.Stamina - Delta;
+				return Timeline.Stamina + Delta >= Rules.MaxStamina ? Rules.MaxStamina : Timeline.Stamina + Delta;
+
+			case EStaminaStatus::BelowMinimum:
+				return WantsSprint(Timeline) ? Timeline.Stamina - Delta : Timeline.Stamina + Delta;
+
+			case EStaminaStatus::Exhausted:
+				return Timeline.bSprintHeld ? 0.f : Timeline.Stamina;
+
+			case EStaminaStatus::ExhaustedRecovering:
+				return Timeline.Stamina + Delta;
+			}
+
+			return Timeline.Stamina;
+		}
+
+		/** Next status change with the current input; transitions land exactly on their threshold */
+		bool NextTransition(const FStaminaTimeline& Timeline, const FStaminaRules& Rules, double& OutSeconds, EStaminaStatus& OutStatus, float& OutStamina)
+		{
+			const double Rate = Rules.DrainRate;
+
+			switch (Timeline.Status)
+			{
+			case EStaminaStatus::Normal:
+				if (!WantsSprint(Timeline) || Rate <= 0.0) return false;
+				OutSeconds = (Timeline.Stamina - Rules.MinSprintStamina) / Rate;
+				OutStatus = EStaminaStatus::BelowMinimum;
+				OutStamina = Rules.MinSprintStamina;
+				break;
+
+			case EStaminaStatus::BelowMinimum:
+				if (Rate <= 0.0) return false;
+				if (WantsSprint(Timeline))
+				{
+					OutSeconds = Timeline.Stamina / Rate;
+					OutStatus = EStaminaStatus::Exhausted;
+					OutStamina = 0.f;
+				}
+				else
+				{
+					OutSeconds = (Rules.MinSprintStamina - Timeline.Stamina) / Rate;
+					OutStatus = EStaminaStatus::Normal;
+					OutStamina = Rules.MinSprintStamina;
+				}
+				break;
+
+			case EStaminaStatus::Exhausted:
+				if (Timeline.bSprintHeld) return false;
+				OutSeconds = 0.0;
+				OutStatus = EStaminaStatus::ExhaustedRecovering;
+				OutStamina = Timeline.Stamina;
+				break;
+
+			case EStaminaStatus::ExhaustedRecovering:
+				if (Rate <= 0.0) return false;
+				OutSeconds = (Rules.MinSprintStamina - Timeline.Stamina) / Rate;
+				OutStatus = EStaminaStatus::Normal;
+				OutStamina = Rules.MinSprintStamina;
+				break;
+
+			default:
+				return false;
+			}
+
+			// Already past the threshold (loaded or edited values): transition now and keep the value
+			if (OutSeconds <= 0.0)
+			{
+				OutSeconds = 0.0;
+				OutStamina = OutStatus == EStaminaStatus::Exhausted ? 0.f : Timeline.Stamina;
+			}
+			return true;
+		}
+	}
+
+	void AdvanceStamina(FStaminaTimeline& Timeline, const FStaminaRules& Rules, double Now)
+	{
+		// Every chain of transitions ends in a state without one after at most four steps
+		for (int32_t Step = 0; Step < 8; Step++)
+		{
+			// Zero-length steps still apply transitions that are due right now
+			const double Remaining = Now - Timeline.AnchorTime;
+			if (Remaining < 0.0) return;
+
+			double Seconds;
+			EStaminaStatus NextStatus;
+			float NextStamina;
+			if (!NextTransition(Timeline, Rules, Seconds, NextStatus, NextStamina) || Seconds > Remaining)
+			{
+				Timeline.Stamina = StaminaAfter(Timeline, Rules, Remaining);
+				Timeline.AnchorTime = Now;
+				return;
+			}
+
+			Timeline.Stamina = NextStamina;
+			Timeline.AnchorTime += Seconds;
+			Timeline.Status = NextStatus;
+		}
+
+		Timeline.AnchorTime = Now;
+	}
+
+	void SetStaminaInput(FStaminaTimeline& Timeline, const FStaminaRules& Rules, double Now, bool bSprintHeld, bool bMoving)
+	{
+		AdvanceStamina(Timeline, Rules, Now);
+		Timeline.bSprintHeld = bSprintHeld;
+		Timeline.bMoving = bMoving;
+
+		// Releasing sprint while exhausted starts recovering in the same instant
+		AdvanceStamina(Timeline, Rules, Now);
+	}
+
+	float EvaluateStamina(const FStaminaTimeline& Timeline, const FStaminaRules& Rules, double Now)
+	{
+		FStaminaTimeline Copy = Timeline;
+		AdvanceStamina(Copy, Rules, Now);
+		return Copy.Stamina;
+	}
+
+	double TimeToNextStaminaTransition(const FStaminaTimeline& Timeline, const FStaminaRules& Rules)
+	{
+		double Seconds;
+		EStaminaStatus NextStatus;
+		float NextStamina;
+		return NextTransition(Timeline, Rules, Seconds, NextStatus, NextStamina) ? Seconds : -1.0;
+	}
+
+	bool IsSprinting(const FStaminaTimeline& Timeline)
+	{
+		return WantsSprint(Timeline) && (Timeline.Status == EStaminaStatus::Normal || Timeline.Status == EStaminaStatus::BelowMinimum);
+	}
+
+	bool IsStaminaChanging(const FStaminaTimeline& Timeline, const FStaminaRules& Rules)
+	{
+		if (Rules.DrainRate <= 0.f) return false;
+
+		switch (Timeline.Status)
+		{
+		case EStaminaStatus::Normal:
+			return WantsSprint(Timeline) || Timeline.Stamina < Rules.MaxStamina;
+
+		case EStaminaStatus::Exhausted:
+			return !Timeline.bSprintHeld;
+
+		default:
+			return true;
+		}
+	}
+
+	bool ApplyDamage(float& Health, float Amount)
+	{
+		const bool bLethal = Health - Amount <= 0.f;
+		Health -= Amount;
+		return bLethal;
+	}
+
+	void Heal(float& Health, float MaxHealth, float Amount)
+	{
+		Health = Health + Amount >= MaxHealth ? MaxHealth : Health + Amount;
+	}
+
+	float ResolveHitDamage(float AttackDamage, float TargetHealth)
+	{
+		return TargetHealth > 0.f ? AttackDamage : 0.f;
+	}
+
+	int32_t FindNearestTarget(const std::vector<FCombatant>& Combatants, int32_t Self, float Radius)
+	{
+		const FCombatant& Origin = Combatants[Self];
+		float BestDistanceSq = Radius * Radius;
+		int32_t Best = -1;
+
+		const int32_t Num = static_cast<int32_t>(Combatants.size());
+		for (int32_t i = 0; i < Num; i++)
+		{
+			const FCombatant& Other = Combatants[i];
+			if (i == Self || Other.Health <= 0.f) continue;
+
+			const float DX = Other.X - Origin.X;
+			const float DY = Other.Y - Origin.Y;
+			const float DistanceSq = DX * DX + DY * DY;
+			if (DistanceSq <= BestDistanceSq)
+			{
+				BestDistanceSq = DistanceSq;
+				Best = i;
+			}
+		}
+		return Best;
+	}
+
+	FStepResult StepSimulation(std::vector<FCombatant>& Combatants, const FStaminaRules& Rules, float AttackRange, float DeltaTime)
+	{
+		FStepResult Result;
+		const float AttackRangeSq = AttackRange * AttackRange;
+
+		for (FCombatant& Combatant : Combatants)
+		{
+			if (Combatant.Health <= 0.f) continue;
+
+			Combatant.bSprinting = StepStamina(Combatant.Stamina, Rules, Combatant.bSprintHeld, Combatant.bMoving, DeltaTime);
+			Result.Sprinting += Combatant.bSprinting ? 1 : 0;
+		}
+
+		for (FCombatant& Combatant : Combatants)
+		{
+			if (Combatant.Health <= 0.f || Combatant.Target < 0) continue;
+
+			FCombatant& Target = Combatants[Combatant.Target];
+			const float DX = Target.X - Combatant.X;
+			const float DY = Target.Y - Combatant.Y;
+			if (DX * DX + DY * DY > AttackRangeSq) continue;
+
+			const float HitDamage = ResolveHitDamage(Combatant.Damage, Target.Health);
+			if (HitDamage <= 0.f)
+			{
+				Combatant.Target = -1;
+				continue;
+			}
+
+			Result.Hits++;
+			if (ApplyDamage(Target.Health, HitDamage))
+			{
+				Result.Kills++;
+				Combatant.Target = -1;
+			}
+		}
+
+		return Result;
+	}
+}
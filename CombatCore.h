@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Combat rules on plain state, with no UObject or engine dependency, so they can be stepped and
+ * measured outside the editor. AMain, AEnemy and AWeapon copy their fields in, call these and
+ * copy the result back.
+ */
+namespace CombatCore
+{
+	/** Same values and order as EStaminaStaus */
+	enum class EStaminaStatus : uint8_t
+	{
+		Normal,
+		BelowMinimum,
+		Exhausted,
+		ExhaustedRecovering
+	};
+
+	struct FStaminaRules
+	{
+		float MaxStamina = 150.f;
+		float MinSprintStamina = 50.f;
+
+		/** Drained per second while sprinting, regained per second otherwise */
+		float DrainRate = 25.f;
+	};
+
+	struct FStamina
+	{
+		float Stamina = 0.f;
+		EStaminaStatus Status = EStaminaStatus::Normal;
+	};
+
+	/** Advances the stamina state machine by DeltaTime, returns true while the character sprints */
+	bool StepStamina(FStamina& State, const FStaminaRules& Rules, bool bSprintHeld, bool bMoving, float DeltaTime);
+
+	/**
+	 * Stamina as a piecewise linear function of time instead of a value stepped every frame. It is
+	 * anchored at the last input change or status transition and evaluated on demand; between
+	 * anchors the rate is constant and the next transition time is known in advance.
+	 */
+	struct FStaminaTimeline
+	{
+		/** Value at AnchorTime */
+		float Stamina = 0.f;
+		double AnchorTime = 0.0;
+		EStaminaStatus Status = EStaminaStatus::Normal;
+
+		bool bSprintHeld = false;
+		bool bMoving = false;
+	};
+
+	/** Moves the anchor to Now, applying every transition reached on the way */
+	void AdvanceStamina(FStaminaTimeline& Timeline, const FStaminaRules& Rules, double Now);
+
+	/** Advances to Now, then switches to the new input */
+	void SetStaminaInput(FStaminaTimeline& Timeline, const FStaminaRules& Rules, double Now, bool bSprintHeld, bool bMoving);
+
+	/** Value at Now without moving the anchor */
+	float EvaluateStamina(const FStaminaTimeline& Timeline, const FStaminaRules& Rules, double Now);
+
+	/** Seconds after AnchorTime until the status changes with the current input, negative if it never does */
+	double TimeToNextStaminaTransition(const FStaminaTimeline& Timeline, const FStaminaRules& Rules);
+
+	bool IsSprinting(const FStaminaTimeline& Timeline);
+
+	/** False once the value holds still with the current input: full, or exhausted with sprint held */
+	bool IsStaminaChanging(const FStaminaTimeline& Timeline, const FStaminaRules& Rules);
+
+	/** Subtracts Amount from Health, returns true when the hit is lethal */
+	bool ApplyDamage(float& Health, float Amount);
+
+	/** Adds Amount to Health, clamped to MaxHealth */
+	void Heal(float& Health, float MaxHealth, float Amount);
+
+	/** Damage a weapon or attack hit deals to a target, 0 when the target is already dead */
+	float ResolveHitDamage(float AttackDamage, float TargetHealth);
+
+	struct FCombatant
+	{
+		float X = 0.f;
+		float Y = 0.f;
+
+		float Health = 0.f;
+		float MaxHealth = 0.f;
+		FStamina Stamina;
+
+		/** Dealt to Target once per step while it is within attack range */
+		float Damage = 0.f;
+
+		bool bSprintHeld = false;
+		bool bMoving = false;
+		bool bSprinting = false;
+
+		/** Index into the same combatant array, -1 without a target */
+		int32_t Target = -1;
+	};
+
+	/** Index of the closest live combatant within Radius of Combatants[Self], or -1 */
+	int32_t FindNearestTarget(const std::vector<FCombatant>& Combatants, int32_t Self, float Radius);
+
+	struct FStepResult
+	{
+		int32_t Hits = 0;
+		int32_t Kills = 0;
+		int32_t Sprinting = 0;
+	};
+
+	/**
+	 * One simulation step: stamina for every live combatant, then every live combatant hits its
+	 * target when it is within AttackRange. Targets that died are cleared. Combatants are processed
+	 * in index order, so results are deterministic.
+	 */
+	FStepResult StepSimulation(std::vector<FCombatant>& Combatants, const FStaminaRules& Rules, float AttackRange, float DeltaTime);
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Corpse.h"
+#include "Components/PoseableMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "TimingWheelSubsystem.h"
+#include "Engine/World.h"
+
+// Sets default values
+ACorpse::ACorpse()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	PoseableMesh = CreateDefaultSubobject<UPoseableMeshComponent>(TEXT("PoseableMesh"));
+	RootComponent = PoseableMesh;
+
+	// The pose is copied once, nothing has to run per frame
+	PoseableMesh->PrimaryComponentTick.bCanEverTick = false;
+	PoseableMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	PoseableMesh->SetGenerateOverlapEvents(false);
+	PoseableMesh->CastShadow = true;
+}
+
+void ACorpse::CopyFrom(USkeletalMeshComponent* Source)
+{
+	if (!Source || !Source->SkeletalMesh) return;
+
+	SetActorTransform(Source->GetComponentTransform());
+
+	if (PoseableMesh->SkeletalMesh != Source->SkeletalMesh)
+	{
+		PoseableMesh->SetSkeletalMesh(Source->SkeletalMesh);
+	}
+
+	const int32 NumMaterials = Source->GetNumMaterials();
+	for (int32 i = 0; i < NumMaterials; i++)
+	{
+		PoseableMesh->SetMaterial(i, Source->GetMaterial(i));
+	}
+
+	PoseableMesh->CopyPoseFromSkeletalComponent(Source);
+	PoseableMesh->RefreshBoneTransforms();
+}
+
+void ACorpse::OnReleasedToPool_Implementation()
+{
+	// Keeps the skeletal mesh, the next enemy of the same class skips SetSkeletalMesh
+	if (UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>())
+	{
+		Timers->ClearTimer(ExpireTimer);
+	}
+}
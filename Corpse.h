@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Poolable.h"
+#include "TimingWheel.h"
+#include "Corpse.generated.h"
+
+/**
+ * What is left of a dead enemy: a single poseable mesh frozen in the last pose of the death
+ * animation. No anim instance, collision, tick or controller.
+ */
+UCLASS()
+class FIRSTPROYECT2_API ACorpse : public AActor, public IPoolable
+{
+	GENERATED_BODY()
+	
+public:	
+	// Sets default values for this actor's properties
+	ACorpse();
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Corpse")
+	class UPoseableMeshComponent* PoseableMesh;
+
+	/** Copies mesh, materials, transform and the current pose of Source */
+	void CopyFrom(class USkeletalMeshComponent* Source);
+
+	/** Lifetime timer set by UCorpseSubsystem, cleared when the corpse goes back to the pool */
+	FTimingWheelHandle ExpireTimer;
+
+	// IPoolable, CopyFrom sets up an acquired corpse
+	virtual void OnReleasedToPool_Implementation() override;
+
+};
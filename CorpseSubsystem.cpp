@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CorpseSubsystem.h"
+#include "FirstProyect2.h"
+#include "Corpse.h"
+#include "ActorPoolSubsystem.h"
+#include "TimingWheelSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Corpse Spawn"), STAT_CorpseSpawn, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Corpses"), STAT_CorpseNum, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Corpses Evicted"), STAT_CorpseEvicted, STATGROUP_FirstProyect2);
+
+static TAutoConsoleVariable<int32> CVarMaxCorpses(
+	TEXT("FirstProyect2.MaxCorpses"),
+	64,
+	TEXT("Dead enemy bodies kept in the world, the oldest is removed first. 0 disables corpses."),
+	ECVF_Default);
+
+UCorpseSubsystem::UCorpseSubsystem()
+{
+	CorpseLifetime = 30.f;
+}
+
+void UCorpseSubsystem::Deinitialize()
+{
+	Corpses.Reset();
+
+	Super::Deinitialize();
+}
+
+ACorpse* UCorpseSubsystem::SpawnCorpse(USkeletalMeshComponent* Source)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CorpseSpawn);
+
+	const int32 MaxCorpses = CVarMaxCorpses.GetValueOnGameThread();
+	if (MaxCorpses <= 0 || !Source || !Source->SkeletalMesh) return nullptr;
+
+	while (Corpses.Num() >= MaxCorpses)
+	{
+		TWeakObjectPtr<ACorpse> Oldest = Corpses[0];
+		Corpses.RemoveAt(0, 1, false);
+
+		if (ACorpse* Corpse = Oldest.Get())
+		{
+			ReleaseCorpse(Corpse);
+			INC_DWORD_STAT(STAT_CorpseEvicted);
+		}
+	}
+
+	UWorld* World = GetWorld();
+	UActorPoolSubsystem* Pool = World->GetSubsystem<UActorPoolSubsystem>();
+	ACorpse* Corpse = Pool ? Pool->Acquire<ACorpse>(ACorpse::StaticClass(), Source->GetComponentTransform())
+		: World->SpawnActor<ACorpse>(ACorpse::StaticClass(), Source->GetComponentTransform());
+	if (!Corpse) return nullptr;
+
+	Corpse->CopyFrom(Source);
+	Corpses.Add(Corpse);
+
+	UTimingWheelSubsystem* Timers = World->GetSubsystem<UTimingWheelSubsystem>();
+	if (Timers && CorpseLifetime > 0.f)
+	{
+		Timers->SetTimer(Corpse->ExpireTimer, CorpseLifetime, FSimpleDelegate::CreateUObject(this, &UCorpseSubsystem::ExpireCorpse, TWeakObjectPtr<ACorpse>(Corpse)));
+	}
+
+	SET_DWORD_STAT(STAT_CorpseNum, Corpses.Num());
+	return Corpse;
+}
+
+void UCorpseSubsystem::RemoveCorpse(ACorpse* Corpse)
+{
+	if (!Corpse) return;
+
+	Corpses.Remove(Corpse);
+	ReleaseCorpse(Corpse);
+}
+
+void UCorpseSubsystem::ExpireCorpse(TWeakObjectPtr<ACorpse> Corpse)
+{
+	RemoveCorpse(Corpse.Get());
+}
+
+void UCorpseSubsystem::ReleaseCorpse(ACorpse* Corpse)
+{
+	UActorPoolSubsystem::ReleaseOrDestroy(Corpse);
+
+	SET_DWORD_STAT(STAT_CorpseNum, Corpses.Num());
+}
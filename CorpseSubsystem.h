@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CorpseSubsystem.generated.h"
+
+/**
+ * Turns dead enemies into pooled ACorpse actors so the enemy itself can go straight back to the
+ * actor pool. At most FirstProyect2.MaxCorpses bodies are kept, the oldest is removed first.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UCorpseSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UCorpseSubsystem();
+
+	virtual void Deinitialize() override;
+
+	/** Returns nullptr when corpses are disabled (budget of 0) or Source has no mesh */
+	class ACorpse* SpawnCorpse(class USkeletalMeshComponent* Source);
+
+	void RemoveCorpse(ACorpse* Corpse);
+
+	FORCEINLINE int32 Num() const { return Corpses.Num(); }
+
+	/** Seconds a corpse stays before it is removed, 0 keeps it until the budget evicts it */
+	float CorpseLifetime;
+
+private:
+
+	void ExpireCorpse(TWeakObjectPtr<ACorpse> Corpse);
+
+	/** Cancels the lifetime timer and hands the corpse back to the pool */
+	void ReleaseCorpse(ACorpse* Corpse);
+
+	/** Oldest first */
+	TArray<TWeakObjectPtr<ACorpse>> Corpses;
+};
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DamageQueueSubsystem.h"
+#include "FirstProyect2.h"
+#include "Main.h"
+#include "Enemy.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Queue Resolve"), STAT_DamageQueueResolve, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Damage Hits Queued"), STAT_DamageHitsQueued, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Damage Hits Coalesced"), STAT_DamageHitsCoalesced, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Damage Applied"), STAT_DamageApplied, STATGROUP_FirstProyect2);
+
+void FDamageQueueTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target)
+	{
+		Target->Flush();
+	}
+}
+
+FString FDamageQueueTickFunction::DiagnosticMessage()
+{
+	return TEXT("FDamageQueueTickFunction");
+}
+
+void UDamageQueueSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TickFunction.Target = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = false;
+	TickFunction.TickGroup = TG_PostUpdateWork;
+
+	UWorld* World = GetWorld();
+	if (World && World->IsGameWorld() && World->PersistentLevel)
+	{
+		TickFunction.RegisterTickFunction(World->PersistentLevel);
+	}
+}
+
+void UDamageQueueSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Target = nullptr;
+
+	Hits.Reset();
+	SwingsByCauser.Reset();
+	Retargets.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UDamageQueueSubsystem::QueueHit(const FQueuedHit& Hit, int32 Swing)
+{
+	AActor* Target = Hit.Target.Get();
+	if (!Target || Hit.Amount <= 0.f) return false;
+
+	if (AActor* Causer = Hit.Causer.Get())
+	{
+		FSwingHits& SwingHits = SwingsByCauser.FindOrAdd(Causer);
+		if (SwingHits.Swing != Swing)
+		{
+			SwingHits.Swing = Swing;
+			SwingHits.Targets.Reset();
+		}
+		else if (SwingHits.Targets.Contains(Target))
+		{
+			INC_DWORD_STAT(STAT_DamageHitsCoalesced);
+			return false;
+		}
+		SwingHits.Targets.Add(Target);
+	}
+
+	Hits.Add(Hit);
+	INC_DWORD_STAT(STAT_DamageHitsQueued);
+
+	ScheduleFlush();
+	return true;
+}
+
+void UDamageQueueSubsystem::RequestRetarget(AMain* Main)
+{
+	if (!Main) return;
+
+	Retargets.AddUnique(Main);
+	ScheduleFlush();
+}
+
+void UDamageQueueSubsystem::ScheduleFlush()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.SetTickFunctionEnable(true);
+	}
+	else if (!bFlushing)
+	{
+		// No world tick to wait for, keep the old immediate behaviour
+		Flush();
+	}
+}
+
+bool UDamageQueueSubsystem::IsAlive(AActor* Target)
+{
+	if (AEnemy* Enemy = Cast<AEnemy>(Target))
+	{
+		return Enemy->Alive();
+	}
+	if (AMain* Main = Cast<AMain>(Target))
+	{
+		return Main->MovementStatus != EMovementStatus::EMS_Dead;
+	}
+	return true;
+}
+
+void UDamageQueueSubsystem::ApplyHit(AActor* Target, float Amount, const FQueuedHit& Hit)
+{
+	AActor* Causer = Hit.Causer.Get();
+	const FVector Direction = Causer ? (Hit.HitLocation - Causer->GetActorLocation()).GetSafeNormal() : FVector::ZeroVector;
+
+	FHitResult HitInfo(Target, nullptr, Hit.HitLocation, -Direction);
+	UGameplayStatics::ApplyPointDamage(Target, Amount, Direction, HitInfo, Hit.Instigator.Get(), Causer, Hit.DamageType);
+}
+
+void UDamageQueueSubsystem::Flush()
+{
+	SCOPE_CYCLE_COUNTER(STAT_DamageQueueResolve);
+
+	if (bFlushing) return;
+	TGuardValue<bool> FlushGuard(bFlushing, true);
+
+	// Hits are summed per target first, so a target that dies this frame dies once
+	DamageByTarget.Reset();
+	for (int32 i = 0; i < Hits.Num(); i++)
+	{
+		AActor* Target = Hits[i].Target.Get();
+		if (!Target) continue;
+
+		FTargetDamage& Damage = DamageByTarget.FindOrAdd(Target);
+		Damage.Amount += Hits[i].Amount;
+		if (Damage.Hit == INDEX_NONE || Hits[i].Amount > Hits[Damage.Hit].Amount)
+		{
+			Damage.Hit = i;
+		}
+	}
+
+	// Applying damage may queue more (a death requesting a retarget), retargets are handled below, new hits next frame
+	TArray<FQueuedHit> Resolving = MoveTemp(Hits);
+	Hits.Reset();
+
+	for (const TPair<AActor*, FTargetDamage>& Pair : DamageByTarget)
+	{
+		if (!IsValid(Pair.Key) || !IsAlive(Pair.Key)) continue;
+
+		ApplyHit(Pair.Key, Pair.Value.Amount, Resolving[Pair.Value.Hit]);
+		INC_DWORD_STAT(STAT_DamageApplied);
+	}
+	DamageByTarget.Reset();
+
+	TArray<TWeakObjectPtr<AMain>> Retargeting = MoveTemp(Retargets);
+	Retargets.Reset();
+	for (const TWeakObjectPtr<AMain>& Main : Retargeting)
+	{
+		if (Main.IsValid())
+		{
+			Main->UpdateCombatTarget();
+		}
+	}
+
+	for (auto It = SwingsByCauser.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (Hits.Num() == 0 && Retargets.Num() == 0 && TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.SetTickFunctionEnable(false);
+	}
+}
+
+bool UDamageQueueSubsystem::QueueOrApply(UWorld* World, const FQueuedHit& Hit, int32 Swing)
+{
+	if (UDamageQueueSubsystem* Queue = World ? World->GetSubsystem<UDamageQueueSubsystem>() : nullptr)
+	{
+		return Queue->QueueHit(Hit, Swing);
+	}
+
+	if (!Hit.Target.IsValid()) return false;
+
+	ApplyHit(Hit.Target.Get(), Hit.Amount, Hit);
+	return true;
+}
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "DamageQueueSubsystem.generated.h"
+
+class UDamageQueueSubsystem;
+class UDamageType;
+class AMain;
+
+/** Resolves the damage queue late in the frame, after every overlap of the frame has been dispatched */
+USTRUCT()
+struct FDamageQueueTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UDamageQueueSubsystem* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FDamageQueueTickFunction> : public TStructOpsTypeTraitsBase2<FDamageQueueTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/** One recorded hit, nothing is applied until the queue resolves */
+struct FQueuedHit
+{
+	TWeakObjectPtr<AActor> Target;
+	TWeakObjectPtr<AController> Instigator;
+	TWeakObjectPtr<AActor> Causer;
+	TSubclassOf<UDamageType> DamageType;
+	float Amount = 0.f;
+
+	/** Where the blow landed, handed to TakeDamage as point damage */
+	FVector HitLocation = FVector::ZeroVector;
+};
+
+/**
+ * Melee hits are recorded from the overlap callbacks and applied once per frame in TG_PostUpdateWork
+ * instead of going through TakeDamage, Die and the HUD in the middle of physics dispatch. A causer
+ * hits a target at most once per swing, and hits on the same target in a frame are summed into one
+ * point damage event at the strongest hit's location. Combat retargeting requested by deaths runs
+ * once per character per frame.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UDamageQueueSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Records a hit for this frame. Swing identifies the causer's current attack, a second hit on
+	 * the same target during it is dropped. Returns false for a dropped hit so the caller can skip
+	 * its hit effects.
+	 */
+	bool QueueHit(const FQueuedHit& Hit, int32 Swing);
+
+	/** Runs UpdateCombatTarget on Main once, after this frame's damage is resolved */
+	void RequestRetarget(AMain* Main);
+
+	/** Applies everything queued so far */
+	void Flush();
+
+	/** Queues on the world's subsystem, or applies right away without one */
+	static bool QueueOrApply(UWorld* World, const FQueuedHit& Hit, int32 Swing);
+
+private:
+
+	struct FSwingHits
+	{
+		int32 Swing = INDEX_NONE;
+		TArray<TWeakObjectPtr<AActor>, TInlineAllocator<4>> Targets;
+	};
+
+	struct FTargetDamage
+	{
+		float Amount = 0.f;
+
+		/** The hit that dealt the most, its instigator, causer and location are reported */
+		int32 Hit = INDEX_NONE;
+	};
+
+	static bool IsAlive(AActor* Target);
+
+	/** Point damage from Hit's causer towards its HitLocation */
+	static void ApplyHit(AActor* Target, float Amount, const FQueuedHit& Hit);
+
+	/** Enables the tick function, or flushes right away when it is not registered */
+	void ScheduleFlush();
+
+	FDamageQueueTickFunction TickFunction;
+
+	TArray<FQueuedHit> Hits;
+
+	TMap<TWeakObjectPtr<AActor>, FSwingHits> SwingsByCauser;
+
+	TMap<AActor*, FTargetDamage> DamageByTarget;
+
+	TArray<TWeakObjectPtr<AMain>> Retargets;
+
+	/** Set while Flush runs, anything queued meanwhile waits for the next flush */
+	bool bFlushing = false;
+};
@@ -13,15 +13,30 @@
 #include "Engine/SkeletalMeshSocket.h"
 #include "Sound/SoundCue.h"
 #include "Animation/AnimInstance.h"
-#include "TimerManager.h"
 #include "Components/CapsuleComponent.h"
 #include "MainPlayerController.h"
+#include "EnemySpatialHashSubsystem.h"
+#include "EnemyDirectorSubsystem.h"
+#include "EnemyLODSettings.h"
+#include "EnemyPathCacheSubsystem.h"
+#include "FlowFieldSubsystem.h"
+#include "TimingWheelSubsystem.h"
+#include "EnemyProximitySubsystem.h"
+#include "ActorPoolSubsystem.h"
+#include "FXManagerSubsystem.h"
+#include "CorpseSubsystem.h"
+#include "CombatCore.h"
+#include "DamageQueueSubsystem.h"
+#include "WeaponTraceComponent.h"
+#include "RandomStreamSubsystem.h"
+#include "GameFramework/CharacterMovementComponent.h"
 
 // Sets default values
 AEnemy::AEnemy()
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+ 	// Enemy logic is batched by UEnemyDirectorSubsystem, Blueprints can still turn the actor tick on.
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	AgroSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AgroSphere"));
 	AgroSphere->SetupAttachment(GetRootComponent());
@@ -35,12 +50,17 @@ AEnemy::AEnemy()
 
 	CombatCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("CombatCollision"));
 	CombatCollision->SetupAttachment(GetMesh(), FName("EnemySocket"));
+
+	WeaponTrace = CreateDefaultSubobject<UWeaponTraceComponent>(TEXT("WeaponTrace"));
 	
 
 
 
 	bOverlappingCombatSphere = false;
 
+	ProximityMode = EEnemyProximityMode::EPM_PhysicsOverlap;
+	bBatchedProximity = false;
+
 	Health = 75.f;
 	MaxHealth = 100.f;
 	Damage = 10.f;
@@ -51,8 +71,22 @@ AEnemy::AEnemy()
 	EnemyMovementStatus = EEnemyMovementStatus::EMS_Idle;
 
 	DeathDelay = 3.f;
+	bLeaveCorpse = true;
 
 	bHasValidTarget = false;
+	SwingCount = 0;
+
+	SpatialHashId = INDEX_NONE;
+	DirectorIndex = INDEX_NONE;
+
+	LODTier = INDEX_NONE;
+	RepathInterval = 0.f;
+
+	NavigationMode = EEnemyNavigationMode::ENM_PathFollowing;
+
+	RepathDistanceThreshold = 150.f;
+	LastPathGoalLocation = FVector(BIG_NUMBER);
+	LastPathTime = -BIG_NUMBER;
 }
 
 // Called when the game starts or when spawned
@@ -76,9 +110,183 @@ void AEnemy::BeginPlay()
 	CombatCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 	CombatCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
 
+	WeaponTrace->SetTraceVolume(CombatCollision);
+	WeaponTrace->OnHit.AddUObject(this, &AEnemy::OnTraceHit);
+
 	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
 	GetCapsuleComponent()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
+
+	bBatchedProximity = UEnemyProximitySubsystem::ShouldUseBatchedQuery(this);
+	if (bBatchedProximity)
+	{
+		AgroSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		CombatSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
 	
+	RegisterWithSubsystems();
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterFromSubsystems();
+
+	if (UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>())
+	{
+		Timers->ClearTimer(DeathTimer);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AEnemy::RegisterWithSubsystems()
+{
+	UWorld* World = GetWorld();
+	if (!World) return;
+
+	if (UEnemySpatialHashSubsystem* SpatialHash = World->GetSubsystem<UEnemySpatialHashSubsystem>())
+	{
+		SpatialHash->RegisterEnemy(this);
+	}
+	if (UEnemyDirectorSubsystem* Director = World->GetSubsystem<UEnemyDirectorSubsystem>())
+	{
+		Director->RegisterEnemy(this);
+	}
+	if (bBatchedProximity)
+	{
+		if (UEnemyProximitySubsystem* Proximity = World->GetSubsystem<UEnemyProximitySubsystem>())
+		{
+			Proximity->RegisterEnemy(this);
+		}
+	}
+}
+
+void AEnemy::UnregisterFromSubsystems()
+{
+	UWorld* World = GetWorld();
+	if (!World) return;
+
+	// Keyed by SpatialHashId, so it goes before the spatial hash releases the id
+	if (UEnemyProximitySubsystem* Proximity = World->GetSubsystem<UEnemyProximitySubsystem>())
+	{
+		Proximity->UnregisterEnemy(this);
+	}
+	if (UEnemySpatialHashSubsystem* SpatialHash = World->GetSubsystem<UEnemySpatialHashSubsystem>())
+	{
+		SpatialHash->UnregisterEnemy(this);
+	}
+	if (UEnemyDirectorSubsystem* Director = World->GetSubsystem<UEnemyDirectorSubsystem>())
+	{
+		Director->UnregisterEnemy(this);
+	}
+}
+
+void AEnemy::RequestRetarget(AMain* Main)
+{
+	UDamageQueueSubsystem* DamageQueue = GetWorld()->GetSubsystem<UDamageQueueSubsystem>();
+	if (DamageQueue)
+	{
+		DamageQueue->RequestRetarget(Main);
+	}
+	else if (Main)
+	{
+		Main->UpdateCombatTarget();
+	}
+}
+
+void AEnemy::OnAcquiredFromPool_Implementation()
+{
+	const AEnemy* Defaults = GetClass()->GetDefaultObject<AEnemy>();
+
+	Health = Defaults->Health;
+	NavigationMode = Defaults->NavigationMode;
+	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Idle);
+
+	// Forces the next significance pass to apply a tier again
+	LODTier = INDEX_NONE;
+	LastPathGoalLocation = FVector(BIG_NUMBER);
+	LastPathTime = -BIG_NUMBER;
+
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.f);
+	}
+	GetMesh()->bPauseAnims = false;
+	GetMesh()->bNoSkeletonUpdate = false;
+
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_Walking);
+
+	GetCapsuleComponent()->SetCollisionEnabled(Defaults->GetCapsuleComponent()->GetCollisionEnabled());
+	if (!bBatchedProximity)
+	{
+		AgroSphere->SetCollisionEnabled(Defaults->AgroSphere->GetCollisionEnabled());
+		CombatSphere->SetCollisionEnabled(Defaults->CombatSphere->GetCollisionEnabled());
+	}
+
+	RegisterWithSubsystems();
+}
+
+void AEnemy::OnReleasedToPool_Implementation()
+{
+	CancelAttack();
+	UnregisterFromSubsystems();
+
+	if (UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>())
+	{
+		Timers->ClearTimer(DeathTimer);
+	}
+
+	ChaseTarget = nullptr;
+	CombatTarget = nullptr;
+	bHasValidTarget = false;
+	bOverlappingCombatSphere = false;
+	bAttacking = false;
+
+	if (AIController)
+	{
+		AIController->StopMovement();
+	}
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	GetMesh()->bPauseAnims = true;
+
+	CombatCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+void AEnemy::SerializeSaveState(FArchive& Ar)
+{
+	float SavedHealth = Health;
+	uint8 SavedStatus = (uint8)EnemyMovementStatus;
+	FTransform SavedTransform = GetActorTransform();
+	Ar << SavedHealth << SavedStatus << SavedTransform;
+
+	if (!Ar.IsLoading()) return;
+
+	if ((EEnemyMovementStatus)SavedStatus == EEnemyMovementStatus::EMS_Dead)
+	{
+		if (Alive())
+		{
+			Health = 0.f;
+			SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Dead);
+			Disappear();
+		}
+		return;
+	}
+
+	if (!Alive())
+	{
+		Revive();
+	}
+
+	Health = SavedHealth;
+	SetActorTransform(SavedTransform, false, nullptr, ETeleportType::TeleportPhysics);
+
+	// Targets come back through the agro and combat spheres
+	CancelAttack();
+	ChaseTarget = nullptr;
+	bAttacking = false;
+	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Idle);
 }
 
 // Called every frame
@@ -117,13 +325,14 @@ void AEnemy::AgroSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AA
 		if (Main)
 		{
 			bHasValidTarget = false;
+			ChaseTarget = nullptr;
 			if (Main->CombatTarget == this)
 			{
 				Main->SetCombatTarget(nullptr);
 			}
 			Main->SetHasCombatTarget(false);
 			
-			Main->UpdateCombatTarget();
+			RequestRetarget(Main);
 			
 			SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Idle);
 			if (AIController)
@@ -148,13 +357,12 @@ void AEnemy::CombatSphereOnOverlapBegin(UPrimitiveComponent* OverlappedComponent
 			Main->SetCombatTarget(this);
 			Main->SetHasCombatTarget(true);
 			
-			Main->UpdateCombatTarget();
+			RequestRetarget(Main);
 
 			CombatTarget = Main;
 			bOverlappingCombatSphere = true;
 			
-			float AttackTime = FMath::FRandRange(AttackMinTime, AttackMaxTime);
-			GetWorldTimerManager().SetTimer(AttackTimer, this, &AEnemy::Attack, AttackTime);
+			ScheduleAttack();
 		}
 	}
 }
@@ -177,7 +385,7 @@ void AEnemy::CombatSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent,
 			{
 				Main->SetCombatTarget(nullptr);
 				Main->bHasCombatTarget = false;
-				Main->UpdateCombatTarget();
+				RequestRetarget(Main);
 			}
 			if (Main->MainPlayerController)
 			{
@@ -185,7 +393,7 @@ void AEnemy::CombatSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent,
 				if (MainMesh)Main->MainPlayerController->RemoveEnemyHealthBar();
 			}
 			
-			GetWorldTimerManager().ClearTimer(AttackTimer);
+			CancelAttack();
 		}
 	}
 }
@@ -193,16 +401,55 @@ void AEnemy::CombatSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent,
 void AEnemy::MoveToTarget(AMain* Target)
 {
 	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_MoveToTarget);
+	ChaseTarget = Target;
 
-	if (AIController)
+	if (NavigationMode == EEnemyNavigationMode::ENM_FlowField)
 	{
+		// The director feeds movement input from the field every frame
+		UFlowFieldSubsystem* FlowFields = GetWorld()->GetSubsystem<UFlowFieldSubsystem>();
+		if (FlowFields && Target)
+		{
+			FlowFields->RequestField(Target);
+			if (AIController)
+			{
+				AIController->StopMovement();
+			}
+			return;
+		}
+	}
+
+	if (AIController && Target)
+	{
+		const FVector GoalLocation = Target->GetActorLocation();
+
+		// Already following a path to roughly the same spot, overlap churn should not trigger a new query
+		const bool bFollowingPath = AIController->GetMoveStatus() == EPathFollowingStatus::Moving;
+		const bool bGoalMoved = FVector::DistSquared(GoalLocation, LastPathGoalLocation) > FMath::Square(RepathDistanceThreshold);
+		if (bFollowingPath && !bGoalMoved) return;
+
 		FAIMoveRequest MoveRequest;
 		MoveRequest.SetGoalActor(Target);
 		MoveRequest.SetAcceptanceRadius(10.f);
 
 		FNavPathSharedPtr NavPath;
 
-		AIController->MoveTo(MoveRequest, &NavPath);
+		UEnemyPathCacheSubsystem* PathCache = GetWorld()->GetSubsystem<UEnemyPathCacheSubsystem>();
+		if (PathCache)
+		{
+			NavPath = PathCache->FindOrBuildPath(AIController, GetActorLocation(), GoalLocation);
+		}
+
+		if (NavPath.IsValid())
+		{
+			AIController->RequestMove(MoveRequest, NavPath);
+		}
+		else
+		{
+			AIController->MoveTo(MoveRequest, &NavPath);
+		}
+
+		LastPathGoalLocation = GoalLocation;
+		LastPathTime = GetWorld()->GetTimeSeconds();
 
 		/*
 		TArray<FNavPathPoint> PathPoints = NavPath->GetPathPoints();
@@ -225,28 +472,48 @@ void AEnemy::CombatOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AAct
 		AMain* Main = Cast<AMain>(OtherActor);
 		if (Main)
 		{
-			if (Main->HitParticles)
-			{
-				const USkeletalMeshSocket* TipSocket = GetMesh()->GetSocketByName("TipSocket");
-				if (TipSocket)
-				{
-					FVector SocketLocation = TipSocket->GetSocketLocation(GetMesh());
-					UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Main->HitParticles, GetActorLocation(), FRotator(0.f), false);
-				}
-
-			}
-			if (Main->HitSound)
-			{
-				UGameplayStatics::PlaySound2D(this, Main->HitSound);
-			}
-			if (DamageTypeClass)
-			{
-				UGameplayStatics::ApplyDamage(Main, Damage, AIController, this, DamageTypeClass);
-			}
+			const USkeletalMeshSocket* TipSocket = GetMesh()->GetSocketByName("TipSocket");
+			HitMain(Main, TipSocket ? TipSocket->GetSocketLocation(GetMesh()) : GetActorLocation());
 		}
 	}
 }
 
+void AEnemy::OnTraceHit(AActor* HitActor, const FHitResult& Hit)
+{
+	// Sweeps land a frame late, one may still be in flight when this enemy dies
+	AMain* Main = Cast<AMain>(HitActor);
+	if (Main && Alive())
+	{
+		HitMain(Main, Hit.ImpactPoint);
+	}
+}
+
+void AEnemy::HitMain(AMain* Main, const FVector& HitLocation)
+{
+	const float HitDamage = CombatCore::ResolveHitDamage(Damage, Main->Health);
+	if (!DamageTypeClass || HitDamage <= 0.f) return;
+
+	FQueuedHit Hit;
+	Hit.Target = Main;
+	Hit.Instigator = AIController;
+	Hit.Causer = this;
+	Hit.DamageType = DamageTypeClass;
+	Hit.Amount = HitDamage;
+	Hit.HitLocation = HitLocation;
+
+	if (!UDamageQueueSubsystem::QueueOrApply(GetWorld(), Hit, SwingCount)) return;
+
+	UFXManagerSubsystem* FX = GetWorld()->GetSubsystem<UFXManagerSubsystem>();
+	if (Main->HitParticles && FX)
+	{
+		FX->SpawnEmitter(Main->HitParticles, HitLocation);
+	}
+	if (Main->HitSound && FX)
+	{
+		FX->PlaySound2D(Main->HitSound, HitLocation);
+	}
+}
+
 void AEnemy::CombatOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
 
@@ -254,7 +521,15 @@ void AEnemy::CombatOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor
 
 void AEnemy::ActivateCollision()
 {
-	CombatCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	SwingCount++;
+	if (WeaponTrace->CanTrace())
+	{
+		WeaponTrace->BeginSwing();
+	}
+	else
+	{
+		CombatCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	}
 
 	if (SwingSound)
 	{
@@ -264,6 +539,7 @@ void AEnemy::ActivateCollision()
 
 void AEnemy::DeactivateCollision()
 {
+	WeaponTrace->EndSwing();
 	CombatCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 }
 
@@ -296,23 +572,32 @@ void AEnemy::AttackEnd()
 	bAttacking = false;
 	if (bOverlappingCombatSphere)
 	{
-		float AttackTime = FMath::FRandRange(AttackMinTime, AttackMaxTime);
-		GetWorldTimerManager().SetTimer(AttackTimer, this, &AEnemy::Attack, AttackTime);
+		ScheduleAttack();
+	}
+}
 
-		
+void AEnemy::ScheduleAttack()
+{
+	if (UEnemyDirectorSubsystem* Director = GetWorld()->GetSubsystem<UEnemyDirectorSubsystem>())
+	{
+		float AttackTime = URandomStreamSubsystem::GetStream(this, TEXT("EnemyAttack")).FRandRange(AttackMinTime, AttackMaxTime);
+		Director->SetAttackCooldown(this, AttackTime);
 	}
 }
 
-float AEnemy::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser)
+void AEnemy::CancelAttack()
 {
-	if (Health - DamageAmount <= 0.f)
+	if (UEnemyDirectorSubsystem* Director = GetWorld()->GetSubsystem<UEnemyDirectorSubsystem>())
 	{
-		Health -= DamageAmount;
-		Die(DamageCauser);
+		Director->ClearAttackCooldown(this);
 	}
-	else
+}
+
+float AEnemy::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser)
+{
+	if (CombatCore::ApplyDamage(Health, DamageAmount))
 	{
-		Health -= DamageAmount;
+		Die(DamageCauser);
 	}
 
 	return DamageAmount;
@@ -327,19 +612,27 @@ void AEnemy::Die(AActor* Causer)
 		AnimInstance->Montage_JumpToSection(FName("Death"), CombatMontage);
 	}
 
-	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Dead);
-
 	CombatCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	WeaponTrace->EndSwing();
 	AgroSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	CombatSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
+	UnregisterFromSubsystems();
+
+	// The overlap end events above run right away and set the enemy idle or chasing again
+	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Dead);
+	ChaseTarget = nullptr;
 	bAttacking = false;
+	if (AIController)
+	{
+		AIController->StopMovement();
+	}
 
 	AMain* Main = Cast<AMain>(Causer);
 	if (Main)
 	{
-		Main->UpdateCombatTarget();
+		RequestRetarget(Main);
 	}
 }
 
@@ -349,16 +642,65 @@ void AEnemy::DeathEnd()
 	GetMesh()->bPauseAnims = true;
 	GetMesh()->bNoSkeletonUpdate = true;
 
-	GetWorldTimerManager().SetTimer(DeathTimer, this, &AEnemy::Disappear, DeathDelay);
+	UCorpseSubsystem* Corpses = bLeaveCorpse ? GetWorld()->GetSubsystem<UCorpseSubsystem>() : nullptr;
+	if (Corpses && Corpses->SpawnCorpse(GetMesh()))
+	{
+		// The spawn volume gives pooled enemies without a controller a fresh one
+		if (AController* DeadController = GetController())
+		{
+			DeadController->UnPossess();
+			DeadController->Destroy();
+		}
+		AIController = nullptr;
+
+		Disappear();
+		return;
+	}
+
+	if (UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>())
+	{
+		Timers->SetTimer(DeathTimer, this, &AEnemy::Disappear, DeathDelay);
+	}
 	
 }
 
+const UEnemyLODSettings* AEnemy::GetLODSettings() const
+{
+	return LODSettings ? LODSettings : GetDefault<UEnemyLODSettings>();
+}
+
 bool AEnemy::Alive()
 {
-	return GetEnemyMovementStatus() != EEnemyMovementStatus::EMS_Dead;
+	return Health > 0.f && GetEnemyMovementStatus() != EEnemyMovementStatus::EMS_Dead;
 }
 
 void AEnemy::Disappear()
 {
-	Destroy();
+	UActorPoolSubsystem::ReleaseOrDestroy(this);
+}
+
+void AEnemy::Revive()
+{
+	if (UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>())
+	{
+		Timers->ClearTimer(DeathTimer);
+	}
+
+	// Already parked by the pool, or still lying where it died
+	UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	if (Pool && IsHidden())
+	{
+		Pool->UnparkActor(this);
+	}
+	else
+	{
+		OnAcquiredFromPool_Implementation();
+	}
+
+	// Leaving a corpse behind destroys the controller
+	if (!GetController())
+	{
+		SpawnDefaultController();
+	}
+	AIController = Cast<AAIController>(GetController());
 }
\ No newline at end of file
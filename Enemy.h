@@ -4,6 +4,9 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "TimingWheel.h"
+#include "Poolable.h"
+#include "SaveableActor.h"
 #include "Enemy.generated.h"
 
 UENUM(BlueprintType)
@@ -17,8 +20,26 @@ enum class EEnemyMovementStatus :uint8
 	EMS_Max UMETA(DisplayName = "DefaultMax")
 };
 
+UENUM(BlueprintType)
+enum class EEnemyNavigationMode : uint8
+{
+	ENM_PathFollowing UMETA(DisplayName = "PathFollowing"),
+	ENM_FlowField UMETA(DisplayName = "FlowField"),
+
+	ENM_Max UMETA(DisplayName = "DefaultMax")
+};
+
+UENUM(BlueprintType)
+enum class EEnemyProximityMode : uint8
+{
+	EPM_PhysicsOverlap UMETA(DisplayName = "PhysicsOverlap"),
+	EPM_BatchedQuery UMETA(DisplayName = "BatchedQuery"),
+
+	EPM_Max UMETA(DisplayName = "DefaultMax")
+};
+
 UCLASS()
-class FIRSTPROYECT2_API AEnemy : public ACharacter
+class FIRSTPROYECT2_API AEnemy : public ACharacter, public IPoolable, public ISaveableActor
 {
 	GENERATED_BODY()
 
@@ -40,6 +61,13 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI")
     USphereComponent* CombatSphere;
 
+	/** BatchedQuery turns the spheres' collision off and gets the same overlap calls from UEnemyProximitySubsystem */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "AI")
+	EEnemyProximityMode ProximityMode;
+
+	/** Resolved in BeginPlay, the spheres keep their collision only when this is false */
+	bool bBatchedProximity;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI")
 	class AAIController* AIController;
 
@@ -64,11 +92,13 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Combat")
 	class UBoxComponent* CombatCollision;
 
+	/** Sweeps CombatCollision along the swing, its overlaps are the fallback when the box has no extent */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat")
+	class UWeaponTraceComponent* WeaponTrace;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	class UAnimMontage* CombatMontage;
 
-	FTimerHandle AttackTimer;
-
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	float AttackMinTime;
 
@@ -78,15 +108,39 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	TSubclassOf<UDamageType> DamageTypeClass;
 
-	FTimerHandle DeathTimer;
+	FTimingWheelHandle DeathTimer;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	float DeathDelay;
 
+	/** DeathEnd leaves a pose-copy corpse and returns this enemy to the pool right away instead of waiting DeathDelay */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Combat")
+	bool bLeaveCorpse;
+
+	/** Slot in UEnemySpatialHashSubsystem, INDEX_NONE while not registered */
+	int32 SpatialHashId;
+
+	/** Slot in UEnemyDirectorSubsystem, INDEX_NONE while not registered */
+	int32 DirectorIndex;
+
+	/** Significance tiers for this class, falls back to the UEnemyLODSettings defaults */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "LOD")
+	class UEnemyLODSettings* LODSettings;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "LOD")
+	int32 LODTier;
+
+	/** Minimum seconds between re-paths, set by the current LOD tier */
+	float RepathInterval;
+
+	const UEnemyLODSettings* GetLODSettings() const;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -109,6 +163,20 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void MoveToTarget(class AMain* Target);
 
+	/** PathFollowing uses the AIController, FlowField steers along the player's shared flow field */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
+	EEnemyNavigationMode NavigationMode;
+
+	/** Player being chased while in EMS_MoveToTarget */
+	TWeakObjectPtr<AMain> ChaseTarget;
+
+	/** The goal has to move this far (cm) before the path is recomputed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
+	float RepathDistanceThreshold;
+
+	FVector LastPathGoalLocation;
+	float LastPathTime;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "AI")
 	bool bOverlappingCombatSphere;
 
@@ -121,12 +189,20 @@ public:
 	UFUNCTION()
 	void CombatOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 
+	void OnTraceHit(AActor* HitActor, const FHitResult& Hit);
+
+	/** Queues the damage and plays the hit effects, unless Main was already hit this swing */
+	void HitMain(class AMain* Main, const FVector& HitLocation);
+
 	UFUNCTION(BlueprintCallable)
 	void ActivateCollision();
 
 	UFUNCTION(BlueprintCallable)
 	void DeactivateCollision();
 
+	/** Bumped by ActivateCollision, the player is damaged once per swing */
+	int32 SwingCount;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat")
 	bool bAttacking;
 
@@ -136,6 +212,25 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void AttackEnd();
 
+	/** Queue the next Attack() after a random delay between AttackMinTime and AttackMaxTime */
+	void ScheduleAttack();
+
+	void CancelAttack();
+
+	/** Hook into the world subsystems that batch enemy work */
+	void RegisterWithSubsystems();
+	void UnregisterFromSubsystems();
+
+	/** Main->UpdateCombatTarget() once at the end of the frame, however many enemies ask for it */
+	void RequestRetarget(class AMain* Main);
+
+	// IPoolable
+	virtual void OnAcquiredFromPool_Implementation() override;
+	virtual void OnReleasedToPool_Implementation() override;
+
+	// ISaveableActor
+	virtual void SerializeSaveState(FArchive& Ar) override;
+
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
 
 	void Die(AActor* Causer);
@@ -148,4 +243,7 @@ public:
 
 	void Disappear();
 
+	/** Back to full health and idle after dying, for restoring a save from before the death */
+	void Revive();
+
 };
@@ -2,10 +2,61 @@
 
 
 #include "EnemyAnimInstance.h"
+#include "FirstProyect2.h"
+#include "HAL/IConsoleManager.h"
 #include "Enemy.h"
 
+DECLARE_CYCLE_STAT(TEXT("Enemy Anim Update (Game Thread)"), STAT_EnemyAnimUpdateGameThread, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("Enemy Anim Update (Worker)"), STAT_EnemyAnimUpdateWorker, STATGROUP_FirstProyect2);
+
+static TAutoConsoleVariable<int32> CVarEnemyAnimThreadSafeUpdate(
+	TEXT("FirstProyect2.EnemyAnimThreadSafeUpdate"),
+	1,
+	TEXT("1 derives enemy anim properties on the animation worker, 0 computes all of it on the game thread like before, to compare the Enemy Anim Update stats."),
+	ECVF_Default);
+
+void FEnemyAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyAnimUpdateGameThread);
+
+	FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
+
+	bThreadSafeUpdate = CVarEnemyAnimThreadSafeUpdate.GetValueOnGameThread() != 0;
+	if (!bThreadSafeUpdate) return;
+
+	const UEnemyAnimInstance* Instance = CastChecked<UEnemyAnimInstance>(InAnimInstance);
+	if (APawn* Pawn = Instance->Pawn)
+	{
+		Velocity = Pawn->GetVelocity();
+	}
+}
+
+void FEnemyAnimInstanceProxy::Update(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyAnimUpdateWorker);
+
+	FAnimInstanceProxy::Update(DeltaSeconds);
+
+	if (!bThreadSafeUpdate) return;
+
+	UEnemyAnimInstance* Instance = CastChecked<UEnemyAnimInstance>(GetAnimInstanceObject());
+	Instance->MovementSpeed = Velocity.Size2D();
+}
+
+FAnimInstanceProxy* UEnemyAnimInstance::CreateAnimInstanceProxy()
+{
+	return new FEnemyAnimInstanceProxy(this);
+}
+
+void UEnemyAnimInstance::DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy)
+{
+	delete InProxy;
+}
+
 void UEnemyAnimInstance::NativeInitializeAnimation()
 {
+	Super::NativeInitializeAnimation();
+
 	if (Pawn == nullptr)
 	{
 		Pawn = TryGetPawnOwner();
@@ -16,18 +67,30 @@ void UEnemyAnimInstance::NativeInitializeAnimation()
 	}
 }
 
-void UEnemyAnimInstance::UpdateAnimationProperties()
+void UEnemyAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 {
+	Super::NativeUpdateAnimation(DeltaSeconds);
+
+	if (CVarEnemyAnimThreadSafeUpdate.GetValueOnGameThread() != 0)
+	{
+		if (Pawn == nullptr)
+		{
+			Pawn = TryGetPawnOwner();
+			Enemy = Cast<AEnemy>(Pawn);
+		}
+		return;
+	}
+
+	// The old path, everything on the game thread
+	SCOPE_CYCLE_COUNTER(STAT_EnemyAnimUpdateGameThread);
+
 	if (Pawn == nullptr)
 	{
-		
 		Pawn = TryGetPawnOwner();
 		if (Pawn)
 		{
-
 			Enemy = Cast<AEnemy>(Pawn);
 		}
-		
 	}
 
 	if (Pawn)
@@ -36,6 +99,8 @@ void UEnemyAnimInstance::UpdateAnimationProperties()
 		FVector LateralSpeed{ Speed.X,Speed.Y,0.f };
 		MovementSpeed = LateralSpeed.Size();
 	}
+}
 
-
-}
\ No newline at end of file
+void UEnemyAnimInstance::UpdateAnimationProperties()
+{
+}
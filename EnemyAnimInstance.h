@@ -4,10 +4,30 @@
 
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
 #include "EnemyAnimInstance.generated.h"
 
+/** Copies the owner's movement on the game thread and derives the anim properties on the worker */
+USTRUCT()
+struct FEnemyAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY()
+
+	FEnemyAnimInstanceProxy() {}
+	FEnemyAnimInstanceProxy(UAnimInstance* InAnimInstance) : FAnimInstanceProxy(InAnimInstance) {}
+
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+	virtual void Update(float DeltaSeconds) override;
+
+private:
+
+	FVector Velocity = FVector::ZeroVector;
+	bool bThreadSafeUpdate = false;
+};
+
 /**
- * 
+ * Same split as UMainAnimInstance: the velocity is copied in the proxy PreUpdate and MovementSpeed
+ * derived on the animation worker, which is where hundreds of enemies pay off.
  */
 UCLASS()
 class FIRSTPROYECT2_API UEnemyAnimInstance : public UAnimInstance
@@ -17,6 +37,9 @@ public:
 
 	virtual void NativeInitializeAnimation() override;
 
+	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+
+	/** Kept so existing Blueprints compile, the properties are updated natively now */
 	UFUNCTION(BlueprintCallable, Category = AnimationsProperties)
 	void UpdateAnimationProperties();
 
@@ -28,5 +51,9 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Movement)
 	class AEnemy* Enemy;
-	
+
+protected:
+
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+	virtual void DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) override;
 };
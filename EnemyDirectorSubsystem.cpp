@@ -0,0 +1,279 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyDirectorSubsystem.h"
+#include "FirstProyect2.h"
+#include "Main.h"
+#include "FlowFieldSubsystem.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Director Tick"), STAT_EnemyDirectorTick, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("Enemy Director Gather"), STAT_EnemyDirectorGather, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("Enemy Director Decide"), STAT_EnemyDirectorDecide, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("Enemy Director Apply"), STAT_EnemyDirectorApply, STATGROUP_FirstProyect2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Directed Enemies"), STAT_EnemyDirectorNum, STATGROUP_FirstProyect2);
+
+namespace EnemyDirector
+{
+	enum ECombatFlags : uint8
+	{
+		HasValidTarget = 1 << 0,
+		OverlappingCombatSphere = 1 << 1,
+		Attacking = 1 << 2,
+		HasChaseTarget = 1 << 3,
+	};
+
+	/** Enemies per ParallelFor task, small hordes run inline */
+	static const int32 BatchSize = 256;
+}
+
+UEnemyDirectorSubsystem::UEnemyDirectorSubsystem()
+{
+	MinRepathInterval = 0.25f;
+	FlowAcceptanceRadius = 60.f;
+}
+
+void UEnemyDirectorSubsystem::Deinitialize()
+{
+	for (const TWeakObjectPtr<AEnemy>& Enemy : Actors)
+	{
+		if (Enemy.IsValid())
+		{
+			Enemy->DirectorIndex = INDEX_NONE;
+		}
+	}
+	Actors.Reset();
+	Positions.Reset();
+	Health.Reset();
+	MovementStatus.Reset();
+	AttackCooldowns.Reset();
+	CombatFlags.Reset();
+	GoalLocations.Reset();
+	PathGoalLocations.Reset();
+	LastPathTimes.Reset();
+	RepathIntervals.Reset();
+	RepathDistancesSq.Reset();
+	FlowFieldIndices.Reset();
+	FlowDirections.Reset();
+	Decisions.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UEnemyDirectorSubsystem::IsTickable() const
+{
+	return Actors.Num() > 0;
+}
+
+ETickableTickType UEnemyDirectorSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UEnemyDirectorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyDirectorSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyDirectorSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (!Enemy || Enemy->DirectorIndex != INDEX_NONE) return;
+
+	Enemy->DirectorIndex = Actors.Add(Enemy);
+	Positions.Add(Enemy->GetActorLocation());
+	Health.Add(Enemy->Health);
+	MovementStatus.Add(Enemy->GetEnemyMovementStatus());
+	AttackCooldowns.Add(-1.f);
+	CombatFlags.Add(0);
+	GoalLocations.Add(FVector::ZeroVector);
+	PathGoalLocations.Add(FVector::ZeroVector);
+	LastPathTimes.Add(0.f);
+	RepathIntervals.Add(0.f);
+	RepathDistancesSq.Add(0.f);
+	FlowFieldIndices.Add(INDEX_NONE);
+	FlowDirections.Add(FVector::ZeroVector);
+	Decisions.Add(EEnemyDecision::EED_None);
+}
+
+void UEnemyDirectorSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	if (!Enemy || !Actors.IsValidIndex(Enemy->DirectorIndex)) return;
+
+	RemoveAt(Enemy->DirectorIndex);
+	Enemy->DirectorIndex = INDEX_NONE;
+}
+
+void UEnemyDirectorSubsystem::RemoveAt(int32 Index)
+{
+	Actors.RemoveAtSwap(Index, 1, false);
+	Positions.RemoveAtSwap(Index, 1, false);
+	Health.RemoveAtSwap(Index, 1, false);
+	MovementStatus.RemoveAtSwap(Index, 1, false);
+	AttackCooldowns.RemoveAtSwap(Index, 1, false);
+	CombatFlags.RemoveAtSwap(Index, 1, false);
+	GoalLocations.RemoveAtSwap(Index, 1, false);
+	PathGoalLocations.RemoveAtSwap(Index, 1, false);
+	LastPathTimes.RemoveAtSwap(Index, 1, false);
+	RepathIntervals.RemoveAtSwap(Index, 1, false);
+	RepathDistancesSq.RemoveAtSwap(Index, 1, false);
+	FlowFieldIndices.RemoveAtSwap(Index, 1, false);
+	FlowDirections.RemoveAtSwap(Index, 1, false);
+	Decisions.RemoveAtSwap(Index, 1, false);
+
+	if (Actors.IsValidIndex(Index) && Actors[Index].IsValid())
+	{
+		Actors[Index]->DirectorIndex = Index;
+	}
+}
+
+void UEnemyDirectorSubsystem::SetAttackCooldown(AEnemy* Enemy, float Delay)
+{
+	if (Enemy && AttackCooldowns.IsValidIndex(Enemy->DirectorIndex))
+	{
+		AttackCooldowns[Enemy->DirectorIndex] = FMath::Max(Delay, 0.f);
+	}
+}
+
+void UEnemyDirectorSubsystem::ClearAttackCooldown(AEnemy* Enemy)
+{
+	if (Enemy && AttackCooldowns.IsValidIndex(Enemy->DirectorIndex))
+	{
+		AttackCooldowns[Enemy->DirectorIndex] = -1.f;
+	}
+}
+
+void UEnemyDirectorSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyDirectorTick);
+
+	GatherState();
+	DecideAll(DeltaTime, GetWorld()->GetTimeSeconds(), GetWorld()->GetSubsystem<UFlowFieldSubsystem>());
+	ApplyDecisions();
+
+	SET_DWORD_STAT(STAT_EnemyDirectorNum, Actors.Num());
+}
+
+void UEnemyDirectorSubsystem::GatherState()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyDirectorGather);
+
+	const UFlowFieldSubsystem* FlowFields = GetWorld()->GetSubsystem<UFlowFieldSubsystem>();
+
+	for (int32 i = Actors.Num() - 1; i >= 0; i--)
+	{
+		AEnemy* Enemy = Actors[i].Get();
+		if (!Enemy)
+		{
+			// Destroyed without going through EndPlay
+			RemoveAt(i);
+			continue;
+		}
+
+		Positions[i] = Enemy->GetActorLocation();
+		Health[i] = Enemy->Health;
+		MovementStatus[i] = Enemy->GetEnemyMovementStatus();
+
+		AMain* ChaseTarget = Enemy->ChaseTarget.Get();
+		CombatFlags[i] = (Enemy->bHasValidTarget ? EnemyDirector::HasValidTarget : 0)
+			| (Enemy->bOverlappingCombatSphere ? EnemyDirector::OverlappingCombatSphere : 0)
+			| (Enemy->bAttacking ? EnemyDirector::Attacking : 0)
+			| (ChaseTarget ? EnemyDirector::HasChaseTarget : 0);
+
+		if (ChaseTarget)
+		{
+			GoalLocations[i] = ChaseTarget->GetActorLocation();
+			PathGoalLocations[i] = Enemy->LastPathGoalLocation;
+			LastPathTimes[i] = Enemy->LastPathTime;
+			RepathIntervals[i] = Enemy->RepathInterval;
+			RepathDistancesSq[i] = FMath::Square(Enemy->RepathDistanceThreshold);
+		}
+
+		const bool bFlowField = ChaseTarget && FlowFields && Enemy->NavigationMode == EEnemyNavigationMode::ENM_FlowField;
+		FlowFieldIndices[i] = bFlowField ? FlowFields->FindField(ChaseTarget) : INDEX_NONE;
+	}
+}
+
+void UEnemyDirectorSubsystem::DecideAll(float DeltaTime, float Now, const UFlowFieldSubsystem* FlowFields)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyDirectorDecide);
+
+	const int32 NumEnemies = Actors.Num();
+	const int32 NumBatches = FMath::DivideAndRoundUp(NumEnemies, EnemyDirector::BatchSize);
+
+	// Only touches the plain arrays, never the actors
+	ParallelFor(NumBatches, [this, DeltaTime, Now, FlowFields, NumEnemies](int32 Batch)
+	{
+		const int32 Start = Batch * EnemyDirector::BatchSize;
+		const int32 End = FMath::Min(Start + EnemyDirector::BatchSize, NumEnemies);
+
+		for (int32 i = Start; i < End; i++)
+		{
+			Decisions[i] = EEnemyDecision::EED_None;
+
+			const bool bAlive = MovementStatus[i] != EEnemyMovementStatus::EMS_Dead && Health[i] > 0.f;
+
+			const bool bChasing = bAlive && MovementStatus[i] == EEnemyMovementStatus::EMS_MoveToTarget && (CombatFlags[i] & EnemyDirector::HasChaseTarget);
+
+			if (bChasing && FlowFieldIndices[i] != INDEX_NONE)
+			{
+				// Field reads only, the flow field subsystem never ticks during this pass
+				if (FVector::DistSquared2D(Positions[i], GoalLocations[i]) > FMath::Square(FlowAcceptanceRadius)
+					&& FlowFields->SampleDirection(FlowFieldIndices[i], Positions[i], FlowDirections[i]))
+				{
+					Decisions[i] = EEnemyDecision::EED_FlowMove;
+				}
+			}
+			else if (bChasing)
+			{
+				// Re-path only once the goal has moved far enough and the LOD tier allows it again
+				const float Interval = FMath::Max(RepathIntervals[i], MinRepathInterval);
+				if (Now - LastPathTimes[i] >= Interval && FVector::DistSquared(GoalLocations[i], PathGoalLocations[i]) > RepathDistancesSq[i])
+				{
+					Decisions[i] = EEnemyDecision::EED_Repath;
+				}
+			}
+
+			float& Cooldown = AttackCooldowns[i];
+			if (Cooldown < 0.f) continue;
+
+			Cooldown -= DeltaTime;
+			if (Cooldown > 0.f) continue;
+
+			// Same one-shot semantics as the old AttackTimer: the next attack is rescheduled from AttackEnd
+			Cooldown = -1.f;
+
+			if (bAlive && (CombatFlags[i] & EnemyDirector::HasValidTarget))
+			{
+				Decisions[i] = EEnemyDecision::EED_Attack;
+			}
+		}
+	}, NumBatches < 2);
+}
+
+void UEnemyDirectorSubsystem::ApplyDecisions()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyDirectorApply);
+
+	for (int32 i = 0; i < Actors.Num(); i++)
+	{
+		if (Decisions[i] == EEnemyDecision::EED_None) continue;
+
+		AEnemy* Enemy = Actors[i].Get();
+		if (!Enemy) continue;
+
+		switch (Decisions[i])
+		{
+		case EEnemyDecision::EED_Attack:
+			Enemy->Attack();
+			break;
+		case EEnemyDecision::EED_Repath:
+			Enemy->MoveToTarget(Enemy->ChaseTarget.Get());
+			break;
+		case EEnemyDecision::EED_FlowMove:
+			Enemy->AddMovementInput(FlowDirections[i]);
+			break;
+		default:
+			;
+		}
+	}
+}
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Enemy.h"
+#include "EnemyDirectorSubsystem.generated.h"
+
+UENUM()
+enum class EEnemyDecision : uint8
+{
+	EED_None UMETA(DisplayName = "None"),
+	EED_Attack UMETA(DisplayName = "Attack"),
+	EED_Repath UMETA(DisplayName = "Repath"),
+	EED_FlowMove UMETA(DisplayName = "FlowMove"),
+
+	EED_Max UMETA(DisplayName = "DefaultMax")
+};
+
+/**
+ * Updates every registered AEnemy in one batched pass instead of per-actor ticks and timers.
+ * State is kept in parallel arrays indexed by AEnemy::DirectorIndex: gathered from the actors on
+ * the game thread, decided in a ParallelFor, and the decisions applied back on the game thread.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UEnemyDirectorSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UEnemyDirectorSubsystem();
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	void RegisterEnemy(AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Enemy will Attack() once Delay seconds have passed, replaces any pending attack */
+	void SetAttackCooldown(AEnemy* Enemy, float Delay);
+
+	void ClearAttackCooldown(AEnemy* Enemy);
+
+	FORCEINLINE int32 Num() const { return Actors.Num(); }
+	FORCEINLINE const TArray<TWeakObjectPtr<AEnemy>>& GetEnemies() const { return Actors; }
+
+	/** Floor for the per-tier re-path interval, seconds */
+	float MinRepathInterval;
+
+	/** Flow field enemies stop steering once this close (2D) to their target */
+	float FlowAcceptanceRadius;
+
+private:
+
+	void RemoveAt(int32 Index);
+
+	void GatherState();
+	void DecideAll(float DeltaTime, float Now, const class UFlowFieldSubsystem* FlowFields);
+	void ApplyDecisions();
+
+	// Structure of arrays, all the same length
+	TArray<TWeakObjectPtr<AEnemy>> Actors;
+	TArray<FVector> Positions;
+	TArray<float> Health;
+	TArray<EEnemyMovementStatus> MovementStatus;
+
+	/** Seconds until the next attack, negative when none is pending */
+	TArray<float> AttackCooldowns;
+
+	/** Packed bHasValidTarget / bOverlappingCombatSphere / bAttacking / has chase target */
+	TArray<uint8> CombatFlags;
+
+	// Re-path throttling inputs
+	TArray<FVector> GoalLocations;
+	TArray<FVector> PathGoalLocations;
+	TArray<float> LastPathTimes;
+	TArray<float> RepathIntervals;
+	TArray<float> RepathDistancesSq;
+
+	// Flow field steering, FlowFieldIndices is INDEX_NONE for path following enemies
+	TArray<int32> FlowFieldIndices;
+	TArray<FVector> FlowDirections;
+
+	TArray<EEnemyDecision> Decisions;
+};
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyLODSettings.h"
+
+UEnemyLODSettings::UEnemyLODSettings()
+{
+	HiddenDistanceScale = 2.f;
+
+	// Full rate in combat range
+	FEnemyLODTier Near;
+	Near.MaxDistance = 1500.f;
+	Tiers.Add(Near);
+
+	FEnemyLODTier Medium;
+	Medium.MaxDistance = 3000.f;
+	Medium.ActorTickInterval = 0.1f;
+	Medium.MovementTickInterval = 0.033f;
+	Medium.AnimTickInterval = 0.033f;
+	Medium.bUpdateRateOptimizations = true;
+	Medium.bEnableCombatSphere = false;
+	Medium.RepathInterval = 0.5f;
+	Tiers.Add(Medium);
+
+	FEnemyLODTier Far;
+	Far.MaxDistance = 5000.f;
+	Far.ActorTickInterval = 0.25f;
+	Far.MovementTickInterval = 0.1f;
+	Far.AnimTickInterval = 0.1f;
+	Far.bUpdateRateOptimizations = true;
+	Far.NonRenderedAnimUpdateRate = 8;
+	Far.bEnableAgroSphere = false;
+	Far.bEnableCombatSphere = false;
+	Far.RepathInterval = 1.5f;
+	Tiers.Add(Far);
+
+	FEnemyLODTier Dormant;
+	Dormant.MaxDistance = BIG_NUMBER;
+	Dormant.ActorTickInterval = 1.f;
+	Dormant.MovementTickInterval = 0.5f;
+	Dormant.AnimTickInterval = 0.5f;
+	Dormant.bUpdateRateOptimizations = true;
+	Dormant.NonRenderedAnimUpdateRate = 16;
+	Dormant.bEnableAgroSphere = false;
+	Dormant.bEnableCombatSphere = false;
+	Dormant.RepathInterval = 4.f;
+	Tiers.Add(Dormant);
+}
+
+int32 UEnemyLODSettings::GetTierForScore(float Score) const
+{
+	for (int32 i = 0; i < Tiers.Num(); i++)
+	{
+		if (Score <= Tiers[i].MaxDistance)
+		{
+			return i;
+		}
+	}
+	return Tiers.Num() - 1;
+}
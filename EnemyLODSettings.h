@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "EnemyLODSettings.generated.h"
+
+/** How much an enemy is allowed to cost at a given significance */
+USTRUCT(BlueprintType)
+struct FEnemyLODTier
+{
+	GENERATED_BODY()
+
+	/** Enemies with a score (distance, scaled up when not rendered) below this use the tier */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD")
+	float MaxDistance = 1500.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD")
+	float ActorTickInterval = 0.f;
+
+	/** Tick interval for the CharacterMovementComponent */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD")
+	float MovementTickInterval = 0.f;
+
+	/** Tick interval for the skeletal mesh, i.e. how often the anim graph updates */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD")
+	float AnimTickInterval = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD")
+	bool bUpdateRateOptimizations = false;
+
+	/** Anim update rate used by URO while the mesh is off screen */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD", meta = (EditCondition = "bUpdateRateOptimizations"))
+	int32 NonRenderedAnimUpdateRate = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD")
+	bool bEnableAgroSphere = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD")
+	bool bEnableCombatSphere = true;
+
+	/** Minimum seconds between AI re-paths */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD")
+	float RepathInterval = 0.f;
+};
+
+/**
+ * Significance tiers for an enemy class, nearest first. The class default object holds the
+ * tiers used by enemies that do not reference an asset.
+ */
+UCLASS(BlueprintType)
+class FIRSTPROYECT2_API UEnemyLODSettings : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UEnemyLODSettings();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD")
+	TArray<FEnemyLODTier> Tiers;
+
+	/** Distance multiplier for enemies the player has not seen recently */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LOD")
+	float HiddenDistanceScale;
+
+	int32 GetTierForScore(float Score) const;
+};
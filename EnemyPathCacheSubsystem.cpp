@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyPathCacheSubsystem.h"
+#include "FirstProyect2.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Path Cache Lookup"), STAT_EnemyPathCacheLookup, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Path Cache Hits"), STAT_EnemyPathCacheHits, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Path Cache Misses"), STAT_EnemyPathCacheMisses, STATGROUP_FirstProyect2);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Path Cache Hit Rate %"), STAT_EnemyPathCacheHitRate, STATGROUP_FirstProyect2);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Paths Computed / s"), STAT_EnemyPathsPerSecond, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cached Paths"), STAT_EnemyPathCacheNum, STATGROUP_FirstProyect2);
+
+UEnemyPathCacheSubsystem::UEnemyPathCacheSubsystem()
+{
+	CellSize = 200.f;
+	MaxPathAge = 1.f;
+	MaxEntries = 512;
+
+	TimeSinceStats = 0.f;
+	WindowHits = 0;
+	WindowMisses = 0;
+}
+
+void UEnemyPathCacheSubsystem::Deinitialize()
+{
+	Paths.Reset();
+
+	Super::Deinitialize();
+}
+
+ETickableTickType UEnemyPathCacheSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Always;
+}
+
+TStatId UEnemyPathCacheSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPathCacheSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyPathCacheSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceStats += DeltaTime;
+	if (TimeSinceStats < 1.f) return;
+
+	const int32 Lookups = WindowHits + WindowMisses;
+	SET_FLOAT_STAT(STAT_EnemyPathCacheHitRate, Lookups > 0 ? 100.f * WindowHits / Lookups : 0.f);
+	SET_FLOAT_STAT(STAT_EnemyPathsPerSecond, WindowMisses / TimeSinceStats);
+
+	TimeSinceStats = 0.f;
+	WindowHits = 0;
+	WindowMisses = 0;
+
+	EvictStale(GetWorld()->GetTimeSeconds());
+	SET_DWORD_STAT(STAT_EnemyPathCacheNum, Paths.Num());
+}
+
+FIntVector UEnemyPathCacheSubsystem::Quantize(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void UEnemyPathCacheSubsystem::EvictStale(double Now)
+{
+	for (auto It = Paths.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().CreationTime > MaxPathAge)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+FNavPathSharedPtr UEnemyPathCacheSubsystem::FindOrBuildPath(AAIController* Controller, const FVector& Start, const FVector& GoalLocation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyPathCacheLookup);
+
+	UWorld* World = GetWorld();
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	if (!Controller || !NavSys) return nullptr;
+
+	const ANavigationData* NavData = NavSys->GetNavDataForProps(Controller->GetNavAgentPropertiesRef());
+	if (!NavData) return nullptr;
+
+	const double Now = World->GetTimeSeconds();
+	const FPathKey Key(Quantize(Start), Quantize(GoalLocation));
+
+	FCachedPath* Cached = Paths.Find(Key);
+	if (Cached && Now - Cached->CreationTime > MaxPathAge)
+	{
+		Paths.Remove(Key);
+		Cached = nullptr;
+	}
+
+	const bool bHit = Cached != nullptr;
+	if (bHit)
+	{
+		WindowHits++;
+		INC_DWORD_STAT(STAT_EnemyPathCacheHits);
+	}
+	else
+	{
+		WindowMisses++;
+		INC_DWORD_STAT(STAT_EnemyPathCacheMisses);
+
+		FPathFindingQuery Query(Controller, *NavData, Start, GoalLocation, UNavigationQueryFilter::GetQueryFilter(*NavData, Controller, nullptr));
+		FPathFindingResult Result = NavSys->FindPathSync(Query);
+		if (!Result.IsSuccessful() || !Result.Path.IsValid()) return nullptr;
+
+		if (Paths.Num() >= MaxEntries)
+		{
+			EvictStale(Now);
+			if (Paths.Num() >= MaxEntries)
+			{
+				Paths.Reset();
+			}
+		}
+
+		Cached = &Paths.Add(Key);
+		Cached->CreationTime = Now;
+		for (const FNavPathPoint& Point : Result.Path->GetPathPoints())
+		{
+			Cached->Points.Add(Point.Location);
+		}
+	}
+
+	// Every user gets its own copy, the path following component owns and mutates it
+	TArray<FVector> Points = Cached->Points;
+	if (Points.Num() < 2) return nullptr;
+
+	Points[0] = Start;
+
+	// The cached end belongs to whichever goal first filled the cell, up to a cell away from this one
+	if (bHit)
+	{
+		FNavLocation ProjectedGoal;
+		if (NavSys->ProjectPointToNavigation(GoalLocation, ProjectedGoal, INVALID_NAVEXTENT, NavData))
+		{
+			Points.Last() = ProjectedGoal.Location;
+		}
+	}
+
+	FNavPathSharedPtr Path = MakeShareable(new FNavigationPath(Points));
+	Path->SetNavigationDataUsed(NavData);
+	Path->SetQuerier(Controller);
+	Path->SetTimeStamp(float(Now));
+
+	return Path;
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "EnemyPathCacheSubsystem.generated.h"
+
+/**
+ * Shares navmesh paths between enemies that start and end in the same quantized cells,
+ * so a cluster chasing the same player pays for one query instead of one each.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UEnemyPathCacheSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UEnemyPathCacheSubsystem();
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return true; }
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/**
+	 * Returns a path from Start to GoalLocation for the controller, reusing a cached corridor when one
+	 * exists for the same cells. The first point is snapped to the exact start and the last to the
+	 * requester's goal projected on the navmesh.
+	 */
+	FNavPathSharedPtr FindOrBuildPath(class AAIController* Controller, const FVector& Start, const FVector& GoalLocation);
+
+	/** Edge of a start/goal cell in cm */
+	float CellSize;
+
+	/** Seconds a corridor stays valid before it has to be recomputed */
+	float MaxPathAge;
+
+	int32 MaxEntries;
+
+private:
+
+	struct FCachedPath
+	{
+		TArray<FVector> Points;
+		double CreationTime;
+	};
+
+	typedef TPair<FIntVector, FIntVector> FPathKey;
+
+	FIntVector Quantize(const FVector& Location) const;
+
+	void EvictStale(double Now);
+
+	TMap<FPathKey, FCachedPath> Paths;
+
+	float TimeSinceStats;
+	int32 WindowHits;
+	int32 WindowMisses;
+};
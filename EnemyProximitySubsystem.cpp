@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyProximitySubsystem.h"
+#include "FirstProyect2.h"
+#include "Enemy.h"
+#include "Main.h"
+#include "EnemyLODSettings.h"
+#include "EnemySpatialHashSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/SphereComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Proximity Update"), STAT_EnemyProximityUpdate, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("Enemy Proximity Dispatch"), STAT_EnemyProximityDispatch, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies With Batched Proximity"), STAT_EnemyProximityNum, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies In Player Range"), STAT_EnemyProximityActive, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Proximity Events"), STAT_EnemyProximityEvents, STATGROUP_FirstProyect2);
+
+static TAutoConsoleVariable<int32> CVarEnemyProximityForceMode(
+	TEXT("FirstProyect2.EnemyProximity.ForceMode"),
+	-1,
+	TEXT("Overrides the enemy class proximity mode for enemies spawned afterwards.\n")
+	TEXT("-1: class setting, 0: physics overlaps, 1: batched queries"),
+	ECVF_Cheat);
+
+UEnemyProximitySubsystem::UEnemyProximitySubsystem()
+{
+	UpdateInterval = 0.1f;
+
+	NumRegistered = 0;
+	MaxAgroRadius = 0.f;
+	PassIndex = 0;
+	TimeSinceUpdate = 0.f;
+}
+
+void UEnemyProximitySubsystem::Deinitialize()
+{
+	States.Reset();
+	ActiveIds.Reset();
+	PendingEvents.Reset();
+	NumRegistered = 0;
+
+	Super::Deinitialize();
+}
+
+ETickableTickType UEnemyProximitySubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UEnemyProximitySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyProximitySubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyProximitySubsystem::ShouldUseBatchedQuery(const AEnemy* Enemy)
+{
+	const int32 ForceMode = CVarEnemyProximityForceMode.GetValueOnGameThread();
+	if (ForceMode >= 0)
+	{
+		return ForceMode > 0;
+	}
+	return Enemy->ProximityMode == EEnemyProximityMode::EPM_BatchedQuery;
+}
+
+void UEnemyProximitySubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (!Enemy || Enemy->SpatialHashId == INDEX_NONE) return;
+
+	const int32 Id = Enemy->SpatialHashId;
+	if (Id >= States.Num())
+	{
+		States.SetNum(Id + 1);
+	}
+
+	FProximityState& State = States[Id];
+	if (State.bRegistered && State.Enemy.Get() == Enemy) return;
+
+	if (!State.bRegistered)
+	{
+		NumRegistered++;
+	}
+
+	State = FProximityState();
+	State.Enemy = Enemy;
+	State.bRegistered = true;
+
+	MaxAgroRadius = FMath::Max3(MaxAgroRadius, Enemy->AgroSphere->GetScaledSphereRadius(), Enemy->CombatSphere->GetScaledSphereRadius());
+}
+
+void UEnemyProximitySubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	if (!Enemy || !States.IsValidIndex(Enemy->SpatialHashId)) return;
+
+	FProximityState& State = States[Enemy->SpatialHashId];
+	if (!State.bRegistered || State.Enemy.Get() != Enemy) return;
+
+	// Same as the spheres losing their collision: whoever was in range gets the end events
+	UWorld* World = GetWorld();
+	const bool bSendEndEvents = World && !World->bIsTearingDown;
+	if (bSendEndEvents)
+	{
+		Transition(State, nullptr, false, false);
+	}
+
+	State = FProximityState();
+	NumRegistered--;
+
+	if (bSendEndEvents)
+	{
+		DispatchEvents();
+	}
+}
+
+void UEnemyProximitySubsystem::Tick(float DeltaTime)
+{
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < UpdateInterval) return;
+
+	TimeSinceUpdate = 0.f;
+	UpdateProximity();
+	DispatchEvents();
+
+	SET_DWORD_STAT(STAT_EnemyProximityNum, NumRegistered);
+	SET_DWORD_STAT(STAT_EnemyProximityActive, ActiveIds.Num());
+}
+
+void UEnemyProximitySubsystem::UpdateProximity()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyProximityUpdate);
+
+	UWorld* World = GetWorld();
+	UEnemySpatialHashSubsystem* SpatialHash = World ? World->GetSubsystem<UEnemySpatialHashSubsystem>() : nullptr;
+	if (!SpatialHash) return;
+
+	PassIndex++;
+
+	TArray<int32> SeenIds;
+	SeenIds.Reserve(ActiveIds.Num());
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		AMain* Player = PlayerController ? Cast<AMain>(PlayerController->GetPawn()) : nullptr;
+		if (!Player) continue;
+
+		const FVector Origin = Player->GetActorLocation();
+		const float PlayerRadius = Player->GetCapsuleComponent()->GetScaledCapsuleRadius();
+
+		Candidates.Reset();
+		SpatialHash->GetGrid().QueryRadius(Origin, MaxAgroRadius + PlayerRadius, Candidates, [this](int32 Id)
+		{
+			return States.IsValidIndex(Id) && States[Id].bRegistered;
+		});
+
+		for (const int32 Id : Candidates)
+		{
+			FProximityState& State = States[Id];
+			AEnemy* Enemy = State.Enemy.Get();
+			if (!Enemy || !Enemy->Alive()) continue;
+
+			// Already handled by an earlier player this pass, or held by another player
+			if (State.LastSeenPass == PassIndex) continue;
+			if (State.Player.IsValid() && State.Player.Get() != Player) continue;
+
+			// Sphere against the player capsule, approximated by its radius
+			const float Distance = FVector::Dist(Enemy->GetActorLocation(), Origin) - PlayerRadius;
+
+			// A tier that turns a sphere off ends its overlap, same as disabling the collision would
+			const UEnemyLODSettings* Settings = Enemy->GetLODSettings();
+			const FEnemyLODTier* Tier = Settings->Tiers.IsValidIndex(Enemy->LODTier) ? &Settings->Tiers[Enemy->LODTier] : nullptr;
+			const bool bInAgro = (!Tier || Tier->bEnableAgroSphere) && Distance < Enemy->AgroSphere->GetScaledSphereRadius();
+			const bool bInCombat = (!Tier || Tier->bEnableCombatSphere) && Distance < Enemy->CombatSphere->GetScaledSphereRadius();
+			if (!bInAgro && !bInCombat) continue;
+
+			State.LastSeenPass = PassIndex;
+			Transition(State, Player, bInAgro, bInCombat);
+			SeenIds.Add(Id);
+		}
+	}
+
+	// Whatever was in range last pass and was not seen again has left
+	for (const int32 Id : ActiveIds)
+	{
+		if (!States.IsValidIndex(Id)) continue;
+
+		FProximityState& State = States[Id];
+		if (!State.bRegistered || State.LastSeenPass == PassIndex) continue;
+		if (!State.bInAgro && !State.bInCombat) continue;
+
+		Transition(State, nullptr, false, false);
+	}
+
+	ActiveIds = MoveTemp(SeenIds);
+}
+
+void UEnemyProximitySubsystem::Transition(FProximityState& State, AMain* Player, bool bInAgro, bool bInCombat)
+{
+	// Ends go out first and to the player that was in range, begins to the new one
+	if (State.bInCombat && !bInCombat)
+	{
+		PendingEvents.Add({ State.Enemy, State.Player, EProximityEvent::CombatEnd });
+	}
+	if (State.bInAgro && !bInAgro)
+	{
+		PendingEvents.Add({ State.Enemy, State.Player, EProximityEvent::AgroEnd });
+	}
+	if (!State.bInAgro && bInAgro)
+	{
+		PendingEvents.Add({ State.Enemy, Player, EProximityEvent::AgroBegin });
+	}
+	if (!State.bInCombat && bInCombat)
+	{
+		PendingEvents.Add({ State.Enemy, Player, EProximityEvent::CombatBegin });
+	}
+
+	State.bInAgro = bInAgro;
+	State.bInCombat = bInCombat;
+	State.Player = (bInAgro || bInCombat) ? Player : nullptr;
+}
+
+void UEnemyProximitySubsystem::DispatchEvents()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyProximityDispatch);
+
+	// Handlers can move, kill or re-target enemies, so they only run once the whole pass is decided
+	TArray<FPendingEvent> Events = MoveTemp(PendingEvents);
+	INC_DWORD_STAT_BY(STAT_EnemyProximityEvents, Events.Num());
+
+	for (const FPendingEvent& Event : Events)
+	{
+		DispatchEvent(Event);
+	}
+
+	Events.Reset();
+	if (PendingEvents.Num() == 0)
+	{
+		PendingEvents = MoveTemp(Events);
+	}
+}
+
+void UEnemyProximitySubsystem::DispatchEvent(const FPendingEvent& Event)
+{
+	AEnemy* Enemy = Event.Enemy.Get();
+	AMain* Player = Event.Player.Get();
+	if (!Enemy || !Player) return;
+
+	const FHitResult NoSweep;
+	switch (Event.Type)
+	{
+	case EProximityEvent::AgroBegin:
+		Enemy->AgroSphereOnOverlapBegin(Enemy->AgroSphere, Player, Player->GetCapsuleComponent(), 0, false, NoSweep);
+		break;
+	case EProximityEvent::AgroEnd:
+		Enemy->AgroSphereOnOverlapEnd(Enemy->AgroSphere, Player, Player->GetCapsuleComponent(), 0);
+		break;
+	case EProximityEvent::CombatBegin:
+		Enemy->CombatSphereOnOverlapBegin(Enemy->CombatSphere, Player, Player->GetCapsuleComponent(), 0, false, NoSweep);
+		break;
+	case EProximityEvent::CombatEnd:
+		// The mesh is what removes the health bar in the overlap handler
+		Enemy->CombatSphereOnOverlapEnd(Enemy->CombatSphere, Player, Player->GetMesh(), 0);
+		break;
+	}
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "EnemyProximitySubsystem.generated.h"
+
+/**
+ * Replaces the AgroSphere/CombatSphere overlaps of enemies in EPM_BatchedQuery mode. At a fixed
+ * rate every player queries the enemy spatial hash, enter/exit transitions are worked out against
+ * the previous pass and then delivered through the same overlap handlers the spheres would call.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UEnemyProximitySubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UEnemyProximitySubsystem();
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return NumRegistered > 0; }
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** Enemy must already be in the spatial hash, its state is keyed by SpatialHashId */
+	void RegisterEnemy(class AEnemy* Enemy);
+
+	/** Sends the end events for a player still in range, then drops the enemy's state (death, pooling) */
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Class setting of the enemy unless FirstProyect2.EnemyProximity.ForceMode overrides it */
+	static bool ShouldUseBatchedQuery(const AEnemy* Enemy);
+
+	/** Seconds between proximity passes */
+	float UpdateInterval;
+
+private:
+
+	enum class EProximityEvent : uint8
+	{
+		AgroBegin,
+		AgroEnd,
+		CombatBegin,
+		CombatEnd
+	};
+
+	struct FProximityState
+	{
+		TWeakObjectPtr<AEnemy> Enemy;
+
+		/** Player currently inside one of the ranges */
+		TWeakObjectPtr<class AMain> Player;
+
+		uint32 LastSeenPass = 0;
+		bool bRegistered = false;
+		bool bInAgro = false;
+		bool bInCombat = false;
+	};
+
+	struct FPendingEvent
+	{
+		TWeakObjectPtr<AEnemy> Enemy;
+		TWeakObjectPtr<AMain> Player;
+		EProximityEvent Type;
+	};
+
+	void UpdateProximity();
+
+	/** Queues the events that move State to the new ranges, combat always nested inside agro */
+	void Transition(FProximityState& State, AMain* Player, bool bInAgro, bool bInCombat);
+
+	void DispatchEvents();
+
+	void DispatchEvent(const FPendingEvent& Event);
+
+	/** Indexed by AEnemy::SpatialHashId */
+	TArray<FProximityState> States;
+
+	/** Ids with a player in range after the last pass */
+	TArray<int32> ActiveIds;
+
+	TArray<FPendingEvent> PendingEvents;
+
+	TArray<int32> Candidates;
+
+	int32 NumRegistered;
+	float MaxAgroRadius;
+
+	uint32 PassIndex;
+	float TimeSinceUpdate;
+};
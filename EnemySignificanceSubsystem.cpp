@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySignificanceSubsystem.h"
+#include "FirstProyect2.h"
+#include "Enemy.h"
+#include "Main.h"
+#include "EnemyLODSettings.h"
+#include "EnemyDirectorSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/SphereComponent.h"
+#include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Significance"), STAT_EnemySignificance, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies LOD Tier 0"), STAT_EnemyLODTier0, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies LOD Tier 1"), STAT_EnemyLODTier1, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies LOD Tier 2"), STAT_EnemyLODTier2, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies LOD Tier 3+"), STAT_EnemyLODTier3, STATGROUP_FirstProyect2);
+
+static TAutoConsoleVariable<int32> CVarEnemyLODDebug(
+	TEXT("FirstProyect2.EnemyLOD.Debug"),
+	0,
+	TEXT("Draw the significance tier above every enemy."),
+	ECVF_Cheat);
+
+UEnemySignificanceSubsystem::UEnemySignificanceSubsystem()
+{
+	UpdateInterval = 0.2f;
+	TimeSinceUpdate = 0.f;
+}
+
+bool UEnemySignificanceSubsystem::IsTickable() const
+{
+	return true;
+}
+
+ETickableTickType UEnemySignificanceSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Always;
+}
+
+TStatId UEnemySignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemySignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemySignificanceSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < UpdateInterval) return;
+
+	TimeSinceUpdate = 0.f;
+	UpdateSignificance();
+}
+
+void UEnemySignificanceSubsystem::UpdateSignificance()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemySignificance);
+
+	UWorld* World = GetWorld();
+	UEnemyDirectorSubsystem* Director = World ? World->GetSubsystem<UEnemyDirectorSubsystem>() : nullptr;
+	if (!Director) return;
+
+	TArray<FVector, TInlineAllocator<4>> Viewers;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		AMain* Main = PlayerController ? Cast<AMain>(PlayerController->GetPawn()) : nullptr;
+		if (Main)
+		{
+			Viewers.Add(Main->GetActorLocation());
+		}
+	}
+	if (Viewers.Num() == 0) return;
+
+	int32 TierCounts[4] = { 0, 0, 0, 0 };
+	TArray<AEnemy*> Enemies;
+	Enemies.Reserve(Director->Num());
+
+	for (const TWeakObjectPtr<AEnemy>& EnemyPtr : Director->GetEnemies())
+	{
+		AEnemy* Enemy = EnemyPtr.Get();
+		if (!Enemy || !Enemy->Alive()) continue;
+
+		const FVector Location = Enemy->GetActorLocation();
+		float DistanceSq = BIG_NUMBER;
+		for (const FVector& Viewer : Viewers)
+		{
+			DistanceSq = FMath::Min(DistanceSq, FVector::DistSquared(Location, Viewer));
+		}
+
+		const UEnemyLODSettings* Settings = Enemy->GetLODSettings();
+		float Score = FMath::Sqrt(DistanceSq);
+		if (!Enemy->WasRecentlyRendered(UpdateInterval))
+		{
+			Score *= Settings->HiddenDistanceScale;
+		}
+
+		const int32 Tier = Settings->GetTierForScore(Score);
+		ApplyTier(Enemy, Tier);
+
+		TierCounts[FMath::Clamp(Tier, 0, 3)]++;
+		Enemies.Add(Enemy);
+	}
+
+	SET_DWORD_STAT(STAT_EnemyLODTier0, TierCounts[0]);
+	SET_DWORD_STAT(STAT_EnemyLODTier1, TierCounts[1]);
+	SET_DWORD_STAT(STAT_EnemyLODTier2, TierCounts[2]);
+	SET_DWORD_STAT(STAT_EnemyLODTier3, TierCounts[3]);
+
+	if (CVarEnemyLODDebug.GetValueOnGameThread() > 0)
+	{
+		DrawDebug(Enemies);
+	}
+}
+
+void UEnemySignificanceSubsystem::ApplyTier(AEnemy* Enemy, int32 Tier)
+{
+	const UEnemyLODSettings* Settings = Enemy->GetLODSettings();
+	if (Tier == Enemy->LODTier || !Settings->Tiers.IsValidIndex(Tier)) return;
+
+	const FEnemyLODTier& LOD = Settings->Tiers[Tier];
+	Enemy->LODTier = Tier;
+	Enemy->RepathInterval = LOD.RepathInterval;
+
+	Enemy->SetActorTickInterval(LOD.ActorTickInterval);
+	Enemy->GetCharacterMovement()->SetComponentTickInterval(LOD.MovementTickInterval);
+
+	USkeletalMeshComponent* Mesh = Enemy->GetMesh();
+	Mesh->SetComponentTickInterval(LOD.AnimTickInterval);
+	Mesh->bEnableUpdateRateOptimizations = LOD.bUpdateRateOptimizations;
+	if (Mesh->AnimUpdateRateParams)
+	{
+		Mesh->AnimUpdateRateParams->BaseNonRenderedUpdateRate = LOD.NonRenderedAnimUpdateRate;
+	}
+
+	// Batched proximity reads the tier flags itself, its spheres stay out of the broadphase
+	if (!Enemy->bBatchedProximity)
+	{
+		Enemy->AgroSphere->SetCollisionEnabled(LOD.bEnableAgroSphere ? ECollisionEnabled::QueryOnly : ECollisionEnabled::NoCollision);
+		Enemy->CombatSphere->SetCollisionEnabled(LOD.bEnableCombatSphere ? ECollisionEnabled::QueryOnly : ECollisionEnabled::NoCollision);
+	}
+}
+
+void UEnemySignificanceSubsystem::DrawDebug(const TArray<AEnemy*>& Enemies) const
+{
+	static const FColor TierColors[] = { FColor::Red, FColor::Orange, FColor::Yellow, FColor::Green };
+
+	for (AEnemy* Enemy : Enemies)
+	{
+		const FColor Color = TierColors[FMath::Clamp(Enemy->LODTier, 0, 3)];
+		const FVector Location = Enemy->GetActorLocation() + FVector(0.f, 0.f, 120.f);
+
+		DrawDebugString(GetWorld(), Location, FString::Printf(TEXT("LOD %d"), Enemy->LODTier), nullptr, Color, UpdateInterval, false);
+		DrawDebugSphere(GetWorld(), Location, 15.f, 6, Color, false, UpdateInterval);
+	}
+}
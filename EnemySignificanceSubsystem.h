@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "EnemySignificanceSubsystem.generated.h"
+
+/**
+ * Scores every directed enemy by distance and visibility to the player and moves it between
+ * the tiers of its UEnemyLODSettings, scaling tick rates, anim updates, AI spheres and re-pathing.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UEnemySignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UEnemySignificanceSubsystem();
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** Seconds between significance passes */
+	float UpdateInterval;
+
+	/** Applies the tier settings to one enemy, skipped when it is already in that tier */
+	static void ApplyTier(class AEnemy* Enemy, int32 Tier);
+
+private:
+
+	void UpdateSignificance();
+
+	void DrawDebug(const TArray<AEnemy*>& Enemies) const;
+
+	float TimeSinceUpdate;
+};
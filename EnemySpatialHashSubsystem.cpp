@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySpatialHashSubsystem.h"
+#include "FirstProyect2.h"
+#include "Enemy.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Spatial Hash Update"), STAT_EnemySpatialHashUpdate, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("Enemy Spatial Hash Query"), STAT_EnemySpatialHashQuery, STATGROUP_FirstProyect2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies In Spatial Hash"), STAT_EnemySpatialHashNum, STATGROUP_FirstProyect2);
+
+UEnemySpatialHashSubsystem::UEnemySpatialHashSubsystem()
+{
+	CellSize = 500.f;
+}
+
+void UEnemySpatialHashSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Grid.Reset(CellSize);
+	Enemies.Reset();
+	FreeIds.Reset();
+}
+
+void UEnemySpatialHashSubsystem::Deinitialize()
+{
+	for (const TWeakObjectPtr<AEnemy>& Enemy : Enemies)
+	{
+		if (Enemy.IsValid())
+		{
+			Enemy->SpatialHashId = INDEX_NONE;
+		}
+	}
+	Enemies.Reset();
+	FreeIds.Reset();
+	Grid.Reset(CellSize);
+
+	Super::Deinitialize();
+}
+
+bool UEnemySpatialHashSubsystem::IsTickable() const
+{
+	return Grid.Num() > 0;
+}
+
+ETickableTickType UEnemySpatialHashSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UEnemySpatialHashSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemySpatialHashSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemySpatialHashSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemySpatialHashUpdate);
+
+	for (int32 Id = 0; Id < Enemies.Num(); Id++)
+	{
+		if (!Grid.Contains(Id)) continue;
+
+		AEnemy* Enemy = Enemies[Id].Get();
+		if (Enemy)
+		{
+			Grid.Update(Id, Enemy->GetActorLocation());
+		}
+		else
+		{
+			// Destroyed without going through EndPlay (level streamed out, etc.)
+			Grid.Remove(Id);
+			Enemies[Id].Reset();
+			FreeIds.Add(Id);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_EnemySpatialHashNum, Grid.Num());
+}
+
+void UEnemySpatialHashSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (!Enemy || Enemy->SpatialHashId != INDEX_NONE) return;
+
+	const int32 Id = FreeIds.Num() > 0 ? FreeIds.Pop(false) : Enemies.AddDefaulted();
+	Enemies[Id] = Enemy;
+	Enemy->SpatialHashId = Id;
+
+	Grid.Add(Id, Enemy->GetActorLocation());
+}
+
+void UEnemySpatialHashSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	if (!Enemy || !Enemies.IsValidIndex(Enemy->SpatialHashId)) return;
+
+	const int32 Id = Enemy->SpatialHashId;
+	Grid.Remove(Id);
+	Enemies[Id].Reset();
+	FreeIds.Add(Id);
+
+	Enemy->SpatialHashId = INDEX_NONE;
+}
+
+void UEnemySpatialHashSubsystem::UpdateEnemy(AEnemy* Enemy)
+{
+	if (Enemy && Grid.Contains(Enemy->SpatialHashId))
+	{
+		Grid.Update(Enemy->SpatialHashId, Enemy->GetActorLocation());
+	}
+}
+
+bool UEnemySpatialHashSubsystem::PassesFilter(int32 Id, UClass* Filter) const
+{
+	AEnemy* Enemy = Enemies[Id].Get();
+	return Enemy && Enemy->Alive() && (!Filter || Enemy->IsA(Filter));
+}
+
+void UEnemySpatialHashSubsystem::QueryEnemiesInRadius(const FVector& Origin, float Radius, TArray<AEnemy*>& OutEnemies, TSubclassOf<AEnemy> Filter) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemySpatialHashQuery);
+
+	UClass* FilterClass = Filter.Get();
+	TArray<int32> Ids;
+	Grid.QueryRadius(Origin, Radius, Ids, [this, FilterClass](int32 Id) { return PassesFilter(Id, FilterClass); });
+
+	OutEnemies.Reset(Ids.Num());
+	for (int32 Id : Ids)
+	{
+		OutEnemies.Add(Enemies[Id].Get());
+	}
+}
+
+void UEnemySpatialHashSubsystem::FindKNearestEnemies(const FVector& Origin, float MaxRadius, int32 Count, TArray<AEnemy*>& OutEnemies, TSubclassOf<AEnemy> Filter) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemySpatialHashQuery);
+
+	UClass* FilterClass = Filter.Get();
+	TArray<int32> Ids;
+	Grid.FindKNearest(Origin, MaxRadius, Count, Ids, [this, FilterClass](int32 Id) { return PassesFilter(Id, FilterClass); });
+
+	OutEnemies.Reset(Ids.Num());
+	for (int32 Id : Ids)
+	{
+		OutEnemies.Add(Enemies[Id].Get());
+	}
+}
+
+AEnemy* UEnemySpatialHashSubsystem::FindNearestEnemy(const FVector& Origin, float MaxRadius, TSubclassOf<AEnemy> Filter) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemySpatialHashQuery);
+
+	UClass* FilterClass = Filter.Get();
+	const int32 Id = Grid.FindNearest(Origin, MaxRadius, [this, FilterClass](int32 Id) { return PassesFilter(Id, FilterClass); });
+
+	return Id != INDEX_NONE ? Enemies[Id].Get() : nullptr;
+}
+
+/**
+ * FirstProyect2.SpatialHashBench [NumEnemies=10000] [NumQueries=1000] [Radius=650]
+ * Compares the nearest-target search of the old UpdateCombatTarget (scan every candidate and
+ * compare Size()) against the grid. Overlap gathering is not included in the old path, so the
+ * reported speed-up is a lower bound.
+ */
+static void RunSpatialHashBenchmark(const TArray<FString>& Args)
+{
+	const int32 NumEnemies = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000;
+	const int32 NumQueries = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1000;
+	const float Radius = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 650.f;
+
+	// Same density as a packed arena: 10k enemies over 200m x 200m
+	const float HalfExtent = 10000.f * FMath::Sqrt(NumEnemies / 10000.f);
+
+	FRandomStream Stream(1337);
+	TArray<FVector> Locations;
+	Locations.Reserve(NumEnemies);
+	for (int32 i = 0; i < NumEnemies; i++)
+	{
+		Locations.Add(FVector(Stream.FRandRange(-HalfExtent, HalfExtent), Stream.FRandRange(-HalfExtent, HalfExtent), 0.f));
+	}
+
+	TArray<FVector> Queries;
+	Queries.Reserve(NumQueries);
+	for (int32 i = 0; i < NumQueries; i++)
+	{
+		Queries.Add(FVector(Stream.FRandRange(-HalfExtent, HalfExtent), Stream.FRandRange(-HalfExtent, HalfExtent), 0.f));
+	}
+
+	double StartTime = FPlatformTime::Seconds();
+	FSpatialHashGrid Grid(500.f);
+	for (int32 i = 0; i < NumEnemies; i++)
+	{
+		Grid.Add(i, Locations[i]);
+	}
+	const double BuildTime = FPlatformTime::Seconds() - StartTime;
+
+	int32 LinearFound = 0;
+	StartTime = FPlatformTime::Seconds();
+	for (const FVector& Query : Queries)
+	{
+		int32 Closest = INDEX_NONE;
+		float MinDistance = Radius;
+		for (int32 i = 0; i < NumEnemies; i++)
+		{
+			const float Distance = (Locations[i] - Query).Size();
+			if (Distance < MinDistance)
+			{
+				MinDistance = Distance;
+				Closest = i;
+			}
+		}
+		if (Closest != INDEX_NONE) LinearFound++;
+	}
+	const double LinearTime = FPlatformTime::Seconds() - StartTime;
+
+	int32 GridFound = 0;
+	StartTime = FPlatformTime::Seconds();
+	for (const FVector& Query : Queries)
+	{
+		if (Grid.FindNearest(Query, Radius, [](int32) { return true; }) != INDEX_NONE) GridFound++;
+	}
+	const double GridTime = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogTemp, Display, TEXT("SpatialHashBench: %d enemies, %d queries, radius %.0f"), NumEnemies, NumQueries, Radius);
+	UE_LOG(LogTemp, Display, TEXT("  grid build      %8.3f ms"), BuildTime * 1000.0);
+	UE_LOG(LogTemp, Display, TEXT("  linear scan     %8.3f ms (%.2f us/query, %d hits)"), LinearTime * 1000.0, LinearTime * 1e6 / FMath::Max(NumQueries, 1), LinearFound);
+	UE_LOG(LogTemp, Display, TEXT("  grid nearest    %8.3f ms (%.2f us/query, %d hits)"), GridTime * 1000.0, GridTime * 1e6 / FMath::Max(NumQueries, 1), GridFound);
+}
+
+static FAutoConsoleCommand SpatialHashBenchCommand(
+	TEXT("FirstProyect2.SpatialHashBench"),
+	TEXT("Benchmarks the enemy spatial hash against a linear nearest-enemy scan. Args: [NumEnemies] [NumQueries] [Radius]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunSpatialHashBenchmark));
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SpatialHashGrid.h"
+#include "EnemySpatialHashSubsystem.generated.h"
+
+/**
+ * Keeps a uniform grid of every live AEnemy in the world so target selection
+ * and HUD queries do not have to go through physics overlaps.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UEnemySpatialHashSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UEnemySpatialHashSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	void RegisterEnemy(class AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Re-buckets a single enemy right away instead of waiting for the next tick */
+	void UpdateEnemy(AEnemy* Enemy);
+
+	UFUNCTION(BlueprintCallable, Category = "Spatial")
+	void QueryEnemiesInRadius(const FVector& Origin, float Radius, TArray<AEnemy*>& OutEnemies, TSubclassOf<AEnemy> Filter = nullptr) const;
+
+	/** Up to Count live enemies sorted by distance */
+	UFUNCTION(BlueprintCallable, Category = "Spatial")
+	void FindKNearestEnemies(const FVector& Origin, float MaxRadius, int32 Count, TArray<AEnemy*>& OutEnemies, TSubclassOf<AEnemy> Filter = nullptr) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Spatial")
+	AEnemy* FindNearestEnemy(const FVector& Origin, float MaxRadius, TSubclassOf<AEnemy> Filter = nullptr) const;
+
+	FORCEINLINE const FSpatialHashGrid& GetGrid() const { return Grid; }
+	FORCEINLINE AEnemy* GetEnemy(int32 Id) const { return Enemies.IsValidIndex(Id) ? Enemies[Id].Get() : nullptr; }
+
+	/** Cell edge in cm, a bit under the agro radius so a target query touches ~9 cells */
+	float CellSize;
+
+private:
+
+	bool PassesFilter(int32 Id, UClass* Filter) const;
+
+	FSpatialHashGrid Grid;
+
+	/** Indexed by AEnemy::SpatialHashId */
+	TArray<TWeakObjectPtr<AEnemy>> Enemies;
+
+	TArray<int32> FreeIds;
+};
@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ExplosionSubsystem.h"
+#include "FirstProyect2.h"
+#include "Explosive.h"
+#include "Main.h"
+#include "Enemy.h"
+#include "EnemySpatialHashSubsystem.h"
+#include "ActorPoolSubsystem.h"
+#include "FXManagerSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/World.h"
+#include "Sound/SoundCue.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Explosion Resolve"), STAT_ExplosionResolve, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Explosions"), STAT_Explosions, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Chained Explosions"), STAT_ExplosionsChained, STATGROUP_FirstProyect2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Clusters"), STAT_ExplosionClusters, STATGROUP_FirstProyect2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosions Deferred"), STAT_ExplosionsDeferred, STATGROUP_FirstProyect2);
+
+static TAutoConsoleVariable<int32> CVarMaxExplosionsPerFrame(
+	TEXT("FirstProyect2.MaxExplosionsPerFrame"),
+	32,
+	TEXT("Detonations resolved per frame, the rest wait for the next frame in order."),
+	ECVF_Default);
+
+UExplosionSubsystem::UExplosionSubsystem()
+{
+	ClusterCellSize = 1000.f;
+	PendingHead = 0;
+}
+
+void UExplosionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Grid.Reset(ClusterCellSize * 0.5f);
+}
+
+void UExplosionSubsystem::Deinitialize()
+{
+	for (const TWeakObjectPtr<AExplosive>& Explosive : Explosives)
+	{
+		if (Explosive.IsValid())
+		{
+			Explosive->ExplosionId = INDEX_NONE;
+		}
+	}
+	Explosives.Reset();
+	FreeIds.Reset();
+	Grid.Reset(ClusterCellSize * 0.5f);
+
+	Pending.Reset();
+	PendingHead = 0;
+
+	Super::Deinitialize();
+}
+
+bool UExplosionSubsystem::IsTickable() const
+{
+	return NumPending() > 0;
+}
+
+ETickableTickType UExplosionSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UExplosionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UExplosionSubsystem, STATGROUP_Tickables);
+}
+
+void UExplosionSubsystem::RegisterExplosive(AExplosive* Explosive)
+{
+	if (!Explosive || Explosive->ExplosionId != INDEX_NONE) return;
+
+	const int32 Id = FreeIds.Num() > 0 ? FreeIds.Pop(false) : Explosives.AddDefaulted();
+	Explosives[Id] = Explosive;
+	Explosive->ExplosionId = Id;
+
+	// Explosives sit still, so the grid is only touched on register and unregister
+	Grid.Add(Id, Explosive->GetActorLocation());
+}
+
+void UExplosionSubsystem::UnregisterExplosive(AExplosive* Explosive)
+{
+	if (!Explosive || !Explosives.IsValidIndex(Explosive->ExplosionId)) return;
+
+	const int32 Id = Explosive->ExplosionId;
+	Grid.Remove(Id);
+	Explosives[Id].Reset();
+	FreeIds.Add(Id);
+
+	Explosive->ExplosionId = INDEX_NONE;
+}
+
+void UExplosionSubsystem::QueueDetonation(AExplosive* Explosive)
+{
+	Enqueue(Explosive, 0);
+}
+
+void UExplosionSubsystem::Enqueue(AExplosive* Explosive, int32 Depth)
+{
+	if (!Explosive || Explosive->bDetonationQueued) return;
+
+	Explosive->bDetonationQueued = true;
+
+	// Out of the grid right away so no other blast picks it up again
+	UnregisterExplosive(Explosive);
+
+	FDetonation& Detonation = Pending.AddDefaulted_GetRef();
+	Detonation.Explosive = Explosive;
+	Detonation.Location = Explosive->GetActorLocation();
+	Detonation.Radius = Explosive->DamageRadius;
+	Detonation.Damage = Explosive->Damage;
+	Detonation.MinDamageScale = Explosive->MinDamageScale;
+	Detonation.Depth = Depth;
+
+	if (Depth > 0)
+	{
+		INC_DWORD_STAT(STAT_ExplosionsChained);
+	}
+}
+
+void UExplosionSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ExplosionResolve);
+
+	// Only what was queued before this frame, chained detonations found now form the next ring
+	const int32 MaxPerFrame = FMath::Max(CVarMaxExplosionsPerFrame.GetValueOnGameThread(), 1);
+	const int32 NumThisFrame = FMath::Min(NumPending(), MaxPerFrame);
+
+	Batch.Reset();
+	Batch.Append(Pending.GetData() + PendingHead, NumThisFrame);
+	PendingHead += NumThisFrame;
+
+	if (PendingHead == Pending.Num())
+	{
+		Pending.Reset();
+		PendingHead = 0;
+	}
+	else if (PendingHead > Pending.Num() / 2)
+	{
+		Pending.RemoveAt(0, PendingHead, false);
+		PendingHead = 0;
+	}
+
+	Clusters.Reset();
+	for (int32 i = 0; i < Batch.Num(); i++)
+	{
+		const FVector Cell = Batch[i].Location / ClusterCellSize;
+		Clusters.FindOrAdd(FIntVector(FMath::FloorToInt(Cell.X), FMath::FloorToInt(Cell.Y), FMath::FloorToInt(Cell.Z))).Add(i);
+	}
+
+	DamageByTarget.Reset();
+	for (const TPair<FIntVector, TArray<int32>>& Pair : Clusters)
+	{
+		ResolveCluster(Pair.Value);
+	}
+
+	// Summed over every blast that reached the target, so one ApplyDamage each
+	for (const TPair<AActor*, FDamageAccumulator>& Pair : DamageByTarget)
+	{
+		AExplosive* Causer = Batch[Pair.Value.Causer].Explosive.Get();
+		UGameplayStatics::ApplyDamage(Pair.Key, Pair.Value.Damage, nullptr, Causer, Causer ? Causer->DamageTypeClass : nullptr);
+	}
+
+	UFXManagerSubsystem* FX = GetWorld()->GetSubsystem<UFXManagerSubsystem>();
+	for (const FDetonation& Detonation : Batch)
+	{
+		AExplosive* Explosive = Detonation.Explosive.Get();
+		if (!Explosive) continue;
+
+		if (Explosive->OverlapParticles && FX)
+		{
+			FX->SpawnEmitter(Explosive->OverlapParticles, Detonation.Location);
+		}
+		if (Explosive->OverlapSound && FX)
+		{
+			FX->PlaySound2D(Explosive->OverlapSound, Detonation.Location);
+		}
+
+		UActorPoolSubsystem::ReleaseOrDestroy(Explosive);
+	}
+
+	INC_DWORD_STAT_BY(STAT_Explosions, Batch.Num());
+	SET_DWORD_STAT(STAT_ExplosionClusters, Clusters.Num());
+	SET_DWORD_STAT(STAT_ExplosionsDeferred, NumPending());
+}
+
+void UExplosionSubsystem::ResolveCluster(const TArray<int32>& Cluster)
+{
+	FVector Center = FVector::ZeroVector;
+	for (int32 Index : Cluster)
+	{
+		Center += Batch[Index].Location;
+	}
+	Center /= Cluster.Num();
+
+	float ClusterRadius = 0.f;
+	for (int32 Index : Cluster)
+	{
+		ClusterRadius = FMath::Max(ClusterRadius, FVector::Dist(Center, Batch[Index].Location) + Batch[Index].Radius);
+	}
+
+	UWorld* World = GetWorld();
+	if (UEnemySpatialHashSubsystem* SpatialHash = World->GetSubsystem<UEnemySpatialHashSubsystem>())
+	{
+		SpatialHash->QueryEnemiesInRadius(Center, ClusterRadius, EnemyResults);
+		for (AEnemy* Enemy : EnemyResults)
+		{
+			const FVector EnemyLocation = Enemy->GetActorLocation();
+			for (int32 Index : Cluster)
+			{
+				AccumulateDamage(Enemy, Index, FVector::Dist(EnemyLocation, Batch[Index].Location));
+			}
+		}
+	}
+
+	AMain* Main = Cast<AMain>(UGameplayStatics::GetPlayerCharacter(this, 0));
+	if (Main && Main->MovementStatus != EMovementStatus::EMS_Dead && FVector::DistSquared(Main->GetActorLocation(), Center) <= FMath::Square(ClusterRadius))
+	{
+		const FVector MainLocation = Main->GetActorLocation();
+		for (int32 Index : Cluster)
+		{
+			AccumulateDamage(Main, Index, FVector::Dist(MainLocation, Batch[Index].Location));
+		}
+	}
+
+	QueryResults.Reset();
+	Grid.QueryRadius(Center, ClusterRadius, QueryResults);
+	for (int32 Id : QueryResults)
+	{
+		AExplosive* Explosive = Explosives[Id].Get();
+		if (!Explosive) continue;
+
+		const FVector ExplosiveLocation = Explosive->GetActorLocation();
+		for (int32 Index : Cluster)
+		{
+			const FDetonation& Detonation = Batch[Index];
+			if (FVector::DistSquared(ExplosiveLocation, Detonation.Location) <= FMath::Square(Detonation.Radius))
+			{
+				Enqueue(Explosive, Detonation.Depth + 1);
+				break;
+			}
+		}
+	}
+}
+
+void UExplosionSubsystem::AccumulateDamage(AActor* Target, int32 DetonationIndex, float Distance)
+{
+	const FDetonation& Detonation = Batch[DetonationIndex];
+	if (Distance > Detonation.Radius) return;
+
+	// Linear falloff from full damage at the center to MinDamageScale at the edge
+	const float Alpha = Detonation.Radius > 0.f ? Distance / Detonation.Radius : 0.f;
+	const float Damage = Detonation.Damage * FMath::Lerp(1.f, Detonation.MinDamageScale, Alpha);
+
+	FDamageAccumulator& Accumulator = DamageByTarget.FindOrAdd(Target);
+	Accumulator.Damage += Damage;
+	if (Accumulator.Causer == INDEX_NONE || Damage > Accumulator.CauserDamage)
+	{
+		Accumulator.Causer = DetonationIndex;
+		Accumulator.CauserDamage = Damage;
+	}
+}
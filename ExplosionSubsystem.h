@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SpatialHashGrid.h"
+#include "ExplosionSubsystem.generated.h"
+
+/**
+ * Resolves every AExplosive detonation of a frame together. Detonations are grouped into clusters
+ * and each cluster does one query against UEnemySpatialHashSubsystem and one against the armed
+ * explosives; damage with falloff is summed per target and applied once. Explosives caught in a
+ * blast detonate on the next frame, so a chain spreads breadth-first one ring per frame, and at most
+ * FirstProyect2.MaxExplosionsPerFrame are resolved in a frame with the rest carried over.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UExplosionSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UExplosionSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** Armed explosives can be set off by a blast */
+	void RegisterExplosive(class AExplosive* Explosive);
+	void UnregisterExplosive(AExplosive* Explosive);
+
+	/** Resolved on the next tick, an explosive already waiting is not queued twice */
+	UFUNCTION(BlueprintCallable, Category = "Explosion")
+	void QueueDetonation(AExplosive* Explosive);
+
+	FORCEINLINE int32 NumPending() const { return Pending.Num() - PendingHead; }
+
+	/** Detonations in the same cell of this size share a cluster and its queries */
+	float ClusterCellSize;
+
+private:
+
+	struct FDetonation
+	{
+		TWeakObjectPtr<AExplosive> Explosive;
+		FVector Location;
+		float Radius;
+		float Damage;
+		float MinDamageScale;
+
+		/** 0 for a detonation set off by contact, +1 per link in a chain */
+		int32 Depth;
+	};
+
+	struct FDamageAccumulator
+	{
+		float Damage = 0.f;
+
+		/** The detonation that dealt the most, reported as the damage causer */
+		int32 Causer = INDEX_NONE;
+		float CauserDamage = 0.f;
+	};
+
+	void ResolveCluster(const TArray<int32>& Cluster);
+
+	void AccumulateDamage(AActor* Target, int32 DetonationIndex, float Distance);
+
+	void Enqueue(AExplosive* Explosive, int32 Depth);
+
+	/** FIFO, entries before PendingHead are done */
+	TArray<FDetonation> Pending;
+	int32 PendingHead;
+
+	/** This frame's detonations, clusters index into it */
+	TArray<FDetonation> Batch;
+	TMap<FIntVector, TArray<int32>> Clusters;
+	TMap<AActor*, FDamageAccumulator> DamageByTarget;
+	TArray<int32> QueryResults;
+	TArray<class AEnemy*> EnemyResults;
+
+	FSpatialHashGrid Grid;
+
+	/** Indexed by AExplosive::ExplosionId */
+	TArray<TWeakObjectPtr<AExplosive>> Explosives;
+
+	TArray<int32> FreeIds;
+};
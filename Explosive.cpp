@@ -7,12 +7,60 @@
 #include "Engine/World.h"
 #include "Sound/SoundCue.h"
 #include "Particles/ParticleSystemComponent.h"
+#include "ActorPoolSubsystem.h"
+#include "FXManagerSubsystem.h"
 #include "Enemy.h"
-#include "Kismet/GameplayStatics.h"
+#include "ExplosionSubsystem.h"
 
 AExplosive::AExplosive()
 {
 	Damage = 15.f;
+	DamageRadius = 400.f;
+	MinDamageScale = 0.25f;
+
+	ExplosionId = INDEX_NONE;
+	bDetonationQueued = false;
+}
+
+void AExplosive::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>())
+	{
+		Explosions->RegisterExplosive(this);
+	}
+}
+
+void AExplosive::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>())
+	{
+		Explosions->UnregisterExplosive(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AExplosive::OnAcquiredFromPool_Implementation()
+{
+	Super::OnAcquiredFromPool_Implementation();
+
+	bDetonationQueued = false;
+	if (UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>())
+	{
+		Explosions->RegisterExplosive(this);
+	}
+}
+
+void AExplosive::OnReleasedToPool_Implementation()
+{
+	Super::OnReleasedToPool_Implementation();
+
+	if (UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>())
+	{
+		Explosions->UnregisterExplosive(this);
+	}
 }
 
 void AExplosive::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -26,17 +74,25 @@ void AExplosive::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor
 		AEnemy* Enemy = Cast<AEnemy>(OtherActor);
 		if (Main || Enemy)
 		{
-			if (OverlapParticles)
+			UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>();
+			if (Explosions)
+			{
+				Explosions->QueueDetonation(this);
+				return;
+			}
+
+			UFXManagerSubsystem* FX = GetWorld()->GetSubsystem<UFXManagerSubsystem>();
+			if (OverlapParticles && FX)
 			{
-				UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), OverlapParticles, GetActorLocation(), FRotator(0.f), true);
+				FX->SpawnEmitter(OverlapParticles, GetActorLocation());
 			}
-			if (OverlapSound)
+			if (OverlapSound && FX)
 			{
-				UGameplayStatics::PlaySound2D(this, OverlapSound);
+				FX->PlaySound2D(OverlapSound, GetActorLocation());
 			}
 
 			UGameplayStatics::ApplyDamage(OtherActor, Damage, nullptr, this, DamageTypeClass);
-			Destroy();
+			UActorPoolSubsystem::ReleaseOrDestroy(this);
 		}
 	}
 }
@@ -7,7 +7,8 @@
 #include "Explosive.generated.h"
 
 /**
- * 
+ * Detonates when the player or an enemy touches it. The blast itself, falloff damage and chain
+ * reactions, is resolved by UExplosionSubsystem.
  */
 UCLASS()
 class FIRSTPROYECT2_API AExplosive : public AItem
@@ -19,6 +20,19 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
 	float Damage;
+
+	/** Enemies, the player and other explosives within this distance are caught in the blast */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+	float DamageRadius;
+
+	/** Fraction of Damage dealt at the edge of DamageRadius */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float MinDamageScale;
+
+	/** Slot in UExplosionSubsystem while armed, INDEX_NONE otherwise */
+	int32 ExplosionId;
+
+	bool bDetonationQueued;
 	
 	virtual void OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) override;
 
@@ -26,4 +40,14 @@ public:
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	TSubclassOf<UDamageType> DamageTypeClass;
+
+	// IPoolable
+	virtual void OnAcquiredFromPool_Implementation() override;
+	virtual void OnReleasedToPool_Implementation() override;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 };
@@ -0,0 +1,257 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FXManagerSubsystem.h"
+#include "FirstProyect2.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Components/AudioComponent.h"
+#include "Sound/SoundBase.h"
+
+DECLARE_CYCLE_STAT(TEXT("FX Manager Play"), STAT_FXManagerPlay, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Emitters Playing"), STAT_FXEmittersActive, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Sounds Playing"), STAT_FXSoundsActive, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Pooled Components"), STAT_FXPooledComponents, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Played"), STAT_FXPlayed, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Culled"), STAT_FXCulled, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Capped"), STAT_FXCapped, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Throttled"), STAT_FXThrottled, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Looping Rejected"), STAT_FXLoopingRejected, STATGROUP_FirstProyect2);
+
+UFXManagerSubsystem::UFXManagerSubsystem()
+{
+	MaxConcurrentPerEffect = 8;
+	MaxEmittersPerFrame = 6;
+	MaxSoundsPerFrame = 4;
+	EmitterCullDistance = 6000.f;
+	SoundCullDistance = 4000.f;
+
+	BudgetFrame = MAX_uint64;
+	EmittersThisFrame = 0;
+	SoundsThisFrame = 0;
+}
+
+void UFXManagerSubsystem::Deinitialize()
+{
+	// Destroyed components never report finishing, take whatever is still playing off the stats
+	int32 NumFreeEmitters = 0;
+	for (const TPair<UParticleSystem*, TArray<UParticleSystemComponent*>>& Pair : FreeEmitters)
+	{
+		NumFreeEmitters += Pair.Value.Num();
+	}
+	int32 NumFreeSounds = 0;
+	for (const TPair<USoundBase*, TArray<UAudioComponent*>>& Pair : FreeSounds)
+	{
+		NumFreeSounds += Pair.Value.Num();
+	}
+	DEC_DWORD_STAT_BY(STAT_FXEmittersActive, EmitterComponents.Num() - NumFreeEmitters);
+	DEC_DWORD_STAT_BY(STAT_FXSoundsActive, AudioComponents.Num() - NumFreeSounds);
+	SET_DWORD_STAT(STAT_FXPooledComponents, 0);
+
+	for (UParticleSystemComponent* Component : EmitterComponents)
+	{
+		if (Component)
+		{
+			Component->DestroyComponent();
+		}
+	}
+	for (UAudioComponent* Component : AudioComponents)
+	{
+		if (Component)
+		{
+			Component->DestroyComponent();
+		}
+	}
+
+	EmitterComponents.Reset();
+	AudioComponents.Reset();
+	FreeEmitters.Reset();
+	FreeSounds.Reset();
+	ActiveCounts.Reset();
+	WarnedLooping.Reset();
+
+	Super::Deinitialize();
+}
+
+void UFXManagerSubsystem::BeginFrameIfNeeded()
+{
+	if (BudgetFrame == GFrameCounter) return;
+
+	BudgetFrame = GFrameCounter;
+	EmittersThisFrame = 0;
+	SoundsThisFrame = 0;
+
+	ViewLocations.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (PlayerController && PlayerController->PlayerCameraManager)
+		{
+			ViewLocations.Add(PlayerController->PlayerCameraManager->GetCameraLocation());
+		}
+	}
+}
+
+bool UFXManagerSubsystem::IsCulled(const FVector& Location, float CullDistance) const
+{
+	// Nobody looking yet (loading, dedicated server), nothing worth playing
+	if (ViewLocations.Num() == 0) return true;
+
+	const float CullDistanceSq = FMath::Square(CullDistance);
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		if (FVector::DistSquared(Location, ViewLocation) <= CullDistanceSq) return false;
+	}
+	return true;
+}
+
+bool UFXManagerSubsystem::IsRejectedLooping(const UObject* Effect, bool bLooping)
+{
+	if (!bLooping) return false;
+
+	INC_DWORD_STAT(STAT_FXLoopingRejected);
+	if (!WarnedLooping.Contains(Effect))
+	{
+		WarnedLooping.Add(Effect);
+		UE_LOG(LogTemp, Warning, TEXT("FXManager: %s loops and would never finish, it is not played through the pool"), *GetNameSafe(Effect));
+	}
+	return true;
+}
+
+bool UFXManagerSubsystem::SpawnEmitter(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FXManagerPlay);
+
+	if (!Template || IsRejectedLooping(Template, Template->IsLooping())) return false;
+
+	BeginFrameIfNeeded();
+
+	if (IsCulled(Location, EmitterCullDistance))
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return false;
+	}
+
+	int32& ActiveCount = ActiveCounts.FindOrAdd(Template);
+	if (ActiveCount >= MaxConcurrentPerEffect)
+	{
+		INC_DWORD_STAT(STAT_FXCapped);
+		return false;
+	}
+	if (EmittersThisFrame >= MaxEmittersPerFrame)
+	{
+		INC_DWORD_STAT(STAT_FXThrottled);
+		return false;
+	}
+
+	UParticleSystemComponent* Component = nullptr;
+	TArray<UParticleSystemComponent*>& Free = FreeEmitters.FindOrAdd(Template);
+	while (!Component && Free.Num() > 0)
+	{
+		Component = Free.Pop(false);
+	}
+
+	if (!Component)
+	{
+		Component = NewObject<UParticleSystemComponent>(GetWorld());
+		Component->bAutoActivate = false;
+		Component->bAutoDestroy = false;
+		Component->SetTemplate(Template);
+		Component->OnSystemFinished.AddDynamic(this, &UFXManagerSubsystem::OnEmitterFinished);
+		Component->RegisterComponentWithWorld(GetWorld());
+		EmitterComponents.Add(Component);
+		SET_DWORD_STAT(STAT_FXPooledComponents, EmitterComponents.Num() + AudioComponents.Num());
+	}
+
+	Component->SetWorldLocationAndRotation(Location, Rotation);
+	Component->ActivateSystem(true);
+
+	ActiveCount++;
+	EmittersThisFrame++;
+	INC_DWORD_STAT(STAT_FXPlayed);
+	INC_DWORD_STAT(STAT_FXEmittersActive);
+	return true;
+}
+
+bool UFXManagerSubsystem::PlaySound2D(USoundBase* Sound, const FVector& SourceLocation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FXManagerPlay);
+
+	if (!Sound || IsRejectedLooping(Sound, Sound->IsLooping())) return false;
+
+	BeginFrameIfNeeded();
+
+	if (IsCulled(SourceLocation, SoundCullDistance))
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return false;
+	}
+
+	int32& ActiveCount = ActiveCounts.FindOrAdd(Sound);
+	if (ActiveCount >= MaxConcurrentPerEffect)
+	{
+		INC_DWORD_STAT(STAT_FXCapped);
+		return false;
+	}
+	if (SoundsThisFrame >= MaxSoundsPerFrame)
+	{
+		INC_DWORD_STAT(STAT_FXThrottled);
+		return false;
+	}
+
+	UAudioComponent* Component = nullptr;
+	TArray<UAudioComponent*>& Free = FreeSounds.FindOrAdd(Sound);
+	while (!Component && Free.Num() > 0)
+	{
+		Component = Free.Pop(false);
+	}
+
+	if (!Component)
+	{
+		Component = NewObject<UAudioComponent>(GetWorld());
+		Component->bAutoActivate = false;
+		Component->bAutoDestroy = false;
+		Component->bAllowSpatialization = false;
+		Component->bIsUISound = false;
+		Component->SetSound(Sound);
+		Component->OnAudioFinishedNative.AddUObject(this, &UFXManagerSubsystem::OnSoundFinished);
+		Component->RegisterComponentWithWorld(GetWorld());
+		AudioComponents.Add(Component);
+		SET_DWORD_STAT(STAT_FXPooledComponents, EmitterComponents.Num() + AudioComponents.Num());
+	}
+
+	Component->Play();
+
+	ActiveCount++;
+	SoundsThisFrame++;
+	INC_DWORD_STAT(STAT_FXPlayed);
+	INC_DWORD_STAT(STAT_FXSoundsActive);
+	return true;
+}
+
+void UFXManagerSubsystem::OnEmitterFinished(UParticleSystemComponent* Component)
+{
+	if (!Component || !Component->Template) return;
+
+	if (int32* ActiveCount = ActiveCounts.Find(Component->Template))
+	{
+		*ActiveCount = FMath::Max(*ActiveCount - 1, 0);
+	}
+	FreeEmitters.FindOrAdd(Component->Template).Add(Component);
+	DEC_DWORD_STAT(STAT_FXEmittersActive);
+}
+
+void UFXManagerSubsystem::OnSoundFinished(UAudioComponent* Component)
+{
+	if (!Component || !Component->Sound) return;
+
+	if (int32* ActiveCount = ActiveCounts.Find(Component->Sound))
+	{
+		*ActiveCount = FMath::Max(*ActiveCount - 1, 0);
+	}
+	FreeSounds.FindOrAdd(Component->Sound).Add(Component);
+	DEC_DWORD_STAT(STAT_FXSoundsActive);
+}
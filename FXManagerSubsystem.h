@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FXManagerSubsystem.generated.h"
+
+/**
+ * Plays hit particles and 2D hit sounds from pooled components instead of creating a component
+ * per call. Requests are dropped when the effect already has MaxConcurrentPerEffect instances
+ * playing, when the source is farther than the cull distance from the view, or once the per-frame
+ * budget is used up. Looping particle templates and sounds are rejected, a pooled component only
+ * returns to the pool when its effect finishes.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UFXManagerSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UFXManagerSubsystem();
+
+	virtual void Deinitialize() override;
+
+	/** Returns false when the request was capped, culled, throttled or the template loops */
+	bool SpawnEmitter(class UParticleSystem* Template, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+
+	/** 2D sound, SourceLocation is only used for culling. Looping sounds are rejected */
+	bool PlaySound2D(class USoundBase* Sound, const FVector& SourceLocation);
+
+	/** Instances of one particle template or sound playing at the same time */
+	int32 MaxConcurrentPerEffect;
+
+	int32 MaxEmittersPerFrame;
+	int32 MaxSoundsPerFrame;
+
+	float EmitterCullDistance;
+	float SoundCullDistance;
+
+private:
+
+	UFUNCTION()
+	void OnEmitterFinished(class UParticleSystemComponent* Component);
+
+	void OnSoundFinished(class UAudioComponent* Component);
+
+	/** True for a looping effect, warns once per effect */
+	bool IsRejectedLooping(const UObject* Effect, bool bLooping);
+
+	/** Resets the per-frame budget and refreshes the view location once per frame */
+	void BeginFrameIfNeeded();
+
+	bool IsCulled(const FVector& Location, float CullDistance) const;
+
+	/** Keeps every pooled component alive, free or playing */
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> EmitterComponents;
+
+	UPROPERTY()
+	TArray<UAudioComponent*> AudioComponents;
+
+	TMap<UParticleSystem*, TArray<UParticleSystemComponent*>> FreeEmitters;
+	TMap<USoundBase*, TArray<UAudioComponent*>> FreeSounds;
+
+	/** Playing instances per template or sound */
+	TMap<const UObject*, int32> ActiveCounts;
+
+	/** Looping effects already warned about */
+	TSet<const UObject*> WarnedLooping;
+
+	uint64 BudgetFrame;
+	int32 EmittersThisFrame;
+	int32 SoundsThisFrame;
+
+	TArray<FVector, TInlineAllocator<2>> ViewLocations;
+};
@@ -4,3 +4,4 @@
 
 #include "CoreMinimal.h"
 
+DECLARE_STATS_GROUP(TEXT("FirstProyect2"), STATGROUP_FirstProyect2, STATCAT_Advanced);
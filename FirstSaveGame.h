@@ -32,8 +32,12 @@ struct FCharacterStats
 	UPROPERTY(VisibleAnywhere, Category = "SaveGameData")
 	FRotator Rotation;
 
+	/** Only read from saves written before WeaponId */
 	UPROPERTY(VisibleAnywhere, Category = "SaveGameData")
 	FString WeaponName;
+
+	UPROPERTY(VisibleAnywhere, Category = "SaveGameData")
+	FName WeaponId;
 };
 /**
  * 
@@ -52,6 +56,10 @@ public:
 	UPROPERTY(VisibleAnywhere, Category = "Basic")
 	uint32 UserIndex;
 
+	/** Map the game was saved on, for the slot list */
+	UPROPERTY(VisibleAnywhere, Category = "Basic")
+	FString MapName;
+
 	UPROPERTY(VisibleAnywhere, Category = "Basic")
 	FCharacterStats CharacterStats;
 };
@@ -3,7 +3,7 @@
 
 #include "FloatingPlatform.h"
 #include "Components/StaticMeshComponent.h"
-#include "TimerManager.h"
+#include "TimingWheelSubsystem.h"
 
 // Sets default values
 AFloatingPlatform::AFloatingPlatform()
@@ -32,7 +32,10 @@ void AFloatingPlatform::BeginPlay()
 	StartPoint = GetActorLocation();
 	EndPoint += StartPoint;
 
-	GetWorldTimerManager().SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, InterpTime);
+	if (UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>())
+	{
+		Timers->SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, InterpTime);
+	}
 
 	Distance = (EndPoint - StartPoint).Size();
 
@@ -55,7 +58,10 @@ void AFloatingPlatform::Tick(float DeltaTime)
 		{
 			ToggleInterping();
 
-			GetWorldTimerManager().SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, InterpTime);
+			if (UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>())
+			{
+				Timers->SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, InterpTime);
+			}
 			SwapVectors(StartPoint, EndPoint);
 		}
 	}
@@ -75,3 +81,32 @@ void AFloatingPlatform::SwapVectors(FVector& VecOne, FVector& VecTwo)
 	VecTwo = Temp;
 }
 
+void AFloatingPlatform::SerializeSaveState(FArchive& Ar)
+{
+	FVector Location = GetActorLocation();
+	FVector SavedStart = StartPoint;
+	FVector SavedEnd = EndPoint;
+	bool bSavedInterping = bInterping;
+
+	UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>();
+	float ToggleRemaining = Timers ? Timers->GetTimerRemaining(InterpTimer) : -1.f;
+	Ar << Location << SavedStart << SavedEnd << bSavedInterping << ToggleRemaining;
+
+	if (!Ar.IsLoading()) return;
+
+	SetActorLocation(Location);
+	StartPoint = SavedStart;
+	EndPoint = SavedEnd;
+	bInterping = bSavedInterping;
+	Distance = (EndPoint - StartPoint).Size();
+
+	if (!Timers) return;
+	if (ToggleRemaining >= 0.f)
+	{
+		Timers->SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, ToggleRemaining);
+	}
+	else
+	{
+		Timers->ClearTimer(InterpTimer);
+	}
+}
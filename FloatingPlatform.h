@@ -4,10 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "TimingWheel.h"
+#include "SaveableActor.h"
 #include "FloatingPlatform.generated.h"
 
 UCLASS()
-class FIRSTPROYECT2_API AFloatingPlatform : public AActor
+class FIRSTPROYECT2_API AFloatingPlatform : public AActor, public ISaveableActor
 {
 	GENERATED_BODY()
 	
@@ -31,7 +33,7 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
 	float InterpTime;
 
-	FTimerHandle InterpTimer;
+	FTimingWheelHandle InterpTimer;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
 	bool bInterping;
@@ -50,4 +52,7 @@ public:
 
 	void SwapVectors(FVector& VecOne, FVector& VecTwo);
 
+	// ISaveableActor
+	virtual void SerializeSaveState(FArchive& Ar) override;
+
 };
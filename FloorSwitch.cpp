@@ -4,7 +4,7 @@
 #include "FloorSwitch.h"
 #include "Components/BoxComponent.h"
 #include "Components/StaticMeshComponent.h"
-#include "TimerManager.h"
+#include "TimingWheelSubsystem.h"
 
 // Sets default values
 AFloorSwitch::AFloorSwitch()
@@ -64,7 +64,10 @@ void AFloorSwitch::OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor
 {
 	UE_LOG(LogTemp, Warning, TEXT("Overlap End."));
 	if (bCharacterOnSwitch) bCharacterOnSwitch = false;
-	GetWorldTimerManager().SetTimer(SwitchHandle, this, &AFloorSwitch::CloseDoor, SwitchTime);
+	if (UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>())
+	{
+		Timers->SetTimer(SwitchHandle, this, &AFloorSwitch::CloseDoor, SwitchTime);
+	}
 }
 
 void AFloorSwitch::UpdateDoorLocation(float Z)
@@ -91,3 +94,28 @@ void AFloorSwitch::CloseDoor()
 	
 }
 
+void AFloorSwitch::SerializeSaveState(FArchive& Ar)
+{
+	float DoorZ = Door->GetComponentLocation().Z - InitialDoorLocation.Z;
+	float SwitchZ = FloorSwitch->GetComponentLocation().Z - InitialSwitchLocation.Z;
+
+	UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>();
+	float CloseRemaining = Timers ? Timers->GetTimerRemaining(SwitchHandle) : -1.f;
+	Ar << DoorZ << SwitchZ << CloseRemaining;
+
+	if (!Ar.IsLoading()) return;
+
+	UpdateDoorLocation(DoorZ);
+	UpdateFloorSwitchLocation(SwitchZ);
+
+	// Standing on the switch fires the overlap again, otherwise an open door closes as it would have
+	bCharacterOnSwitch = false;
+	if (Timers && (!FMath::IsNearlyZero(DoorZ) || !FMath::IsNearlyZero(SwitchZ)))
+	{
+		Timers->SetTimer(SwitchHandle, this, &AFloorSwitch::CloseDoor, CloseRemaining >= 0.f ? CloseRemaining : SwitchTime);
+	}
+	else if (Timers)
+	{
+		Timers->ClearTimer(SwitchHandle);
+	}
+}
@@ -4,10 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "TimingWheel.h"
+#include "SaveableActor.h"
 #include "FloorSwitch.generated.h"
 
 UCLASS()
-class FIRSTPROYECT2_API AFloorSwitch : public AActor
+class FIRSTPROYECT2_API AFloorSwitch : public AActor, public ISaveableActor
 {
 	GENERATED_BODY()
 	
@@ -35,7 +37,7 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "FloorSwitch")
 	FVector InitialSwitchLocation;
 
-	FTimerHandle SwitchHandle;
+	FTimingWheelHandle SwitchHandle;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FloorSwitch")
 	float SwitchTime;
@@ -77,4 +79,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FloorSwitch")
 	void UpdateFloorSwitchLocation(float Z);
 
+	// ISaveableActor
+	virtual void SerializeSaveState(FArchive& Ar) override;
+
 };
@@ -0,0 +1,458 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlowFieldSubsystem.h"
+#include "FirstProyect2.h"
+#include "Main.h"
+#include "NavigationSystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Flow Field Build"), STAT_FlowFieldBuild, STATGROUP_FirstProyect2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Fields"), STAT_FlowFieldNum, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Flow Field Nav Projections"), STAT_FlowFieldProjections, STATGROUP_FirstProyect2);
+
+namespace FlowField
+{
+	// Orthogonal moves first, diagonals cost sqrt(2) in tenths
+	static const int32 DX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+	static const int32 DY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+	static const uint32 StepCost[8] = { 10, 10, 10, 10, 14, 14, 14, 14 };
+
+	struct FOpenNode
+	{
+		uint32 Cost;
+		int32 Index;
+
+		bool operator<(const FOpenNode& Other) const { return Cost < Other.Cost; }
+	};
+
+	static const int32 MaxCachedCells = 1 << 20;
+	static const int32 MaxFloorsPerCell = 4;
+
+	/** Vertical reach of a cell's navmesh projection */
+	static const float QueryHalfHeight = 250.f;
+
+	/** A blocked answer, and a field's walkability, only hold this close to the height they were resolved at */
+	static const float FloorTolerance = 50.f;
+
+	static const uint8 Unresolved = 2;
+}
+
+UFlowFieldSubsystem::UFlowFieldSubsystem()
+{
+	GridSize = 128;
+	CellSize = 100.f;
+	MaxProjectionsPerFrame = 2048;
+	ProjectionsThisFrame = 0;
+}
+
+void UFlowFieldSubsystem::Deinitialize()
+{
+	Fields.Reset();
+	WalkableCache.Reset();
+
+	Super::Deinitialize();
+}
+
+ETickableTickType UFlowFieldSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UFlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+FIntPoint UFlowFieldSubsystem::WorldToCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+int32 UFlowFieldSubsystem::FindField(const AMain* Player) const
+{
+	return Fields.IndexOfByPredicate([Player](const FFlowField& Field) { return Field.Player.Get() == Player; });
+}
+
+int32 UFlowFieldSubsystem::RequestField(AMain* Player)
+{
+	if (!Player) return INDEX_NONE;
+
+	int32 Index = FindField(Player);
+	if (Index == INDEX_NONE)
+	{
+		Index = Fields.AddDefaulted();
+		FFlowField& Field = Fields[Index];
+		Field.Player = Player;
+		Field.bDirty = true;
+		Field.bBuilt = false;
+	}
+	return Index;
+}
+
+void UFlowFieldSubsystem::Tick(float DeltaTime)
+{
+	ProjectionsThisFrame = 0;
+
+	for (int32 i = Fields.Num() - 1; i >= 0; i--)
+	{
+		FFlowField& Field = Fields[i];
+		AMain* Player = Field.Player.Get();
+		if (!Player)
+		{
+			Fields.RemoveAt(i);
+			continue;
+		}
+
+		if (!Field.bBuilt || WorldToCell(Player->GetActorLocation()) != Field.PlayerCell)
+		{
+			Field.bDirty = true;
+		}
+		else
+		{
+			// Same cell, only the exact spot enemies converge on changes
+			Field.PlayerLocation = Player->GetActorLocation();
+		}
+
+		if (Field.bDirty)
+		{
+			BuildField(Field, false);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_FlowFieldNum, Fields.Num());
+}
+
+bool UFlowFieldSubsystem::ResolveWalkable(UNavigationSystemV1* NavSys, const FIntPoint& Cell, float FloorZ, bool& bOutWalkable, bool bIgnoreBudget)
+{
+	TArray<FCachedFloor, TInlineAllocator<2>>* Floors = WalkableCache.Find(Cell);
+	if (Floors)
+	{
+		const FCachedFloor* Closest = nullptr;
+		for (const FCachedFloor& Floor : *Floors)
+		{
+			const float Distance = FMath::Abs(Floor.Z - FloorZ);
+			if (Distance <= (Floor.bWalkable ? FlowField::QueryHalfHeight : FlowField::FloorTolerance)
+				&& (!Closest || Distance < FMath::Abs(Closest->Z - FloorZ)))
+			{
+				Closest = &Floor;
+			}
+		}
+		if (Closest)
+		{
+			bOutWalkable = Closest->bWalkable;
+			return true;
+		}
+	}
+
+	if (!NavSys)
+	{
+		bOutWalkable = true;
+		return true;
+	}
+
+	if (!bIgnoreBudget && ProjectionsThisFrame >= MaxProjectionsPerFrame)
+	{
+		return false;
+	}
+	ProjectionsThisFrame++;
+	INC_DWORD_STAT(STAT_FlowFieldProjections);
+
+	const FVector Center((Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize, FloorZ);
+	FNavLocation Projected;
+	bOutWalkable = NavSys->ProjectPointToNavigation(Center, Projected, FVector(CellSize * 0.5f, CellSize * 0.5f, FlowField::QueryHalfHeight));
+
+	if (WalkableCache.Num() >= FlowField::MaxCachedCells)
+	{
+		WalkableCache.Reset();
+		Floors = nullptr;
+	}
+	if (!Floors)
+	{
+		Floors = &WalkableCache.Add(Cell);
+	}
+	if (Floors->Num() >= FlowField::MaxFloorsPerCell)
+	{
+		Floors->RemoveAt(0, 1, false);
+	}
+	Floors->Add({ bOutWalkable ? Projected.Location.Z : FloorZ, bOutWalkable });
+
+	return true;
+}
+
+void UFlowFieldSubsystem::BuildField(FFlowField& Field, bool bIgnoreBudget)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowFieldBuild);
+
+	AMain* Player = Field.Player.Get();
+	if (!Player) return;
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	Field.PlayerLocation = Player->GetActorLocation();
+	const FIntPoint PlayerCell = WorldToCell(Field.PlayerLocation);
+	const FIntPoint MinCell = PlayerCell - FIntPoint(GridSize / 2, GridSize / 2);
+	const int32 NumCells = GridSize * GridSize;
+
+	float FloorZ = Player->GetNavAgentLocation().Z;
+	FNavLocation Floor;
+	if (NavSys && NavSys->ProjectPointToNavigation(Player->GetNavAgentLocation(), Floor, FVector(CellSize * 0.5f, CellSize * 0.5f, FlowField::QueryHalfHeight)))
+	{
+		FloorZ = Floor.Location.Z;
+	}
+
+	const bool bMoved = !Field.bBuilt || PlayerCell != Field.PlayerCell;
+
+	// Another floor needs every cell answered again, otherwise the known cells move along with the grid
+	if (Field.Walkable.Num() != NumCells || FMath::Abs(FloorZ - Field.FloorZ) > FlowField::FloorTolerance)
+	{
+		Field.Walkable.Init(FlowField::Unresolved, NumCells);
+		Field.FloorZ = FloorZ;
+	}
+	else if (MinCell != Field.MinCell)
+	{
+		const FIntPoint Offset = MinCell - Field.MinCell;
+		TArray<uint8> Shifted;
+		Shifted.Init(FlowField::Unresolved, NumCells);
+		for (int32 Y = 0; Y < GridSize; Y++)
+		{
+			const int32 SourceY = Y + Offset.Y;
+			if (SourceY < 0 || SourceY >= GridSize) continue;
+
+			for (int32 X = 0; X < GridSize; X++)
+			{
+				const int32 SourceX = X + Offset.X;
+				if (SourceX >= 0 && SourceX < GridSize)
+				{
+					Shifted[Y * GridSize + X] = Field.Walkable[SourceY * GridSize + SourceX];
+				}
+			}
+		}
+		Field.Walkable = MoveTemp(Shifted);
+	}
+
+	Field.MinCell = MinCell;
+	Field.PlayerCell = PlayerCell;
+
+	// Unknown cells already count as walkable, so only one that turns out blocked changes the routing
+	bool bNewlyBlocked = false;
+	int32 NumUnresolved = 0;
+	for (int32 Index = 0; Index < NumCells; Index++)
+	{
+		if (Field.Walkable[Index] != FlowField::Unresolved) continue;
+
+		bool bWalkable = true;
+		if (!ResolveWalkable(NavSys, MinCell + FIntPoint(Index % GridSize, Index / GridSize), Field.FloorZ, bWalkable, bIgnoreBudget))
+		{
+			NumUnresolved++;
+			continue;
+		}
+		Field.Walkable[Index] = bWalkable ? 1 : 0;
+		bNewlyBlocked |= !bWalkable;
+	}
+
+	// Moving the player changes the cost of nearly every cell, so that is a full route rather than a repair
+	if (bMoved || bNewlyBlocked)
+	{
+		RouteField(Field);
+	}
+
+	Field.bBuilt = true;
+	Field.bDirty = NumUnresolved > 0;
+}
+
+void UFlowFieldSubsystem::RouteField(FFlowField& Field) const
+{
+	const int32 NumCells = GridSize * GridSize;
+	const int32 StartIndex = (GridSize / 2) * GridSize + (GridSize / 2);
+	const TArray<uint8>& Walkable = Field.Walkable;
+
+	// The player's own cell is always open, even where the navmesh leaves a gap
+	auto IsOpen = [&](int32 X, int32 Y)
+	{
+		if (X < 0 || Y < 0 || X >= GridSize || Y >= GridSize) return false;
+		const int32 Index = Y * GridSize + X;
+		return Index == StartIndex || Walkable[Index] != 0;
+	};
+
+	// Dijkstra outwards from the player
+	Field.Costs.Init(MAX_uint32, NumCells);
+	Field.Costs[StartIndex] = 0;
+
+	TArray<FlowField::FOpenNode> Open;
+	Open.HeapPush({ 0, StartIndex });
+
+	while (Open.Num() > 0)
+	{
+		FlowField::FOpenNode Node;
+		Open.HeapPop(Node, false);
+		if (Node.Cost > Field.Costs[Node.Index]) continue;
+
+		const int32 X = Node.Index % GridSize;
+		const int32 Y = Node.Index / GridSize;
+
+		for (int32 k = 0; k < 8; k++)
+		{
+			const int32 NX = X + FlowField::DX[k];
+			const int32 NY = Y + FlowField::DY[k];
+			if (!IsOpen(NX, NY)) continue;
+
+			// No corner cutting
+			if (k >= 4 && (!IsOpen(NX, Y) || !IsOpen(X, NY))) continue;
+
+			const int32 NeighbourIndex = NY * GridSize + NX;
+			const uint32 NewCost = Node.Cost + FlowField::StepCost[k];
+			if (NewCost < Field.Costs[NeighbourIndex])
+			{
+				Field.Costs[NeighbourIndex] = NewCost;
+				Open.HeapPush({ NewCost, NeighbourIndex });
+			}
+		}
+	}
+
+	// Each cell points at its cheapest neighbour
+	Field.Directions.Init(FVector2D::ZeroVector, NumCells);
+	for (int32 Y = 0; Y < GridSize; Y++)
+	{
+		for (int32 X = 0; X < GridSize; X++)
+		{
+			const int32 Index = Y * GridSize + X;
+			uint32 BestCost = Field.Costs[Index];
+			if (BestCost == MAX_uint32 || BestCost == 0) continue;
+
+			int32 Best = INDEX_NONE;
+			for (int32 k = 0; k < 8; k++)
+			{
+				const int32 NX = X + FlowField::DX[k];
+				const int32 NY = Y + FlowField::DY[k];
+				if (!IsOpen(NX, NY)) continue;
+				if (k >= 4 && (!IsOpen(NX, Y) || !IsOpen(X, NY))) continue;
+
+				const uint32 NeighbourCost = Field.Costs[NY * GridSize + NX];
+				if (NeighbourCost < BestCost)
+				{
+					BestCost = NeighbourCost;
+					Best = k;
+				}
+			}
+
+			if (Best != INDEX_NONE)
+			{
+				Field.Directions[Index] = FVector2D(FlowField::DX[Best], FlowField::DY[Best]).GetSafeNormal();
+			}
+		}
+	}
+}
+
+bool UFlowFieldSubsystem::SampleDirection(int32 FieldIndex, const FVector& Location, FVector& OutDirection) const
+{
+	return Fields.IsValidIndex(FieldIndex) && SampleField(Fields[FieldIndex], Location, OutDirection);
+}
+
+bool UFlowFieldSubsystem::SampleField(const FFlowField& Field, const FVector& Location, FVector& OutDirection) const
+{
+	if (!Field.bBuilt) return false;
+
+	const FIntPoint Cell = WorldToCell(Location) - Field.MinCell;
+	const bool bInGrid = Cell.X >= 0 && Cell.Y >= 0 && Cell.X < GridSize && Cell.Y < GridSize;
+	const int32 Index = Cell.Y * GridSize + Cell.X;
+
+	// Outside the field, in the player's cell, or on a cell the field cannot route from: head straight for the player
+	if (!bInGrid || Field.Directions[Index].IsNearlyZero())
+	{
+		OutDirection = (Field.PlayerLocation - Location).GetSafeNormal2D();
+		return !OutDirection.IsNearlyZero();
+	}
+
+	OutDirection = FVector(Field.Directions[Index], 0.f);
+	return true;
+}
+
+/**
+ * FirstProyect2.FlowFieldBench [Agents...]
+ * For each agent count (default 100 1000 5000) compares one re-path wave of the MoveToTarget path
+ * (a FindPathSync per enemy) against rebuilding the flow field once and sampling it per enemy.
+ */
+static void RunFlowFieldBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	UFlowFieldSubsystem* FlowFields = World ? World->GetSubsystem<UFlowFieldSubsystem>() : nullptr;
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	AMain* Main = PlayerController ? Cast<AMain>(PlayerController->GetPawn()) : nullptr;
+	if (!FlowFields || !NavSys || !Main || !NavSys->GetDefaultNavDataInstance())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FlowFieldBench needs a navmesh and a possessed AMain"));
+		return;
+	}
+
+	TArray<int32> AgentCounts;
+	for (const FString& Arg : Args)
+	{
+		AgentCounts.Add(FMath::Max(FCString::Atoi(*Arg), 1));
+	}
+	if (AgentCounts.Num() == 0)
+	{
+		AgentCounts = { 100, 1000, 5000 };
+	}
+
+	const FVector Goal = Main->GetActorLocation();
+	const float Radius = FlowFields->GridSize * FlowFields->CellSize * 0.45f;
+	ANavigationData* NavData = NavSys->GetDefaultNavDataInstance();
+
+	FFlowField Field;
+	Field.Player = Main;
+
+	for (int32 NumAgents : AgentCounts)
+	{
+		TArray<FVector> Starts;
+		Starts.Reserve(NumAgents);
+		for (int32 i = 0; i < NumAgents; i++)
+		{
+			FNavLocation Point;
+			if (NavSys->GetRandomReachablePointInRadius(Goal, Radius, Point))
+			{
+				Starts.Add(Point.Location);
+			}
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		int32 PathsFound = 0;
+		for (const FVector& Start : Starts)
+		{
+			FPathFindingQuery Query(Main, *NavData, Start, Goal);
+			if (NavSys->FindPathSync(Query).IsSuccessful()) PathsFound++;
+		}
+		const double AStarTime = FPlatformTime::Seconds() - StartTime;
+
+		Field.Walkable.Reset();
+		Field.bBuilt = false;
+		StartTime = FPlatformTime::Seconds();
+		FlowFields->BuildField(Field, true);
+		const double BuildTime = FPlatformTime::Seconds() - StartTime;
+
+		// Route again on the walkability the field kept, which is what the player crossing into another cell costs
+		Field.bBuilt = false;
+		StartTime = FPlatformTime::Seconds();
+		FlowFields->BuildField(Field, true);
+		const double WarmBuildTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		int32 Sampled = 0;
+		for (const FVector& Start : Starts)
+		{
+			FVector Direction;
+			if (FlowFields->SampleField(Field, Start, Direction)) Sampled++;
+		}
+		const double SampleTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogTemp, Display, TEXT("FlowFieldBench %5d agents: A* %8.3f ms (%d paths) | field build %7.3f ms cold, %7.3f ms warm | sampling %7.3f ms (%d dirs)"),
+			Starts.Num(), AStarTime * 1000.0, PathsFound, BuildTime * 1000.0, WarmBuildTime * 1000.0, SampleTime * 1000.0, Sampled);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs FlowFieldBenchCommand(
+	TEXT("FirstProyect2.FlowFieldBench"),
+	TEXT("Compares per-enemy pathfinding against the player flow field. Args: [AgentCount...] (default 100 1000 5000)"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunFlowFieldBenchmark));
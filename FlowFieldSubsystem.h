@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "FlowFieldSubsystem.generated.h"
+
+/** Integration field over a square grid centred on one player */
+struct FFlowField
+{
+	TWeakObjectPtr<class AMain> Player;
+
+	/** World cell of grid index (0, 0) */
+	FIntPoint MinCell = FIntPoint::ZeroValue;
+
+	FIntPoint PlayerCell = FIntPoint::ZeroValue;
+	FVector PlayerLocation = FVector::ZeroVector;
+
+	/** Navmesh floor height under the player that Walkable was resolved for */
+	float FloorZ = 0.f;
+
+	/** 1 walkable, 0 blocked, 2 not projected yet and walkable until it is; moves along with MinCell */
+	TArray<uint8> Walkable;
+
+	/** Cost to reach the player from each cell, MAX_uint32 when unreachable */
+	TArray<uint32> Costs;
+
+	/** Unit XY direction to walk from each cell */
+	TArray<FVector2D> Directions;
+
+	bool bDirty = true;
+	bool bBuilt = false;
+};
+
+/**
+ * Builds one flow field per chased player so a horde can walk towards it by sampling a
+ * direction instead of each enemy running its own pathfinding query. Walkability comes from
+ * the navmesh, cached per world cell and floor height. A field keeps its walkability while it
+ * follows the player, so crossing into the next cell only resolves the newly exposed edge.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UFlowFieldSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UFlowFieldSubsystem();
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return Fields.Num() > 0; }
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** Makes sure a field is maintained for Player and returns its index */
+	int32 RequestField(AMain* Player);
+
+	/** INDEX_NONE when no field tracks Player */
+	int32 FindField(const AMain* Player) const;
+
+	/**
+	 * Direction to walk from Location towards the field's player. Only reads field data, so it is
+	 * safe to call from worker threads between ticks of this subsystem.
+	 */
+	bool SampleDirection(int32 FieldIndex, const FVector& Location, FVector& OutDirection) const;
+
+	bool SampleField(const FFlowField& Field, const FVector& Location, FVector& OutDirection) const;
+
+	/** Cells per side of every field */
+	int32 GridSize;
+
+	/** Edge of a cell in cm */
+	float CellSize;
+
+	/** Navmesh projections allowed per frame while discovering new cells */
+	int32 MaxProjectionsPerFrame;
+
+	/**
+	 * Recentres the field on its player and resolves the cells it has not seen yet. Costs and
+	 * directions are routed again only when the player's cell changed or a cell turned out blocked.
+	 */
+	void BuildField(FFlowField& Field, bool bIgnoreBudget);
+
+private:
+
+	struct FCachedFloor
+	{
+		/** Projected floor height when walkable, the height it was queried from when blocked */
+		float Z;
+		bool bWalkable;
+	};
+
+	FIntPoint WorldToCell(const FVector& Location) const;
+
+	/** Returns false while the cell has not been projected yet (and the budget is spent) */
+	bool ResolveWalkable(class UNavigationSystemV1* NavSys, const FIntPoint& Cell, float FloorZ, bool& bOutWalkable, bool bIgnoreBudget);
+
+	/** Dijkstra outwards from the player over Field.Walkable, then points each cell at its cheapest neighbour */
+	void RouteField(FFlowField& Field) const;
+
+	TArray<FFlowField> Fields;
+
+	/** Every floor seen per world cell, so stacked floors and bridges get their own answers */
+	TMap<FIntPoint, TArray<FCachedFloor, TInlineAllocator<2>>> WalkableCache;
+
+	int32 ProjectionsThisFrame;
+};
@@ -0,0 +1,316 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InputRecorderSubsystem.h"
+#include "FirstProyect2.h"
+#include "Main.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace InputRecorder
+{
+	/** "FPIR" */
+	static const uint32 FileMagic = 0x52495046;
+	static const int32 FileVersion = 1;
+
+	/** DeltaTime, axis mask and action count of a frame with no axes or actions */
+	static const int64 MinFrameBytes = sizeof(float) + sizeof(uint8) + sizeof(uint8);
+}
+
+void UInputRecorderSubsystem::FInputFrame::Serialize(FArchive& Ar)
+{
+	Ar << DeltaTime;
+
+	uint8 AxisMask = 0;
+	if (Ar.IsSaving())
+	{
+		for (int32 Axis = 0; Axis < (int32)EInputRecordAxis::Num; Axis++)
+		{
+			AxisMask |= Axes[Axis] != 0.f ? (1 << Axis) : 0;
+		}
+	}
+	Ar << AxisMask;
+
+	for (int32 Axis = 0; Axis < (int32)EInputRecordAxis::Num; Axis++)
+	{
+		if (AxisMask & (1 << Axis))
+		{
+			Ar << Axes[Axis];
+		}
+		else if (Ar.IsLoading())
+		{
+			Axes[Axis] = 0.f;
+		}
+	}
+
+	uint8 NumActions = (uint8)FMath::Min(Actions.Num(), 255);
+	Ar << NumActions;
+
+	// Saving writes the first 255 actions and leaves the live frame untouched
+	if (Ar.IsLoading())
+	{
+		Actions.SetNum(NumActions);
+	}
+	for (int32 Index = 0; Index < NumActions; Index++)
+	{
+		Ar << Actions[Index];
+	}
+}
+
+UInputRecorderSubsystem::UInputRecorderSubsystem()
+{
+	bRecording = false;
+	bReplaying = false;
+	bSessionStarted = false;
+	bExitAfterReplay = false;
+
+	Seed = 0;
+	CurrentFrame = 0;
+	LastFrameTime = 0.0;
+}
+
+void UInputRecorderSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (IsTemplate()) return;
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FString File;
+	if (FParse::Value(CommandLine, TEXT("-InputReplay="), File))
+	{
+		FilePath = ResolvePath(File);
+		bReplaying = LoadRecording();
+		bExitAfterReplay = FParse::Param(CommandLine, TEXT("InputReplayExit"));
+		if (!bReplaying)
+		{
+			UE_LOG(LogTemp, Error, TEXT("InputRecorder: could not read %s"), *FilePath);
+		}
+	}
+	else if (FParse::Value(CommandLine, TEXT("-InputRecord="), File))
+	{
+		FilePath = ResolvePath(File);
+		bRecording = true;
+		if (!FParse::Value(CommandLine, TEXT("-RandomSeed="), Seed))
+		{
+			Seed = (int32)(FPlatformTime::Cycles() & 0x7fffffff);
+		}
+	}
+}
+
+void UInputRecorderSubsystem::Deinitialize()
+{
+	if (bRecording)
+	{
+		StopRecording();
+	}
+	if (bReplaying)
+	{
+		FinishReplay();
+	}
+
+	Super::Deinitialize();
+}
+
+ETickableTickType UInputRecorderSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UInputRecorderSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInputRecorderSubsystem, STATGROUP_Tickables);
+}
+
+FString UInputRecorderSubsystem::ResolvePath(const FString& File)
+{
+	return FPaths::IsRelative(File) ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("InputRecordings"), File) : File;
+}
+
+void UInputRecorderSubsystem::BindPlayer(AMain* Main)
+{
+	Player = Main;
+
+	if (bSessionStarted || !(bRecording || bReplaying)) return;
+	bSessionStarted = true;
+
+	// Gameplay draws from URandomStreamSubsystem streams seeded from Seed, engine code may still use the global RNG
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+
+	CurrentFrame = 0;
+	LastFrameTime = FPlatformTime::Seconds();
+
+	if (bReplaying)
+	{
+		FApp::SetUseFixedTimeStep(true);
+		if (Frames.Num() > 0)
+		{
+			FApp::SetFixedDeltaTime(Frames[0].DeltaTime);
+		}
+		CsvLines.Reset(Frames.Num() + 1);
+		CsvLines.Add(TEXT("Frame,DeltaTimeMs,FrameMs,GameThreadMs,RenderThreadMs"));
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("InputRecorder: %s %s, seed %d"), bReplaying ? TEXT("replaying") : TEXT("recording"), *FilePath, Seed);
+}
+
+float UInputRecorderSubsystem::ProcessAxis(EInputRecordAxis Axis, float Value)
+{
+	if (!bSessionStarted) return Value;
+
+	if (bReplaying)
+	{
+		return Frames.IsValidIndex(CurrentFrame) ? Frames[CurrentFrame].Axes[(int32)Axis] : 0.f;
+	}
+	if (bRecording)
+	{
+		RecordingFrame.Axes[(int32)Axis] = Value;
+	}
+	return Value;
+}
+
+void UInputRecorderSubsystem::RecordAction(EInputRecordAction Action, bool bPressed)
+{
+	if (!bSessionStarted || !bRecording) return;
+
+	RecordingFrame.Actions.Add(((uint8)Action << 1) | (bPressed ? 1 : 0));
+}
+
+void UInputRecorderSubsystem::DispatchReplayActions()
+{
+	if (!bSessionStarted || !bReplaying || !Frames.IsValidIndex(CurrentFrame)) return;
+
+	AMain* Main = Player.Get();
+	if (!Main) return;
+
+	for (const uint8 Action : Frames[CurrentFrame].Actions)
+	{
+		Main->ReplayInputAction((EInputRecordAction)(Action >> 1), (Action & 1) != 0);
+	}
+}
+
+void UInputRecorderSubsystem::Tick(float DeltaTime)
+{
+	if (bRecording)
+	{
+		RecordingFrame.DeltaTime = FApp::GetDeltaTime();
+		Frames.Add(RecordingFrame);
+		RecordingFrame = FInputFrame();
+		CurrentFrame++;
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	CsvLines.Add(FString::Printf(TEXT("%d,%.3f,%.3f,%.3f,%.3f"), CurrentFrame, FApp::GetDeltaTime() * 1000.0, (Now - LastFrameTime) * 1000.0,
+		FPlatformTime::ToMilliseconds(GGameThreadTime), FPlatformTime::ToMilliseconds(GRenderThreadTime)));
+	LastFrameTime = Now;
+
+	CurrentFrame++;
+	if (CurrentFrame >= Frames.Num())
+	{
+		FinishReplay();
+		return;
+	}
+
+	// The next engine frame advances by exactly the recorded delta
+	FApp::SetFixedDeltaTime(Frames[CurrentFrame].DeltaTime);
+}
+
+void UInputRecorderSubsystem::StopRecording()
+{
+	if (!bRecording) return;
+	bRecording = false;
+
+	if (SaveRecording())
+	{
+		UE_LOG(LogTemp, Display, TEXT("InputRecorder: wrote %d frames to %s"), Frames.Num(), *FilePath);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("InputRecorder: could not write %s"), *FilePath);
+	}
+}
+
+void UInputRecorderSubsystem::FinishReplay()
+{
+	if (!bReplaying) return;
+	bReplaying = false;
+
+	FApp::SetUseFixedTimeStep(false);
+
+	const FString CsvPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("InputReplay"),
+		FString::Printf(TEXT("%s-%s.csv"), *FPaths::GetBaseFilename(FilePath), *FDateTime::Now().ToString()));
+	if (bSessionStarted && FFileHelper::SaveStringArrayToFile(CsvLines, *CsvPath))
+	{
+		UE_LOG(LogTemp, Display, TEXT("InputRecorder: replayed %d of %d frames, frame times in %s"), FMath::Min(CurrentFrame, Frames.Num()), Frames.Num(), *CsvPath);
+	}
+
+	if (bExitAfterReplay)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+bool UInputRecorderSubsystem::SaveRecording()
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = InputRecorder::FileMagic;
+	int32 Version = InputRecorder::FileVersion;
+	int32 SavedSeed = Seed;
+	int32 NumFrames = Frames.Num();
+	Writer << Magic << Version << SavedSeed << NumFrames;
+
+	for (FInputFrame& Frame : Frames)
+	{
+		Frame.Serialize(Writer);
+	}
+
+	return FFileHelper::SaveArrayToFile(Bytes, *FilePath);
+}
+
+bool UInputRecorderSubsystem::LoadRecording()
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *FilePath)) return false;
+
+	FMemoryReader Reader(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 NumFrames = 0;
+	Reader << Magic << Version << Seed << NumFrames;
+	if (Magic != InputRecorder::FileMagic || Version != InputRecorder::FileVersion || NumFrames < 0) return false;
+
+	// A truncated or corrupt file must not size the allocation, every frame takes at least MinFrameBytes
+	if (NumFrames > (Reader.TotalSize() - Reader.Tell()) / InputRecorder::MinFrameBytes) return false;
+
+	Frames.SetNum(NumFrames);
+	for (FInputFrame& Frame : Frames)
+	{
+		Frame.Serialize(Reader);
+	}
+
+	return !Reader.IsError();
+}
+
+static FAutoConsoleCommandWithWorld InputRecordStopCommand(
+	TEXT("FirstProyect2.InputRecordStop"),
+	TEXT("Writes the input recording started with -InputRecord and stops recording"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		if (UInputRecorderSubsystem* Recorder = GameInstance ? GameInstance->GetSubsystem<UInputRecorderSubsystem>() : nullptr)
+		{
+			Recorder->StopRecording();
+		}
+	}));
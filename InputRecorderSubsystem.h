@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "InputRecorderSubsystem.generated.h"
+
+/** Axis bindings of AMain, in file order */
+enum class EInputRecordAxis : uint8
+{
+	MoveForward,
+	MoveRight,
+	Turn,
+	LookUp,
+	TurnRate,
+	LookUpRate,
+
+	Num
+};
+
+/** Action bindings of AMain, in file order */
+enum class EInputRecordAction : uint8
+{
+	Jump,
+	Sprint,
+	LMB,
+	ESC,
+
+	Num
+};
+
+/**
+ * Records the axis values and action events AMain receives every frame, with the frame's delta
+ * time and the session seed of URandomStreamSubsystem, into a small binary file, and plays such a
+ * file back into AMain.
+ *
+ * -InputRecord=<File>   records from the first AMain BeginPlay until the game instance shuts down
+ *                       or FirstProyect2.InputRecordStop; -RandomSeed=<N> picks the seed
+ * -InputReplay=<File>   drives AMain from the file with the recorded seed and delta times and
+ *                       writes a per-frame CSV to Saved/Profiling/InputReplay
+ * -InputReplayExit      quits once the replay ends, for unattended runs with -nullrhi
+ *
+ * Relative file names resolve against Saved/InputRecordings.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UInputRecorderSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UInputRecorderSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return bSessionStarted && (bRecording || bReplaying); }
+	virtual bool IsTickableWhenPaused() const override { return true; }
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Called from AMain::BeginPlay, the first call starts the session and seeds the RNG */
+	void BindPlayer(class AMain* Main);
+
+	/** Records Value, or returns the recorded value while replaying */
+	float ProcessAxis(EInputRecordAxis Axis, float Value);
+
+	void RecordAction(EInputRecordAction Action, bool bPressed);
+
+	/** Called by AMainPlayerController before input is processed, replays this frame's actions */
+	void DispatchReplayActions();
+
+	/** Writes the recording so far and stops recording */
+	void StopRecording();
+
+	FORCEINLINE bool IsRecording() const { return bRecording; }
+	FORCEINLINE bool IsReplaying() const { return bReplaying; }
+
+	FORCEINLINE int32 GetSeed() const { return Seed; }
+
+private:
+
+	struct FInputFrame
+	{
+		float DeltaTime = 0.f;
+		float Axes[(int32)EInputRecordAxis::Num] = {};
+
+		/** (Action << 1) | bPressed, in the order they happened */
+		TArray<uint8, TInlineAllocator<4>> Actions;
+
+		/** Only non-zero axes are stored, behind a bit mask */
+		void Serialize(FArchive& Ar);
+	};
+
+	bool SaveRecording();
+	bool LoadRecording();
+
+	void FinishReplay();
+
+	static FString ResolvePath(const FString& File);
+
+	bool bRecording;
+	bool bReplaying;
+	bool bSessionStarted;
+	bool bExitAfterReplay;
+
+	FString FilePath;
+	int32 Seed;
+
+	TWeakObjectPtr<AMain> Player;
+
+	TArray<FInputFrame> Frames;
+
+	/** Frame being recorded or replayed */
+	int32 CurrentFrame;
+	FInputFrame RecordingFrame;
+
+	/** Replay frame times, one CSV line per frame */
+	TArray<FString> CsvLines;
+	double LastFrameTime;
+};
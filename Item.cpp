@@ -65,3 +65,13 @@ void AItem::OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* Other
 	
 }
 
+void AItem::OnAcquiredFromPool_Implementation()
+{
+	bRotate = GetClass()->GetDefaultObject<AItem>()->bRotate;
+	IdleParticlesComponent->Activate(true);
+}
+
+void AItem::OnReleasedToPool_Implementation()
+{
+	IdleParticlesComponent->Deactivate();
+}
@@ -4,10 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Poolable.h"
 #include "Item.generated.h"
 
 UCLASS()
-class FIRSTPROYECT2_API AItem : public AActor
+class FIRSTPROYECT2_API AItem : public AActor, public IPoolable
 {
 	GENERATED_BODY()
 	
@@ -52,4 +53,8 @@ public:
 	UFUNCTION()
 	virtual void OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 
+	// IPoolable
+	virtual void OnAcquiredFromPool_Implementation() override;
+	virtual void OnReleasedToPool_Implementation() override;
+
 };
@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LevelPrefetchSubsystem.h"
+#include "FirstProyect2.h"
+#include "Engine/World.h"
+#include "Engine/LevelStreaming.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Level Prefetches"), STAT_LevelPrefetches, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Level Prefetch Hits"), STAT_LevelPrefetchHits, STATGROUP_FirstProyect2);
+
+ULevelPrefetchSubsystem::ULevelPrefetchSubsystem()
+{
+	TransitionStartTime = 0.0;
+}
+
+void ULevelPrefetchSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &ULevelPrefetchSubsystem::OnPostLoadMap);
+}
+
+void ULevelPrefetchSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	Prefetches.Reset();
+	LoadedWorlds.Reset();
+
+	Super::Deinitialize();
+}
+
+FName ULevelPrefetchSubsystem::ResolvePackageName(FName LevelName)
+{
+	const FString Name = LevelName.ToString();
+	if (!FPackageName::IsShortPackageName(Name)) return LevelName;
+
+	// OpenLevel takes short names too, they are searched for among the content on disk
+	FString LongPackageName;
+	return FPackageName::SearchForPackageOnDisk(Name + FPackageName::GetMapPackageExtension(), &LongPackageName) ? FName(*LongPackageName) : NAME_None;
+}
+
+void ULevelPrefetchSubsystem::Prefetch(FName LevelName, bool bIncludeStreamingLevels)
+{
+	if (LevelName.IsNone() || Prefetches.Contains(LevelName)) return;
+
+	const FName PackageName = ResolvePackageName(LevelName);
+	if (PackageName.IsNone())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("LevelPrefetch: no map named %s"), *LevelName.ToString());
+		return;
+	}
+
+	FPrefetch& Entry = Prefetches.Add(LevelName);
+	Entry.PackageName = PackageName;
+	Entry.bIncludeStreamingLevels = bIncludeStreamingLevels;
+	Entry.StartTime = FPlatformTime::Seconds();
+	INC_DWORD_STAT(STAT_LevelPrefetches);
+
+	UE_LOG(LogTemp, Verbose, TEXT("LevelPrefetch: loading %s"), *PackageName.ToString());
+	LoadPackageAsync(PackageName.ToString(), FLoadPackageAsyncDelegate::CreateUObject(this, &ULevelPrefetchSubsystem::OnPackageLoaded, LevelName));
+}
+
+UWorld* ULevelPrefetchSubsystem::HoldWorld(UPackage* Package)
+{
+	// Same as UEngine::PrepareMapChange, the world is what LoadMap looks for in the package
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (World)
+	{
+		LoadedWorlds.AddUnique(World);
+	}
+	return World;
+}
+
+void ULevelPrefetchSubsystem::OnPackageLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result, FName LevelName)
+{
+	FPrefetch* Entry = Prefetches.Find(LevelName);
+	if (!Entry) return;
+
+	UWorld* World = Result == EAsyncLoadingResult::Succeeded ? HoldWorld(Package) : nullptr;
+	if (!World)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("LevelPrefetch: could not load %s"), *PackageName.ToString());
+		Prefetches.Remove(LevelName);
+		return;
+	}
+
+	Entry->MapWorld = World;
+	Entry->Packages.Add(PackageName);
+
+	if (Entry->bIncludeStreamingLevels)
+	{
+		for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels())
+		{
+			const FName SublevelPackage = StreamingLevel ? StreamingLevel->GetWorldAssetPackageFName() : NAME_None;
+			if (SublevelPackage.IsNone()) continue;
+
+			Entry->NumStreamingLevelsLoading++;
+			LoadPackageAsync(SublevelPackage.ToString(), FLoadPackageAsyncDelegate::CreateUObject(this, &ULevelPrefetchSubsystem::OnStreamingLevelLoaded, LevelName));
+		}
+	}
+
+	if (Entry->NumStreamingLevelsLoading == 0)
+	{
+		Entry->bLoaded = true;
+		Entry->ReadyTime = FPlatformTime::Seconds();
+	}
+}
+
+void ULevelPrefetchSubsystem::OnStreamingLevelLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result, FName LevelName)
+{
+	FPrefetch* Entry = Prefetches.Find(LevelName);
+	if (!Entry) return;
+
+	// A sublevel that failed is streamed in by the new map as usual
+	if (Result == EAsyncLoadingResult::Succeeded && HoldWorld(Package))
+	{
+		Entry->Packages.Add(PackageName);
+	}
+
+	if (--Entry->NumStreamingLevelsLoading == 0)
+	{
+		Entry->bLoaded = true;
+		Entry->ReadyTime = FPlatformTime::Seconds();
+	}
+}
+
+void ULevelPrefetchSubsystem::CancelPrefetch(FName LevelName)
+{
+	FPrefetch Entry;
+	if (!Prefetches.RemoveAndCopyValue(LevelName, Entry)) return;
+
+	LoadedWorlds.RemoveAll([&Entry](const UWorld* World) { return !World || Entry.Packages.Contains(World->GetOutermost()->GetFName()); });
+}
+
+bool ULevelPrefetchSubsystem::IsPrefetched(FName LevelName) const
+{
+	const FPrefetch* Entry = Prefetches.Find(LevelName);
+	return Entry && Entry->bLoaded;
+}
+
+void ULevelPrefetchSubsystem::BeginTransition(FName LevelName)
+{
+	TransitionLevel = LevelName;
+	TransitionStartTime = FPlatformTime::Seconds();
+
+	const FPrefetch* Entry = Prefetches.Find(LevelName);
+	TransitionPrefetchState = !Entry ? TEXT("not prefetched") : Entry->bLoaded ? TEXT("prefetched") : TEXT("prefetch still loading");
+}
+
+void ULevelPrefetchSubsystem::OnPostLoadMap(UWorld* World)
+{
+	if (!World || World->GetGameInstance() != GetGameInstance()) return;
+
+	// Only a travel into the held world is a hit, otherwise LoadMap went to the disk after all
+	const FPrefetch* Entry = Prefetches.Find(TransitionLevel);
+	if (Entry && Entry->bLoaded && Entry->MapWorld.Get() == World)
+	{
+		INC_DWORD_STAT(STAT_LevelPrefetchHits);
+		UE_LOG(LogTemp, Display, TEXT("LevelPrefetch: %s and %d sublevels reused, ready after %.3f ms"),
+			*TransitionLevel.ToString(), Entry->Packages.Num() - 1, (Entry->ReadyTime - Entry->StartTime) * 1000.0);
+	}
+	else if (Entry)
+	{
+		TransitionPrefetchState = Entry->bLoaded ? TEXT("prefetched world not reused") : TransitionPrefetchState;
+	}
+
+	// The new world holds its levels now
+	Prefetches.Reset();
+	LoadedWorlds.Reset();
+
+	if (TransitionLevel.IsNone()) return;
+
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ULevelPrefetchSubsystem::OnWorldPostActorTick);
+}
+
+void ULevelPrefetchSubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (!World || World->GetGameInstance() != GetGameInstance() || TickType == LEVELTICK_TimeOnly) return;
+
+	UE_LOG(LogTemp, Display, TEXT("LevelPrefetch: %s, %.3f ms from transition to first interactive frame (%s)"),
+		*TransitionLevel.ToString(), (FPlatformTime::Seconds() - TransitionStartTime) * 1000.0, *TransitionPrefetchState);
+
+	TransitionLevel = NAME_None;
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	PostActorTickHandle.Reset();
+}
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "UObject/UObjectGlobals.h"
+#include "LevelPrefetchSubsystem.generated.h"
+
+/**
+ * Loads the packages of maps the player is about to travel to in the background and keeps their
+ * worlds in memory across the map change, so OpenLevel finds them loaded instead of blocking on the
+ * disk. Also logs the time from the transition trigger to the first ticked frame of the new map.
+ */
+UCLASS()
+class FIRSTPROYECT2_API ULevelPrefetchSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	ULevelPrefetchSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Starts loading the map package, and with bIncludeStreamingLevels its sublevels once it is in */
+	void Prefetch(FName LevelName, bool bIncludeStreamingLevels);
+
+	/** Lets go of a prefetched map, a load in flight still finishes */
+	void CancelPrefetch(FName LevelName);
+
+	/** Call right before OpenLevel, starts the transition timer */
+	void BeginTransition(FName LevelName);
+
+	bool IsPrefetched(FName LevelName) const;
+
+private:
+
+	struct FPrefetch
+	{
+		FName PackageName;
+
+		/** The map and its sublevels, as far as they are loaded */
+		TArray<FName> Packages;
+
+		/** World of the map package, LoadMap reused the prefetch if it travels into this one */
+		TWeakObjectPtr<UWorld> MapWorld;
+
+		bool bIncludeStreamingLevels = false;
+		bool bLoaded = false;
+		double StartTime = 0.0;
+		double ReadyTime = 0.0;
+		int32 NumStreamingLevelsLoading = 0;
+	};
+
+	/** Holds the world in the package until the transition, null if the package has none */
+	UWorld* HoldWorld(UPackage* Package);
+
+	void OnPackageLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result, FName LevelName);
+	void OnStreamingLevelLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result, FName LevelName);
+
+	void OnPostLoadMap(UWorld* World);
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	static FName ResolvePackageName(FName LevelName);
+
+	TMap<FName, FPrefetch> Prefetches;
+
+	/** Keeps prefetched map and sublevel worlds alive until the transition uses them, a package alone does not keep its world */
+	UPROPERTY(Transient)
+	TArray<UWorld*> LoadedWorlds;
+
+	/** Transition being timed */
+	FName TransitionLevel;
+	double TransitionStartTime;
+	FString TransitionPrefetchState;
+
+	FDelegateHandle PostLoadMapHandle;
+	FDelegateHandle PostActorTickHandle;
+};
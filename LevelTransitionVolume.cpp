@@ -4,7 +4,10 @@
 #include "LevelTransitionVolume.h"
 #include "Components/BoxComponent.h"
 #include "Components/BillboardComponent.h"
+#include "Components/SphereComponent.h"
+#include "Engine/GameInstance.h"
 #include "Main.h"
+#include "LevelPrefetchSubsystem.h"
 
 // Sets default values
 ALevelTransitionVolume::ALevelTransitionVolume()
@@ -18,7 +21,16 @@ ALevelTransitionVolume::ALevelTransitionVolume()
 	Billboard = CreateDefaultSubobject<UBillboardComponent>(TEXT("Billboard"));
 	Billboard->SetupAttachment(GetRootComponent());
 
+	PrefetchSphere = CreateDefaultSubobject<USphereComponent>(TEXT("PrefetchSphere"));
+	PrefetchSphere->SetupAttachment(GetRootComponent());
+	PrefetchSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	PrefetchSphere->SetCollisionObjectType(ECollisionChannel::ECC_WorldStatic);
+	PrefetchSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+	PrefetchSphere->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
+
 	TransitionLevelName = "SunTemple";
+	PrefetchRadius = 3000.f;
+	bPrefetchStreamingLevels = true;
 
 }
 
@@ -28,6 +40,17 @@ void ALevelTransitionVolume::BeginPlay()
 	Super::BeginPlay();
 
 	TransitionVolume->OnComponentBeginOverlap.AddDynamic(this, &ALevelTransitionVolume::OnOverlapBegin);
+
+	if (PrefetchRadius > 0.f)
+	{
+		PrefetchSphere->SetSphereRadius(PrefetchRadius + TransitionVolume->GetScaledBoxExtent().Size());
+		PrefetchSphere->OnComponentBeginOverlap.AddDynamic(this, &ALevelTransitionVolume::PrefetchOnOverlapBegin);
+		PrefetchSphere->OnComponentEndOverlap.AddDynamic(this, &ALevelTransitionVolume::PrefetchOnOverlapEnd);
+	}
+	else
+	{
+		PrefetchSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
 	
 }
 
@@ -50,3 +73,23 @@ void ALevelTransitionVolume::OnOverlapBegin(UPrimitiveComponent* OverlappedCompo
 	}
 }
 
+void ALevelTransitionVolume::PrefetchOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	if (!Cast<AMain>(OtherActor)) return;
+
+	if (ULevelPrefetchSubsystem* Prefetch = GetGameInstance() ? GetGameInstance()->GetSubsystem<ULevelPrefetchSubsystem>() : nullptr)
+	{
+		Prefetch->Prefetch(TransitionLevelName, bPrefetchStreamingLevels);
+	}
+}
+
+void ALevelTransitionVolume::PrefetchOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+	if (!Cast<AMain>(OtherActor)) return;
+
+	// Walked away, the map does not need to stay in memory
+	if (ULevelPrefetchSubsystem* Prefetch = GetGameInstance() ? GetGameInstance()->GetSubsystem<ULevelPrefetchSubsystem>() : nullptr)
+	{
+		Prefetch->CancelPrefetch(TransitionLevelName);
+	}
+}
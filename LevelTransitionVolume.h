@@ -23,6 +23,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition")
 	FName TransitionLevelName;
 
+	/** The player entering this starts loading TransitionLevelName in the background */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Transition")
+	class USphereComponent* PrefetchSphere;
+
+	/** Distance from the volume at which the target map starts loading, 0 turns prefetching off */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition", meta = (ClampMin = "0"))
+	float PrefetchRadius;
+
+	/** Also load the target map's streaming sublevels */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition")
+	bool bPrefetchStreamingLevels;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -34,6 +46,12 @@ public:
 	UFUNCTION()
 	virtual void OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 
+	UFUNCTION()
+	void PrefetchOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	UFUNCTION()
+	void PrefetchOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+
 	
 
 };
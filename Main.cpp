@@ -19,13 +19,28 @@
 #include "Enemy.h"
 #include "MainPlayercontroller.h"
 #include "FirstSaveGame.h"
-#include "ItemStorage.h"
+#include "WeaponRegistrySubsystem.h"
+#include "LevelPrefetchSubsystem.h"
+#include "EnemySpatialHashSubsystem.h"
+#include "ActorPoolSubsystem.h"
+#include "TimingWheelSubsystem.h"
+#include "InputRecorderSubsystem.h"
+#include "RandomStreamSubsystem.h"
+#include "SaveGameSubsystem.h"
+#include "WorldStateSubsystem.h"
+
+static_assert((uint8)EStaminaStaus::ESS_Normal == (uint8)CombatCore::EStaminaStatus::Normal
+	&& (uint8)EStaminaStaus::ESS_BelowMinimum == (uint8)CombatCore::EStaminaStatus::BelowMinimum
+	&& (uint8)EStaminaStaus::ESS_Exhausted == (uint8)CombatCore::EStaminaStatus::Exhausted
+	&& (uint8)EStaminaStaus::ESS_ExhaustedRecovering == (uint8)CombatCore::EStaminaStatus::ExhaustedRecovering,
+	"EStaminaStaus is cast straight to CombatCore::EStaminaStatus");
 
 // Sets default values
 AMain::AMain()
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	// Create Camera Boom (pulls towards the player if there is a collision)
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
@@ -84,6 +99,7 @@ AMain::AMain()
 	bInterpToEnemy = false;
 
 	bHasCombatTarget = false;
+	CombatTargetSearchRadius = 650.f;
 
 	bMovingForward = false;
 	bMovingRight = false;
@@ -96,7 +112,19 @@ void AMain::BeginPlay()
 	Super::BeginPlay();
 
 	MainPlayerController = Cast<AMainPlayerController>(GetController());
-	
+
+	InputRecorder = GetGameInstance() ? GetGameInstance()->GetSubsystem<UInputRecorderSubsystem>() : nullptr;
+	if (InputRecorder)
+	{
+		InputRecorder->BindPlayer(this);
+	}
+
+	if (UWeaponRegistrySubsystem* Weapons = GetGameInstance() ? GetGameInstance()->GetSubsystem<UWeaponRegistrySubsystem>() : nullptr)
+	{
+		Weapons->RegisterStorage(WeaponStorage);
+	}
+
+	ResetStamina();
 }
 
 // Called every frame
@@ -106,109 +134,6 @@ void AMain::Tick(float DeltaTime)
 
 	if (MovementStatus == EMovementStatus::EMS_Dead)return;
 
-	float DeltaStamina = StaminaDrainRate * DeltaTime;
-
-	switch (StaminaStatus)
-	{
-	case EStaminaStaus::ESS_Normal:
-		if (bShiftKeyDown && (bMovingForward || bMovingRight))
-		{
-			if (Stamina - DeltaStamina <= MinSprintStamina)
-			{
-				SetStaminaStaus(EStaminaStaus::ESS_BelowMinimum);
-				Stamina -= DeltaStamina;
-			}
-			else
-			{
-				Stamina -= DeltaStamina;
-			}
-			if (bMovingForward || bMovingRight)
-			{
-				SetMovementStatus(EMovementStatus::EMS_Sprinting);
-			}
-			else
-			{
-				SetMovementStatus(EMovementStatus::EMS_Normal);
-			}
-		}
-		else
-		{
-			if (Stamina + DeltaStamina >= MaxStamina)
-			{
-				Stamina = MaxStamina;
-			}
-			else
-			{
-				Stamina += DeltaStamina;
-			}
-			SetMovementStatus(EMovementStatus::EMS_Normal);
-		}
-		break;
-	case EStaminaStaus::ESS_BelowMinimum:
-		if (bShiftKeyDown && (bMovingForward || bMovingRight))
-		{
-			if (Stamina - DeltaStamina <= 0.f)
-			{
-				SetStaminaStaus(EStaminaStaus::ESS_Exhausted);
-				Stamina = 0;
-				SetMovementStatus(EMovementStatus::EMS_Normal);
-			}
-			else
-			{
-				Stamina -= DeltaStamina;
-				if (bMovingForward || bMovingRight)
-				{
-					SetMovementStatus(EMovementStatus::EMS_Sprinting);
-				}
-				else
-				{
-					SetMovementStatus(EMovementStatus::EMS_Normal);
-				}
-				
-			}
-		}
-		else
-		{
-			if (Stamina + DeltaStamina >= MinSprintStamina)
-			{
-				SetStaminaStaus(EStaminaStaus::ESS_Normal);
-				Stamina += DeltaStamina;
-			}
-			else
-			{
-				Stamina += DeltaStamina;
-			}
-			SetMovementStatus(EMovementStatus::EMS_Normal);
-		}
-		break;
-	case EStaminaStaus::ESS_Exhausted:
-		if (bShiftKeyDown)
-		{
-			Stamina = 0.f;
-		}
-		else
-		{
-			SetStaminaStaus(EStaminaStaus::ESS_ExhaustedRecovering);
-			Stamina += DeltaStamina;
-		}
-		SetMovementStatus(EMovementStatus::EMS_Normal);
-		break;
-	case EStaminaStaus::ESS_ExhaustedRecovering:
-		if (Stamina + DeltaStamina >= MinSprintStamina)
-		{
-			SetStaminaStaus(EStaminaStaus::ESS_Normal);
-			Stamina += DeltaStamina;
-		}
-		else
-		{
-			Stamina += DeltaStamina;
-		}
-		SetMovementStatus(EMovementStatus::EMS_Normal);
-		break;
-		default:
-			;
-	}
-
 	if (bInterpToEnemy && CombatTarget)
 	{
 		FRotator LookAtYaw = GetLookAtRotationYaw(CombatTarget->GetActorLocation());
@@ -228,6 +153,88 @@ void AMain::Tick(float DeltaTime)
 	
 }
 
+void AMain::SetCombatTarget(AEnemy* Target)
+{
+	CombatTarget = Target;
+	SetActorTickEnabled(CombatTarget != nullptr);
+}
+
+CombatCore::FStaminaRules AMain::GetStaminaRules() const
+{
+	CombatCore::FStaminaRules StaminaRules;
+	StaminaRules.MaxStamina = MaxStamina;
+	StaminaRules.MinSprintStamina = MinSprintStamina;
+	StaminaRules.DrainRate = StaminaDrainRate;
+	return StaminaRules;
+}
+
+float AMain::GetStamina()
+{
+	if (MovementStatus == EMovementStatus::EMS_Dead) return Stamina;
+
+	const CombatCore::EStaminaStatus PreviousStatus = StaminaTimeline.Status;
+	CombatCore::AdvanceStamina(StaminaTimeline, GetStaminaRules(), GetWorld()->GetTimeSeconds());
+	Stamina = StaminaTimeline.Stamina;
+
+	// Read after a transition came due but before its timer fired this frame
+	if (StaminaTimeline.Status != PreviousStatus)
+	{
+		SyncStamina();
+	}
+	return Stamina;
+}
+
+void AMain::ResetStamina()
+{
+	StaminaTimeline.Stamina = Stamina;
+	StaminaTimeline.Status = static_cast<CombatCore::EStaminaStatus>(StaminaStatus);
+	StaminaTimeline.AnchorTime = GetWorld()->GetTimeSeconds();
+	StaminaTimeline.bSprintHeld = bShiftKeyDown;
+	StaminaTimeline.bMoving = bMovingForward || bMovingRight;
+
+	SyncStamina();
+}
+
+void AMain::UpdateStaminaInput()
+{
+	const bool bMoving = bMovingForward || bMovingRight;
+	if (bShiftKeyDown == StaminaTimeline.bSprintHeld && bMoving == StaminaTimeline.bMoving) return;
+	if (MovementStatus == EMovementStatus::EMS_Dead) return;
+
+	// Input is read before the frame's delta is applied, the old per-frame step used this frame's
+	// input for the whole DeltaTime, so the change counts from the start of the frame
+	const UWorld* World = GetWorld();
+	const double InputTime = FMath::Max<double>(World->GetTimeSeconds() - World->GetDeltaSeconds(), StaminaTimeline.AnchorTime);
+
+	CombatCore::SetStaminaInput(StaminaTimeline, GetStaminaRules(), InputTime, bShiftKeyDown, bMoving);
+	SyncStamina();
+}
+
+void AMain::SyncStamina()
+{
+	if (MovementStatus == EMovementStatus::EMS_Dead) return;
+
+	const CombatCore::FStaminaRules StaminaRules = GetStaminaRules();
+	CombatCore::AdvanceStamina(StaminaTimeline, StaminaRules, GetWorld()->GetTimeSeconds());
+
+	Stamina = StaminaTimeline.Stamina;
+	SetStaminaStaus(static_cast<EStaminaStaus>(StaminaTimeline.Status));
+	SetMovementStatus(CombatCore::IsSprinting(StaminaTimeline) ? EMovementStatus::EMS_Sprinting : EMovementStatus::EMS_Normal);
+
+	UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>();
+	if (!Timers) return;
+
+	const double TimeToTransition = CombatCore::TimeToNextStaminaTransition(StaminaTimeline, StaminaRules);
+	if (TimeToTransition >= 0.0)
+	{
+		Timers->SetTimer(StaminaTimer, this, &AMain::SyncStamina, static_cast<float>(TimeToTransition));
+	}
+	else
+	{
+		Timers->ClearTimer(StaminaTimer);
+	}
+}
+
 FRotator AMain::GetLookAtRotationYaw(FVector Target)
 {
 	FRotator LookAtRotation = UKismetMathLibrary::FindLookAtRotation(GetActorLocation(), Target);
@@ -280,7 +287,7 @@ void AMain::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 	check(PlayerInputComponent);
 
 	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &AMain::Jump);
-	PlayerInputComponent->BindAction("Jump", IE_Released, this, &ACharacter::StopJumping);
+	PlayerInputComponent->BindAction("Jump", IE_Released, this, &AMain::StopJumping);
 
 	PlayerInputComponent->BindAction("Sprint", IE_Pressed, this, &AMain::ShiftKeyDown);
 	PlayerInputComponent->BindAction("Sprint", IE_Released, this, &AMain::ShiftKeyUp);
@@ -317,6 +324,8 @@ bool AMain::CanMove(float Value)
 
 void AMain::Turn(float Value)
 {
+	Value = ProcessInputAxis(EInputRecordAxis::Turn, Value);
+
 	if (CanMove(Value))
 	{
 		APawn::AddControllerYawInput(Value);
@@ -325,6 +334,8 @@ void AMain::Turn(float Value)
 
 void AMain::LookUp(float Value)
 {
+	Value = ProcessInputAxis(EInputRecordAxis::LookUp, Value);
+
 	if (CanMove(Value))
 	{
 		APawn::AddControllerPitchInput(Value);
@@ -333,6 +344,8 @@ void AMain::LookUp(float Value)
 
 void AMain::MoveForward(float Value)
 {
+	Value = ProcessInputAxis(EInputRecordAxis::MoveForward, Value);
+
 	bMovingForward = false;
 	if (CanMove(Value))
 	{
@@ -345,10 +358,14 @@ void AMain::MoveForward(float Value)
 
 		bMovingForward = true;
 	}
+
+	UpdateStaminaInput();
 }
 
 void AMain::MoveRight(float Value)
 {
+	Value = ProcessInputAxis(EInputRecordAxis::MoveRight, Value);
+
 	bMovingRight = false;
 	if (CanMove(Value))
 	{
@@ -361,20 +378,26 @@ void AMain::MoveRight(float Value)
 
 		bMovingRight = true;
 	}
+
+	UpdateStaminaInput();
 }
 
 void AMain::TurnAtRate(float Rate)
 {
+	Rate = ProcessInputAxis(EInputRecordAxis::TurnRate, Rate);
 	AddControllerYawInput(Rate * BaseTurnRate * GetWorld()->GetDeltaSeconds());
 }
 
 void AMain::LookUpAtRate(float Rate)
 {
+	Rate = ProcessInputAxis(EInputRecordAxis::LookUpRate, Rate);
 	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
 }
 
 void AMain::LMBDown() 
 {
+	RecordInputAction(EInputRecordAction::LMB, true);
+
 	bLMBDown = true;
 
 	if (MovementStatus == EMovementStatus::EMS_Dead) return;
@@ -401,11 +424,15 @@ void AMain::LMBDown()
 
 void AMain::LMBUp()
 {
+	RecordInputAction(EInputRecordAction::LMB, false);
+
 	bLMBDown = false;
 }
 
 void AMain::ESCDown()
 {
+	RecordInputAction(EInputRecordAction::ESC, true);
+
 	bESCDown = true;
 
 	if (MainPlayerController)
@@ -416,6 +443,8 @@ void AMain::ESCDown()
 
 void AMain::ESCUp()
 {
+	RecordInputAction(EInputRecordAction::ESC, false);
+
 	bESCDown = false;
 }
 
@@ -433,11 +462,21 @@ void AMain::Die()
 		AnimInstance->Montage_Play(CombatMontage, 1.f);
 		AnimInstance->Montage_JumpToSection(FName("Death"));
 	}
+
+	// Stamina stays frozen at its value on death
+	SyncStamina();
+	if (UTimingWheelSubsystem* Timers = GetWorld()->GetSubsystem<UTimingWheelSubsystem>())
+	{
+		Timers->ClearTimer(StaminaTimer);
+	}
+
 	SetMovementStatus(EMovementStatus::EMS_Dead);
 }
 
 void AMain::Jump()
 {
+	RecordInputAction(EInputRecordAction::Jump, true);
+
 	if (MainPlayerController)
 	{
 		if (MainPlayerController->bPauseMenuVisible) return;
@@ -448,6 +487,47 @@ void AMain::Jump()
 	}
 }
 
+void AMain::StopJumping()
+{
+	RecordInputAction(EInputRecordAction::Jump, false);
+
+	Super::StopJumping();
+}
+
+void AMain::ReplayInputAction(EInputRecordAction Action, bool bPressed)
+{
+	switch (Action)
+	{
+	case EInputRecordAction::Jump:
+		bPressed ? Jump() : StopJumping();
+		break;
+	case EInputRecordAction::Sprint:
+		bPressed ? ShiftKeyDown() : ShiftKeyUp();
+		break;
+	case EInputRecordAction::LMB:
+		bPressed ? LMBDown() : LMBUp();
+		break;
+	case EInputRecordAction::ESC:
+		bPressed ? ESCDown() : ESCUp();
+		break;
+	default:
+		;
+	}
+}
+
+float AMain::ProcessInputAxis(EInputRecordAxis Axis, float Value)
+{
+	return InputRecorder ? InputRecorder->ProcessAxis(Axis, Value) : Value;
+}
+
+void AMain::RecordInputAction(EInputRecordAction Action, bool bPressed)
+{
+	if (InputRecorder)
+	{
+		InputRecorder->RecordAction(Action, bPressed);
+	}
+}
+
 void AMain::DeathEnd()
 {
 	GetMesh()->bPauseAnims = true;
@@ -461,14 +541,7 @@ void AMain::IncrementCoins(int32 Amount)
 
 void AMain::IncrementHealth(float Amount)
 {
-	if (Health + Amount >= MaxHealth)
-	{
-		Health = MaxHealth;
-	}
-	else
-	{
-		Health += Amount;
-	}
+	CombatCore::Heal(Health, MaxHealth, Amount);
 }
 
 void AMain::SetMovementStatus(EMovementStatus Status)
@@ -486,12 +559,18 @@ void AMain::SetMovementStatus(EMovementStatus Status)
 
 void AMain::ShiftKeyDown()
 {
+	RecordInputAction(EInputRecordAction::Sprint, true);
+
 	bShiftKeyDown = true;
+	UpdateStaminaInput();
 }
 
 void AMain::ShiftKeyUp()
 {
+	RecordInputAction(EInputRecordAction::Sprint, false);
+
 	bShiftKeyDown = false;
+	UpdateStaminaInput();
 }
 
 void AMain::ShowPickUpLocations()
@@ -512,9 +591,9 @@ void AMain::ShowPickUpLocations()
 
 void AMain::SetEquippedWeapon(AWeapon* WeaponToSet)
 {
-	if (EquippedWeapon)
+	if (EquippedWeapon && EquippedWeapon != WeaponToSet)
 	{
-		EquippedWeapon->Destroy();
+		UActorPoolSubsystem::ReleaseOrDestroy(EquippedWeapon);
 	}
 
 	EquippedWeapon = WeaponToSet;
@@ -531,7 +610,7 @@ void AMain::Attack()
 		UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 		if (AnimInstance && CombatMontage)
 		{
-			int32 Section = FMath::RandRange(0, 1);
+			int32 Section = URandomStreamSubsystem::GetStream(this, TEXT("PlayerAttack")).RandRange(0, 1);
 			switch (Section)
 			{
 			case 0:
@@ -581,9 +660,8 @@ void AMain::SetInterpToEnemy(bool Interp)
 
 float AMain::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser)
 {
-	if (Health - DamageAmount <= 0)
+	if (CombatCore::ApplyDamage(Health, DamageAmount))
 	{
-		Health -= DamageAmount;
 		Die();
 		if (DamageCauser)
 		{
@@ -594,20 +672,16 @@ float AMain::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEve
 			}
 		}
 	}
-	else
-	{
-		Health -= DamageAmount;
-	}
 
 	return DamageAmount;
 }
 
 void AMain::UpdateCombatTarget()
 {
-	TArray<AActor*> OverlappingActors;
-	GetOverlappingActors(OverlappingActors, EnemyFilter);
+	UEnemySpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UEnemySpatialHashSubsystem>();
+	AEnemy* ClosestEnemy = SpatialHash ? SpatialHash->FindNearestEnemy(GetActorLocation(), CombatTargetSearchRadius, EnemyFilter) : nullptr;
 
-	if (OverlappingActors.Num() == 0)
+	if (ClosestEnemy == nullptr)
 	{
 		if (MainPlayerController)
 		{
@@ -615,34 +689,13 @@ void AMain::UpdateCombatTarget()
 		}
 		return;
 	}
-	AEnemy* ClosestEnemy = Cast<AEnemy>(OverlappingActors[0]);
-	if (ClosestEnemy)
-	{
-		FVector Location = GetActorLocation();
-		float MinDistance = (ClosestEnemy->GetActorLocation() - Location).Size();
 
-		for (AActor* Actor : OverlappingActors)
-		{
-			AEnemy* Enemy = Cast<AEnemy>(Actor);
-			if (Enemy)
-			{
-				float DistanceToActor = (Enemy->GetActorLocation() - Location).Size();
-				if (DistanceToActor < MinDistance)
-				{
-					MinDistance = DistanceToActor;
-					ClosestEnemy = Enemy;
-				}
-			}
-			
-		}
-		if (MainPlayerController)
-		{
-			MainPlayerController->DisplayEnemyHealthBar();
-		}
-		SetCombatTarget(ClosestEnemy);
-		bHasCombatTarget = true;
+	if (MainPlayerController)
+	{
+		MainPlayerController->DisplayEnemyHealthBar();
 	}
-	
+	SetCombatTarget(ClosestEnemy);
+	bHasCombatTarget = true;
 }
 
 void AMain::SwitchLevel(FName LevelName)
@@ -655,6 +708,18 @@ void AMain::SwitchLevel(FName LevelName)
 		FName CurrentLevelName(*CurrentLevel);
 		if (CurrentLevelName != LevelName)
 		{
+			// Keeps the class loaded through the map change, the next level equips it from the save
+			UWeaponRegistrySubsystem* Weapons = GetGameInstance() ? GetGameInstance()->GetSubsystem<UWeaponRegistrySubsystem>() : nullptr;
+			if (Weapons && EquippedWeapon)
+			{
+				Weapons->PreloadWeapon(EquippedWeapon->GetWeaponId());
+			}
+
+			if (ULevelPrefetchSubsystem* Prefetch = GetGameInstance() ? GetGameInstance()->GetSubsystem<ULevelPrefetchSubsystem>() : nullptr)
+			{
+				Prefetch->BeginTransition(LevelName);
+			}
+
 			UGameplayStatics::OpenLevel(World, LevelName);
 		}
 	}
@@ -662,31 +727,48 @@ void AMain::SwitchLevel(FName LevelName)
 
 void AMain::SaveGame()
 {
-	UFirstSaveGame* SaveGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::CreateSaveGameObject(UFirstSaveGame::StaticClass()));
+	USaveGameSubsystem* Saves = GetGameInstance() ? GetGameInstance()->GetSubsystem<USaveGameSubsystem>() : nullptr;
+	if (!Saves) return;
 
-	SaveGameInstance->CharacterStats.Health = Health;
-	SaveGameInstance->CharacterStats.MaxHealth = MaxHealth;
-	SaveGameInstance->CharacterStats.Coins = Coins;
-	SaveGameInstance->CharacterStats.Stamina = Stamina;
-	SaveGameInstance->CharacterStats.MaxStamina = MaxStamina;
+	SyncStamina();
 
-	if (EquippedWeapon)
+	const UFirstSaveGame* Defaults = GetDefault<UFirstSaveGame>();
+	Saves->SaveAsync(Defaults->PlayerName, Defaults->UserIndex, [this](UFirstSaveGame& SaveGameInstance)
 	{
-		SaveGameInstance->CharacterStats.WeaponName = EquippedWeapon->Name;
-	}
+		SaveGameInstance.CharacterStats.Health = Health;
+		SaveGameInstance.CharacterStats.MaxHealth = MaxHealth;
+		SaveGameInstance.CharacterStats.Coins = Coins;
+		SaveGameInstance.CharacterStats.Stamina = Stamina;
+		SaveGameInstance.CharacterStats.MaxStamina = MaxStamina;
 
-	SaveGameInstance->CharacterStats.Location = GetActorLocation();
-	SaveGameInstance->CharacterStats.Rotation = GetActorRotation();
+		if (EquippedWeapon)
+		{
+			SaveGameInstance.CharacterStats.WeaponId = EquippedWeapon->GetWeaponId();
+		}
 
-	UGameplayStatics::SaveGameToSlot(SaveGameInstance, SaveGameInstance->PlayerName, SaveGameInstance->UserIndex);
+		SaveGameInstance.CharacterStats.Location = GetActorLocation();
+		SaveGameInstance.CharacterStats.Rotation = GetActorRotation();
+		SaveGameInstance.MapName = UGameplayStatics::GetCurrentLevelName(this);
+	});
 
+	if (UWorldStateSubsystem* WorldState = GetWorld()->GetSubsystem<UWorldStateSubsystem>())
+	{
+		WorldState->SaveSnapshot(Defaults->PlayerName);
+	}
 }
 
 void AMain::LoadGame(bool SetPosition)
 {
-	UFirstSaveGame* LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::CreateSaveGameObject(UFirstSaveGame::StaticClass()));
+	USaveGameSubsystem* Saves = GetGameInstance() ? GetGameInstance()->GetSubsystem<USaveGameSubsystem>() : nullptr;
+	if (!Saves) return;
+
+	const UFirstSaveGame* Defaults = GetDefault<UFirstSaveGame>();
+	Saves->LoadAsync(Defaults->PlayerName, Defaults->UserIndex, FOnAsyncLoadComplete::CreateUObject(this, &AMain::ApplyLoadedGame, Defaults->PlayerName, SetPosition));
+}
 
-	LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::LoadGameFromSlot(LoadGameInstance->PlayerName, LoadGameInstance->UserIndex));
+void AMain::ApplyLoadedGame(UFirstSaveGame* LoadGameInstance, FString SlotName, bool SetPosition)
+{
+	if (!LoadGameInstance) return;
 
 	Health = LoadGameInstance->CharacterStats.Health;
 	MaxHealth = LoadGameInstance->CharacterStats.MaxHealth;
@@ -694,23 +776,6 @@ void AMain::LoadGame(bool SetPosition)
 	Stamina = LoadGameInstance->CharacterStats.Stamina;
 	MaxStamina = LoadGameInstance->CharacterStats.MaxStamina;
 
-	if (WeaponStorage)
-	{
-		AItemStorage* Weapons = GetWorld()->SpawnActor<AItemStorage>(WeaponStorage);
-		if (Weapons)
-		{
-			FString WeaponName = LoadGameInstance->CharacterStats.WeaponName;
-			if (Weapons->WeaponMap.Contains(WeaponName))
-			{
-				AWeapon* WeaponToEquip = GetWorld()->SpawnActor<AWeapon>(Weapons->WeaponMap[WeaponName]);
-				WeaponToEquip->Equip(this);
-			}
-			
-			
-		}
-	}
-	
-
 	if (SetPosition)
 	{
 		SetActorLocation(LoadGameInstance->CharacterStats.Location);
@@ -718,8 +783,67 @@ void AMain::LoadGame(bool SetPosition)
 	}
 
 	SetMovementStatus(EMovementStatus::EMS_Normal);
+	ResetStamina();
 	GetMesh()->bPauseAnims = false;
 	GetMesh()->bNoSkeletonUpdate = false;
+
+	// After the revive above, a class that is already loaded calls EquipLoadedWeapon right away
+	const FCharacterStats& Stats = LoadGameInstance->CharacterStats;
+	const FName WeaponId = Stats.WeaponId.IsNone() && !Stats.WeaponName.IsEmpty() ? FName(*Stats.WeaponName) : Stats.WeaponId;
+	UWeaponRegistrySubsystem* Weapons = GetGameInstance() ? GetGameInstance()->GetSubsystem<UWeaponRegistrySubsystem>() : nullptr;
+	if (Weapons && !WeaponId.IsNone())
+	{
+		Weapons->RequestWeaponClass(WeaponId, FOnWeaponClassLoaded::CreateUObject(this, &AMain::EquipLoadedWeapon));
+	}
+
+	// The world file can be newer than the slot, autosaves only write the world file
+	if (UWorldStateSubsystem* WorldState = GetWorld()->GetSubsystem<UWorldStateSubsystem>())
+	{
+		WorldState->RestoreAsync(SlotName, SetPosition);
+	}
+}
+
+void AMain::EquipLoadedWeapon(TSubclassOf<AWeapon> WeaponClass)
+{
+	if (!WeaponClass || MovementStatus == EMovementStatus::EMS_Dead) return;
+	if (EquippedWeapon && EquippedWeapon->GetClass() == WeaponClass) return;
+
+	UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	AWeapon* WeaponToEquip = Pool ? Pool->Acquire<AWeapon>(WeaponClass, GetActorTransform())
+		: GetWorld()->SpawnActor<AWeapon>(WeaponClass);
+	if (WeaponToEquip)
+	{
+		WeaponToEquip->Equip(this);
+	}
+}
+
+void AMain::SerializeSaveState(FArchive& Ar)
+{
+	if (Ar.IsSaving())
+	{
+		SyncStamina();
+	}
+
+	float SavedHealth = Health;
+	float SavedMaxHealth = MaxHealth;
+	float SavedStamina = Stamina;
+	float SavedMaxStamina = MaxStamina;
+	int32 SavedCoins = Coins;
+	FVector Location = GetActorLocation();
+	FRotator Rotation = GetActorRotation();
+	Ar << SavedHealth << SavedMaxHealth << SavedStamina << SavedMaxStamina << SavedCoins << Location << Rotation;
+
+	if (!Ar.IsLoading() || MovementStatus == EMovementStatus::EMS_Dead) return;
+
+	Health = SavedHealth;
+	MaxHealth = SavedMaxHealth;
+	Stamina = SavedStamina;
+	MaxStamina = SavedMaxStamina;
+	Coins = SavedCoins;
+	SetActorLocation(Location);
+	SetActorRotation(Rotation);
+
+	ResetStamina();
 }
 
 
@@ -4,8 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "TimingWheel.h"
+#include "CombatCore.h"
+#include "SaveableActor.h"
 #include "Main.generated.h"
 
+enum class EInputRecordAxis : uint8;
+enum class EInputRecordAction : uint8;
+
 UENUM(BlueprintType)
 enum class EMovementStatus : uint8
 {
@@ -28,7 +34,7 @@ enum class EStaminaStaus : uint8
 };
 
 UCLASS()
-class FIRSTPROYECT2_API AMain : public ACharacter
+class FIRSTPROYECT2_API AMain : public ACharacter, public ISaveableActor
 {
 	GENERATED_BODY()
 
@@ -36,6 +42,7 @@ public:
 	// Sets default values for this character's properties
 	AMain();
 
+	/** Legacy weapon table, its WeaponMap is added to UWeaponRegistrySubsystem in BeginPlay */
 	UPROPERTY(EditDefaultsOnly, Category = "SaveData")
 	TSubclassOf<class AItemStorage> WeaponStorage;
 
@@ -84,7 +91,8 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat")
 	class AEnemy* CombatTarget;
 
-	FORCEINLINE void SetCombatTarget(AEnemy* Target) { CombatTarget = Target; }
+	/** Tick only interpolates towards and tracks the combat target, so it runs only while there is one */
+	void SetCombatTarget(AEnemy* Target);
 
 	FRotator GetLookAtRotationYaw(FVector Target);
 
@@ -135,9 +143,14 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "PlayerStats")
 	float MaxStamina;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PlayerStats")
+	/** Only current as of the last stamina anchor, HUD bindings read GetStamina */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PlayerStats", meta = (DeprecatedProperty, DeprecationMessage = "Stamina is evaluated lazily, bind to GetStamina instead."))
 	float Stamina;
 
+	/** Advances the stamina timeline to now and returns the value, nothing steps it per frame */
+	UFUNCTION(BlueprintPure, Category = "PlayerStats")
+	float GetStamina();
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PlayerStats")
 	int32 Coins;
 
@@ -183,6 +196,22 @@ public:
 	bool bMovingForward;
 	bool bMovingRight;
 
+	CombatCore::FStaminaRules GetStaminaRules() const;
+
+	/** Re-anchors the stamina timeline on Stamina and StaminaStatus, after loading or reviving */
+	void ResetStamina();
+
+	/** Feeds shift and movement into the stamina timeline when either changed */
+	void UpdateStaminaInput();
+
+	/** Brings Stamina, StaminaStatus and the movement status up to date and schedules the next transition */
+	void SyncStamina();
+
+	CombatCore::FStaminaTimeline StaminaTimeline;
+
+	/** Fires SyncStamina when the next stamina transition is due */
+	FTimingWheelHandle StaminaTimer;
+
 	bool CanMove(float Value);
 
 	/** Called via input to turn at a given rate
@@ -195,6 +224,19 @@ public:
 	*/
 	void LookUpAtRate(float Rate);
 
+	virtual void StopJumping() override;
+
+	/** Runs the handler bound to Action, used by UInputRecorderSubsystem replays */
+	void ReplayInputAction(EInputRecordAction Action, bool bPressed);
+
+	/** Records the axis value, or substitutes the recorded one while replaying */
+	float ProcessInputAxis(EInputRecordAxis Axis, float Value);
+
+	void RecordInputAction(EInputRecordAction Action, bool bPressed);
+
+	UPROPERTY(Transient)
+	class UInputRecorderSubsystem* InputRecorder;
+
 	bool bLMBDown;
 	void LMBDown();
 	void LMBUp();
@@ -239,12 +281,25 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	TSubclassOf<AEnemy> EnemyFilter;
 
+	/** Enemies closer than this are candidates for UpdateCombatTarget (agro radius + capsule radius) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	float CombatTargetSearchRadius;
+
 
 	void SwitchLevel(FName LevelName);
 
 	UFUNCTION(BlueprintCallable)
 	void SaveGame();
 
+	/** Reads the slot in the background, the stats are applied a few frames later */
 	UFUNCTION(BlueprintCallable)
 	void LoadGame(bool SetPosition);
+
+	void ApplyLoadedGame(class UFirstSaveGame* LoadGameInstance, FString SlotName, bool SetPosition);
+
+	/** Completion of the weapon registry request ApplyLoadedGame makes for the saved weapon */
+	void EquipLoadedWeapon(TSubclassOf<AWeapon> WeaponClass);
+
+	// ISaveableActor
+	virtual void SerializeSaveState(FArchive& Ar) override;
 };
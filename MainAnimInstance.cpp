@@ -2,11 +2,67 @@
 
 
 #include "MainAnimInstance.h"
+#include "FirstProyect2.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
 #include "Main.h"
 
+DECLARE_CYCLE_STAT(TEXT("Main Anim Update (Game Thread)"), STAT_MainAnimUpdateGameThread, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("Main Anim Update (Worker)"), STAT_MainAnimUpdateWorker, STATGROUP_FirstProyect2);
+
+static TAutoConsoleVariable<int32> CVarMainAnimThreadSafeUpdate(
+	TEXT("FirstProyect2.MainAnimThreadSafeUpdate"),
+	1,
+	TEXT("1 derives the player's anim properties on the animation worker, 0 computes all of it on the game thread like before, to compare the Main Anim Update stats."),
+	ECVF_Default);
+
+void FMainAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MainAnimUpdateGameThread);
+
+	FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
+
+	bThreadSafeUpdate = CVarMainAnimThreadSafeUpdate.GetValueOnGameThread() != 0;
+	if (!bThreadSafeUpdate) return;
+
+	// Only the inputs are read here, the owner does not change after initialization
+	const UMainAnimInstance* Instance = CastChecked<UMainAnimInstance>(InAnimInstance);
+	if (APawn* Pawn = Instance->Pawn)
+	{
+		Velocity = Pawn->GetVelocity();
+		const UPawnMovementComponent* MovementComponent = Pawn->GetMovementComponent();
+		bIsFalling = MovementComponent && MovementComponent->IsFalling();
+	}
+}
+
+void FMainAnimInstanceProxy::Update(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MainAnimUpdateWorker);
+
+	FAnimInstanceProxy::Update(DeltaSeconds);
+
+	if (!bThreadSafeUpdate) return;
+
+	// Runs before the graph of this update reads the properties, nothing on the game thread reads them meanwhile
+	UMainAnimInstance* Instance = CastChecked<UMainAnimInstance>(GetAnimInstanceObject());
+	Instance->MovementSpeed = Velocity.Size2D();
+	Instance->bIsInAir = bIsFalling;
+}
+
+FAnimInstanceProxy* UMainAnimInstance::CreateAnimInstanceProxy()
+{
+	return new FMainAnimInstanceProxy(this);
+}
+
+void UMainAnimInstance::DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy)
+{
+	delete InProxy;
+}
+
 void UMainAnimInstance::NativeInitializeAnimation()
 {
+	Super::NativeInitializeAnimation();
+
 	if (Pawn == nullptr)
 	{
 		Pawn = TryGetPawnOwner();
@@ -17,8 +73,24 @@ void UMainAnimInstance::NativeInitializeAnimation()
 	}
 }
 
-void UMainAnimInstance::UpdateAnimationProperties()
+void UMainAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 {
+	Super::NativeUpdateAnimation(DeltaSeconds);
+
+	if (CVarMainAnimThreadSafeUpdate.GetValueOnGameThread() != 0)
+	{
+		// Pawn is only missing when the instance was initialized before the mesh had an owner
+		if (Pawn == nullptr)
+		{
+			Pawn = TryGetPawnOwner();
+			Main = Cast<AMain>(Pawn);
+		}
+		return;
+	}
+
+	// The old path, everything on the game thread
+	SCOPE_CYCLE_COUNTER(STAT_MainAnimUpdateGameThread);
+
 	if (Pawn == nullptr)
 	{
 		Pawn = TryGetPawnOwner();
@@ -37,4 +109,8 @@ void UMainAnimInstance::UpdateAnimationProperties()
 			Main = Cast<AMain>(Pawn);
 		}
 	}
-}
\ No newline at end of file
+}
+
+void UMainAnimInstance::UpdateAnimationProperties()
+{
+}
@@ -4,10 +4,32 @@
 
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
 #include "MainAnimInstance.generated.h"
 
+/** Copies the owner's movement on the game thread and derives the anim properties on the worker */
+USTRUCT()
+struct FMainAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY()
+
+	FMainAnimInstanceProxy() {}
+	FMainAnimInstanceProxy(UAnimInstance* InAnimInstance) : FAnimInstanceProxy(InAnimInstance) {}
+
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+	virtual void Update(float DeltaSeconds) override;
+
+private:
+
+	FVector Velocity = FVector::ZeroVector;
+	bool bIsFalling = false;
+	bool bThreadSafeUpdate = false;
+};
+
 /**
- * 
+ * Movement inputs are gathered in the proxy PreUpdate and the properties derived in the proxy
+ * Update, which runs on a worker thread with the rest of the animation update. The event graph no
+ * longer needs to call UpdateAnimationProperties.
  */
 UCLASS()
 class FIRSTPROYECT2_API UMainAnimInstance : public UAnimInstance
@@ -17,6 +39,9 @@ public:
 
 	virtual void NativeInitializeAnimation() override;
 
+	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+
+	/** Kept so existing Blueprints compile, the properties are updated natively now */
 	UFUNCTION(BlueprintCallable, Category = AnimationsProperties)
 	void UpdateAnimationProperties();
 
@@ -31,4 +56,9 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Movement)
 	class AMain* Main;
+
+protected:
+
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+	virtual void DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) override;
 };
@@ -3,6 +3,8 @@
 
 #include "MainPlayerController.h"
 #include "Blueprint/UserWidget.h"
+#include "InputRecorderSubsystem.h"
+#include "Engine/GameInstance.h"
 
 void AMainPlayerController::BeginPlay()
 {
@@ -74,6 +76,17 @@ void AMainPlayerController::Tick(float DeltaTime)
 	}
 }
 
+void AMainPlayerController::PlayerTick(float DeltaTime)
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	if (UInputRecorderSubsystem* Recorder = GameInstance ? GameInstance->GetSubsystem<UInputRecorderSubsystem>() : nullptr)
+	{
+		Recorder->DispatchReplayActions();
+	}
+
+	Super::PlayerTick(DeltaTime);
+}
+
 void AMainPlayerController::DisplayPauseMenu_Implementation()
 {
 	if (PauseMenu)
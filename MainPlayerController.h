@@ -59,5 +59,8 @@ protected:
 
 	virtual void Tick(float DeltaTime) override;
 
+	/** Replays recorded actions ahead of this frame's input processing */
+	virtual void PlayerTick(float DeltaTime) override;
+
 	
 };
@@ -7,10 +7,12 @@
 #include "Engine/World.h"
 #include "Sound/SoundCue.h"
 #include "Particles/ParticleSystemComponent.h"
+#include "ActorPoolSubsystem.h"
+#include "FXManagerSubsystem.h"
 
 APickUp::APickUp()
 {
-	
+	bConsumed = false;
 }
 
 void APickUp::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -27,16 +29,18 @@ void APickUp::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* O
 			OnPickupBP(Main);
 			Main->PickUpLocations.Add(GetActorLocation());
 
-			if (OverlapParticles)
+			UFXManagerSubsystem* FX = GetWorld()->GetSubsystem<UFXManagerSubsystem>();
+			if (OverlapParticles && FX)
 			{
-				UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), OverlapParticles, GetActorLocation(), FRotator(0.f), true);
+				FX->SpawnEmitter(OverlapParticles, GetActorLocation());
 			}
-			if (OverlapSound)
+			if (OverlapSound && FX)
 			{
-				UGameplayStatics::PlaySound2D(this, OverlapSound);
+				FX->PlaySound2D(OverlapSound, GetActorLocation());
 			}
 
-			Destroy();
+			bConsumed = true;
+			UActorPoolSubsystem::ReleaseOrDestroy(this);
 		}
 	}
 }
@@ -49,4 +53,28 @@ void APickUp::OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* Oth
 	UE_LOG(LogTemp, Warning, TEXT("PickUp::OnOverlapEnd()"));
 }
 
+void APickUp::OnAcquiredFromPool_Implementation()
+{
+	Super::OnAcquiredFromPool_Implementation();
+
+	bConsumed = false;
+}
+
+void APickUp::SerializeSaveState(FArchive& Ar)
+{
+	bool bSavedConsumed = bConsumed;
+	Ar << bSavedConsumed;
+
+	if (!Ar.IsLoading() || bSavedConsumed == bConsumed) return;
 
+	if (bSavedConsumed)
+	{
+		bConsumed = true;
+		UActorPoolSubsystem::ReleaseOrDestroy(this);
+	}
+	else if (UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>())
+	{
+		// Parked where it was placed, OnAcquiredFromPool clears bConsumed
+		Pool->UnparkActor(this);
+	}
+}
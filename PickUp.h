@@ -4,13 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "Item.h"
+#include "SaveableActor.h"
 #include "PickUp.generated.h"
 
 /**
  * 
  */
 UCLASS()
-class FIRSTPROYECT2_API APickUp : public AItem
+class FIRSTPROYECT2_API APickUp : public AItem, public ISaveableActor
 {
 	GENERATED_BODY()
 public:
@@ -26,4 +27,13 @@ public:
 	UFUNCTION(BlueprintImplementableEvent, Category = "Pickup")
 	void OnPickupBP(class AMain* Target);
 
+	/** Picked up and back in the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pickup")
+	bool bConsumed;
+
+	virtual void OnAcquiredFromPool_Implementation() override;
+
+	// ISaveableActor
+	virtual void SerializeSaveState(FArchive& Ar) override;
+
 };
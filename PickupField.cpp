@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PickupField.h"
+#include "FirstProyect2.h"
+#include "Main.h"
+#include "FXManagerSubsystem.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/World.h"
+#include "Sound/SoundCue.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Field Tick"), STAT_PickupFieldTick, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pickup Field Instances"), STAT_PickupFieldInstances, STATGROUP_FirstProyect2);
+
+// Sets default values
+APickupField::APickupField()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	Instances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Instances"));
+	RootComponent = Instances;
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetGenerateOverlapEvents(false);
+
+	Reward = EPickupFieldReward::EPR_Coins;
+	Amount = 1.f;
+	CollectRadius = 90.f;
+	RotationRate = 45.f;
+
+	GridRows = 10;
+	GridColumns = 10;
+	GridSpacing = 200.f;
+
+	NumRemaining = 0;
+	Bounds = FBox(ForceInit);
+}
+
+void APickupField::FillGrid()
+{
+	PickupLocations.Reset(GridRows * GridColumns);
+	for (int32 Row = 0; Row < GridRows; Row++)
+	{
+		for (int32 Column = 0; Column < GridColumns; Column++)
+		{
+			PickupLocations.Add(FVector(Row * GridSpacing, Column * GridSpacing, 0.f));
+		}
+	}
+
+	RebuildInstances();
+}
+
+void APickupField::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	RebuildInstances();
+}
+
+void APickupField::RebuildInstances()
+{
+	Instances->ClearInstances();
+	for (const FVector& Location : PickupLocations)
+	{
+		Instances->AddInstance(FTransform(Location));
+	}
+	Instances->SetScalarParameterValueOnMaterials(TEXT("RotationRate"), RotationRate);
+}
+
+// Called when the game starts or when spawned
+void APickupField::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (Instances->GetInstanceCount() != PickupLocations.Num())
+	{
+		RebuildInstances();
+	}
+
+	Collected.Init(false, PickupLocations.Num());
+	NumRemaining = PickupLocations.Num();
+	INC_DWORD_STAT_BY(STAT_PickupFieldInstances, NumRemaining);
+
+	// The field never moves, so the grid holds world space locations once
+	Grid.Reset(FMath::Max(CollectRadius * 4.f, 100.f));
+	Bounds = FBox(ForceInit);
+	const FTransform& Transform = GetActorTransform();
+	for (int32 i = 0; i < PickupLocations.Num(); i++)
+	{
+		const FVector Location = Transform.TransformPosition(PickupLocations[i]);
+		Grid.Add(i, Location);
+		Bounds += Location;
+	}
+	Bounds = Bounds.ExpandBy(CollectRadius);
+
+	SetActorTickEnabled(NumRemaining > 0);
+}
+
+// Called every frame
+void APickupField::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PickupFieldTick);
+
+	Super::Tick(DeltaTime);
+
+	AMain* Main = Cast<AMain>(UGameplayStatics::GetPlayerCharacter(this, 0));
+	if (!Main) return;
+
+	const FVector Origin = Main->GetActorLocation();
+	if (!Bounds.IsInsideOrOn(Origin)) return;
+
+	QueryResults.Reset();
+	Grid.QueryRadius(Origin, CollectRadius, QueryResults);
+	if (QueryResults.Num() == 0) return;
+
+	for (int32 i = 0; i < QueryResults.Num(); i++)
+	{
+		Collect(QueryResults[i], Main);
+	}
+
+	// One render state update for everything collected this frame
+	Instances->MarkRenderStateDirty();
+
+	if (NumRemaining == 0)
+	{
+		SetActorTickEnabled(false);
+	}
+}
+
+void APickupField::Collect(int32 Index, AMain* Main)
+{
+	const FVector Location = GetActorTransform().TransformPosition(PickupLocations[Index]);
+
+	HideInstance(Index);
+
+	if (Reward == EPickupFieldReward::EPR_Coins)
+	{
+		Main->IncrementCoins(FMath::RoundToInt(Amount));
+	}
+	else
+	{
+		Main->IncrementHealth(Amount);
+	}
+
+	OnPickupBP(Main, Location);
+	Main->PickUpLocations.Add(Location);
+
+	UFXManagerSubsystem* FX = GetWorld()->GetSubsystem<UFXManagerSubsystem>();
+	if (OverlapParticles && FX)
+	{
+		FX->SpawnEmitter(OverlapParticles, Location);
+	}
+	if (OverlapSound && FX)
+	{
+		FX->PlaySound2D(OverlapSound, Location);
+	}
+}
+
+void APickupField::HideInstance(int32 Index)
+{
+	if (Collected[Index]) return;
+
+	Collected[Index] = true;
+	NumRemaining--;
+	DEC_DWORD_STAT(STAT_PickupFieldInstances);
+
+	Grid.Remove(Index);
+	Instances->UpdateInstanceTransform(Index, FTransform(FQuat::Identity, PickupLocations[Index], FVector::ZeroVector), false, false, true);
+}
+
+void APickupField::ShowInstance(int32 Index)
+{
+	if (!Collected[Index]) return;
+
+	Collected[Index] = false;
+	NumRemaining++;
+	INC_DWORD_STAT(STAT_PickupFieldInstances);
+
+	Grid.Add(Index, GetActorTransform().TransformPosition(PickupLocations[Index]));
+	Instances->UpdateInstanceTransform(Index, FTransform(PickupLocations[Index]), false, false, true);
+}
+
+void APickupField::SerializeSaveState(FArchive& Ar)
+{
+	TBitArray<> SavedCollected = Collected;
+	Ar << SavedCollected;
+
+	if (Ar.IsLoading())
+	{
+		const int32 Num = FMath::Min(SavedCollected.Num(), Collected.Num());
+		for (int32 i = 0; i < Num; i++)
+		{
+			if (SavedCollected[i])
+			{
+				HideInstance(i);
+			}
+			else
+			{
+				ShowInstance(i);
+			}
+		}
+		Instances->MarkRenderStateDirty();
+		SetActorTickEnabled(NumRemaining > 0);
+	}
+}
+
+void APickupField::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	DEC_DWORD_STAT_BY(STAT_PickupFieldInstances, NumRemaining);
+
+	Super::EndPlay(EndPlayReason);
+}
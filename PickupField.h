@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SaveableActor.h"
+#include "SpatialHashGrid.h"
+#include "PickupField.generated.h"
+
+UENUM(BlueprintType)
+enum class EPickupFieldReward : uint8
+{
+	EPR_Coins UMETA(DisplayName = "Coins"),
+	EPR_Health UMETA(DisplayName = "Health"),
+
+	EPR_Max UMETA(DisplayName = "DefaultMax")
+};
+
+/**
+ * Many pickups of one kind as plain records drawn by a single instanced mesh, for levels with
+ * thousands of coins. Nothing per pickup ticks or collides: the field looks up pickups near the
+ * player in a spatial hash once a frame. Spinning belongs in the material, e.g. RotateAboutAxis on
+ * World Position Offset driven by the RotationRate scalar parameter the field sets.
+ */
+UCLASS()
+class FIRSTPROYECT2_API APickupField : public AActor, public ISaveableActor
+{
+	GENERATED_BODY()
+	
+public:	
+	// Sets default values for this actor's properties
+	APickupField();
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PickupField")
+	class UHierarchicalInstancedStaticMeshComponent* Instances;
+
+	/** Pickup locations relative to the actor */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PickupField", meta = (MakeEditWidget = "true"))
+	TArray<FVector> PickupLocations;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PickupField")
+	EPickupFieldReward Reward;
+
+	/** Coins or health per pickup */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PickupField")
+	float Amount;
+
+	/** Pickups this close to the player's capsule center are collected */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PickupField")
+	float CollectRadius;
+
+	/** Degrees per second, handed to the material */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PickupField")
+	float RotationRate;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PickupField | Particles")
+	class UParticleSystem* OverlapParticles;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PickupField | Sound")
+	class USoundCue* OverlapSound;
+
+	UPROPERTY(EditAnywhere, Category = "PickupField | Layout")
+	int32 GridRows;
+
+	UPROPERTY(EditAnywhere, Category = "PickupField | Layout")
+	int32 GridColumns;
+
+	UPROPERTY(EditAnywhere, Category = "PickupField | Layout")
+	float GridSpacing;
+
+	/** Replaces PickupLocations with a GridRows x GridColumns grid */
+	UFUNCTION(CallInEditor, Category = "PickupField | Layout")
+	void FillGrid();
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "PickupField")
+	void OnPickupBP(class AMain* Target, FVector Location);
+
+	UFUNCTION(BlueprintPure, Category = "PickupField")
+	int32 GetNumRemaining() const { return NumRemaining; }
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	// ISaveableActor
+	virtual void SerializeSaveState(FArchive& Ar) override;
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:	
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+private:
+
+	void Collect(int32 Index, AMain* Main);
+
+	/** Instances keep their index, a collected one is scaled to nothing */
+	void HideInstance(int32 Index);
+
+	/** Undoes HideInstance when restoring a save from before the pickup was collected */
+	void ShowInstance(int32 Index);
+
+	void RebuildInstances();
+
+	FSpatialHashGrid Grid;
+
+	/** Indexed like PickupLocations */
+	TBitArray<> Collected;
+	int32 NumRemaining;
+
+	/** World space bounds of every pickup grown by CollectRadius, the player outside skips the query */
+	FBox Bounds;
+
+	TArray<int32> QueryResults;
+};
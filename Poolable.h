@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "Poolable.generated.h"
+
+UINTERFACE(MinimalAPI, BlueprintType)
+class UPoolable : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Actors that UActorPoolSubsystem can recycle instead of destroying. The pool already handles
+ * visibility, collision, actor tick and the transform; these hooks reset everything else.
+ */
+class FIRSTPROYECT2_API IPoolable
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Leaving the pool, already placed at its spawn transform */
+	UFUNCTION(BlueprintNativeEvent, Category = "Pooling")
+	void OnAcquiredFromPool();
+
+	/** Going back into the pool, drop targets, timers and subsystem registrations here */
+	UFUNCTION(BlueprintNativeEvent, Category = "Pooling")
+	void OnReleasedToPool();
+};
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RandomStreamSubsystem.h"
+#include "FirstProyect2.h"
+#include "InputRecorderSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Crc.h"
+
+URandomStreamSubsystem::URandomStreamSubsystem()
+{
+	bHasSessionSeed = false;
+	SessionSeed = 0;
+}
+
+void URandomStreamSubsystem::Deinitialize()
+{
+	Streams.Reset();
+
+	Super::Deinitialize();
+}
+
+int32 URandomStreamSubsystem::GetSessionSeed()
+{
+	if (bHasSessionSeed) return SessionSeed;
+	bHasSessionSeed = true;
+
+	UGameInstance* GameInstance = GetWorld()->GetGameInstance();
+	UInputRecorderSubsystem* Recorder = GameInstance ? GameInstance->GetSubsystem<UInputRecorderSubsystem>() : nullptr;
+	if (Recorder && (Recorder->IsRecording() || Recorder->IsReplaying()))
+	{
+		SessionSeed = Recorder->GetSeed();
+	}
+	else if (!FParse::Value(FCommandLine::Get(), TEXT("-RandomSeed="), SessionSeed))
+	{
+		SessionSeed = (int32)(FPlatformTime::Cycles() & 0x7fffffff);
+	}
+	return SessionSeed;
+}
+
+FRandomStream& URandomStreamSubsystem::GetStream(FName Name)
+{
+	if (FRandomStream* Stream = Streams.Find(Name))
+	{
+		return *Stream;
+	}
+
+	// Hashed from the string, FName indices differ between runs
+	const uint32 NameHash = FCrc::StrCrc32(*Name.ToString());
+	return Streams.Add(Name, FRandomStream((int32)HashCombine((uint32)GetSessionSeed(), NameHash)));
+}
+
+FRandomStream& URandomStreamSubsystem::GetStream(const UObject* WorldContext, FName Name)
+{
+	UWorld* World = WorldContext ? WorldContext->GetWorld() : nullptr;
+	if (URandomStreamSubsystem* RandomStreams = World ? World->GetSubsystem<URandomStreamSubsystem>() : nullptr)
+	{
+		return RandomStreams->GetStream(Name);
+	}
+
+	static FRandomStream Fallback(0);
+	return Fallback;
+}
+
+void URandomStreamSubsystem::DumpStreams()
+{
+	UE_LOG(LogTemp, Display, TEXT("RandomStreams: session seed %d, %d streams"), GetSessionSeed(), Streams.Num());
+	for (const TPair<FName, FRandomStream>& Pair : Streams)
+	{
+		UE_LOG(LogTemp, Display, TEXT("  %-24s initial seed %11d, current seed %11d"), *Pair.Key.ToString(), Pair.Value.GetInitialSeed(), Pair.Value.GetCurrentSeed());
+	}
+}
+
+static FAutoConsoleCommandWithWorld RandomStreamsCommand(
+	TEXT("FirstProyect2.RandomStreams"),
+	TEXT("Logs the session seed and every named random stream of the world"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (URandomStreamSubsystem* RandomStreams = World ? World->GetSubsystem<URandomStreamSubsystem>() : nullptr)
+		{
+			RandomStreams->DumpStreams();
+		}
+	}));
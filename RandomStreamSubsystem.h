@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Math/RandomStream.h"
+#include "RandomStreamSubsystem.generated.h"
+
+/**
+ * Named FRandomStreams for gameplay randomness, one set per world. Each stream is seeded from the
+ * session seed and its name, so a stream gives the same sequence on every run no matter how much
+ * the others are used. The session seed is the input recording's seed while recording or
+ * replaying, else -RandomSeed=<N>, else random.
+ */
+UCLASS()
+class FIRSTPROYECT2_API URandomStreamSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	URandomStreamSubsystem();
+
+	virtual void Deinitialize() override;
+
+	/** Created on first use. The reference is only valid until the next stream is created */
+	FRandomStream& GetStream(FName Name);
+
+	/** Stream of WorldContext's world, or a shared unseeded stream when there is none */
+	static FRandomStream& GetStream(const UObject* WorldContext, FName Name);
+
+	int32 GetSessionSeed();
+
+	void DumpStreams();
+
+private:
+
+	TMap<FName, FRandomStream> Streams;
+
+	bool bHasSessionSeed;
+	int32 SessionSeed;
+};
@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SaveFileFormat.h"
+#include "FirstProyect2.h"
+#include "WorldSnapshot.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace SaveFile
+{
+	/** "FPSG" */
+	static const uint32 FileMagic = 0x47535046;
+	/** "FPSI" */
+	static const uint32 IndexMagic = 0x49535046;
+	static const int32 FileVersion = 2;
+	static const int32 IndexVersion = 1;
+
+	/** Beyond what zlib or LZ4 reach on real data, a larger UncompressedSize is a damaged or forged header */
+	static const int64 MaxCompressionRatio = 256;
+
+	static FName GetFormatName(ESaveCompression Compression)
+	{
+		switch (Compression)
+		{
+		case ESaveCompression::Zlib: return NAME_Zlib;
+		case ESaveCompression::LZ4: return NAME_LZ4;
+		default: return NAME_None;
+		}
+	}
+
+	/** OutPayloadOffset is where the stored payload starts in Bytes */
+	static bool ReadHeader(const TArray<uint8>& Bytes, FSaveFileHeader& OutHeader, int64& OutPayloadOffset)
+	{
+		FMemoryReader Reader(Bytes);
+		uint32 Magic = 0;
+		uint8 Compression = 0;
+		Reader << Magic << OutHeader.Version;
+		if (Reader.IsError() || Magic != FileMagic || OutHeader.Version != FileVersion) return false;
+
+		Reader << Compression << OutHeader.UncompressedSize << OutHeader.CompressedSize << OutHeader.PayloadCrc;
+		Reader << OutHeader.Summary;
+		OutHeader.Compression = (ESaveCompression)Compression;
+		if (Reader.IsError()) return false;
+
+		const uint32 Crc = FCrc::MemCrc32(Bytes.GetData(), Reader.Tell());
+		uint32 HeaderCrc = 0;
+		Reader << HeaderCrc;
+		if (Reader.IsError() || HeaderCrc != Crc) return false;
+		OutPayloadOffset = Reader.Tell();
+
+		if (Compression > (uint8)ESaveCompression::LZ4 || OutHeader.UncompressedSize < 0 || OutHeader.CompressedSize < 0) return false;
+
+		return OutHeader.Compression == ESaveCompression::None
+			? OutHeader.UncompressedSize == OutHeader.CompressedSize
+			: OutHeader.UncompressedSize <= OutHeader.CompressedSize * MaxCompressionRatio;
+	}
+}
+
+static TAutoConsoleVariable<int32> CVarSaveCompression(
+	TEXT("FirstProyect2.SaveCompression"),
+	1,
+	TEXT("Compression of save slots and world snapshots written from now on. 0: none, 1: zlib, 2: LZ4"),
+	ECVF_Default);
+
+FArchive& operator<<(FArchive& Ar, FSaveSlotSummary& Summary)
+{
+	Ar << Summary.SlotName << Summary.Timestamp << Summary.MapName;
+	Ar << Summary.Health << Summary.MaxHealth << Summary.Coins << Summary.WeaponId;
+	return Ar;
+}
+
+ESaveCompression FSaveFileHeader::GetDefaultCompression()
+{
+	return (ESaveCompression)FMath::Clamp(CVarSaveCompression.GetValueOnAnyThread(), 0, (int32)ESaveCompression::LZ4);
+}
+
+void FSaveFileHeader::Write(const FSaveSlotSummary& Summary, const TArray<uint8>& Payload, ESaveCompression Compression, TArray<uint8>& OutBytes)
+{
+	TArray<uint8> Compressed;
+	const FName Format = SaveFile::GetFormatName(Compression);
+	if (!Format.IsNone())
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound(Format, Payload.Num());
+		Compressed.SetNumUninitialized(CompressedSize);
+
+		// Stored as is when compressing does not pay off
+		if (FCompression::CompressMemory(Format, Compressed.GetData(), CompressedSize, Payload.GetData(), Payload.Num()) && CompressedSize < Payload.Num())
+		{
+			Compressed.SetNum(CompressedSize, false);
+		}
+		else
+		{
+			Compression = ESaveCompression::None;
+		}
+	}
+	else
+	{
+		Compression = ESaveCompression::None;
+	}
+
+	const TArray<uint8>& Stored = Compression == ESaveCompression::None ? Payload : Compressed;
+
+	FMemoryWriter Writer(OutBytes);
+	uint32 Magic = SaveFile::FileMagic;
+	int32 Version = SaveFile::FileVersion;
+	uint8 Method = (uint8)Compression;
+	int32 UncompressedSize = Payload.Num();
+	int32 StoredSize = Stored.Num();
+	uint32 Crc = FCrc::MemCrc32(Stored.GetData(), Stored.Num());
+	FSaveSlotSummary SavedSummary = Summary;
+	Writer << Magic << Version << Method << UncompressedSize << StoredSize << Crc << SavedSummary;
+
+	uint32 HeaderCrc = FCrc::MemCrc32(OutBytes.GetData(), OutBytes.Num());
+	Writer << HeaderCrc;
+
+	OutBytes.Append(Stored);
+}
+
+bool FSaveFileHeader::ReadHeader(const TArray<uint8>& Bytes, FSaveFileHeader& OutHeader)
+{
+	int64 Offset = 0;
+	return SaveFile::ReadHeader(Bytes, OutHeader, Offset);
+}
+
+bool FSaveFileHeader::Read(const TArray<uint8>& Bytes, FSaveFileHeader& OutHeader, TArray<uint8>& OutPayload)
+{
+	int64 Offset = 0;
+	if (!SaveFile::ReadHeader(Bytes, OutHeader, Offset)) return false;
+	if (Offset + OutHeader.CompressedSize > Bytes.Num()) return false;
+
+	const uint8* Stored = Bytes.GetData() + Offset;
+	if (FCrc::MemCrc32(Stored, OutHeader.CompressedSize) != OutHeader.PayloadCrc) return false;
+
+	if (OutHeader.Compression == ESaveCompression::None)
+	{
+		OutPayload = TArray<uint8>(Stored, OutHeader.CompressedSize);
+		return true;
+	}
+
+	OutPayload.SetNumUninitialized(OutHeader.UncompressedSize);
+	return FCompression::UncompressMemory(SaveFile::GetFormatName(OutHeader.Compression), OutPayload.GetData(), OutHeader.UncompressedSize, Stored, OutHeader.CompressedSize);
+}
+
+bool FSaveFileHeader::HasHeader(const TArray<uint8>& Bytes)
+{
+	return Bytes.Num() >= (int32)sizeof(uint32) && *reinterpret_cast<const uint32*>(Bytes.GetData()) == SaveFile::FileMagic;
+}
+
+void FSaveSlotIndex::Save(TArray<uint8>& OutBytes)
+{
+	FMemoryWriter Writer(OutBytes);
+
+	uint32 Magic = SaveFile::IndexMagic;
+	int32 Version = SaveFile::IndexVersion;
+	Writer << Magic << Version << Slots;
+}
+
+bool FSaveSlotIndex::Load(const TArray<uint8>& Bytes)
+{
+	FMemoryReader Reader(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Reader << Magic << Version;
+	if (Magic != SaveFile::IndexMagic || Version != SaveFile::IndexVersion) return false;
+
+	Reader << Slots;
+	return !Reader.IsError();
+}
+
+void FSaveSlotIndex::Update(const FSaveSlotSummary& Summary)
+{
+	Slots.RemoveAll([&Summary](const FSaveSlotSummary& Slot) { return Slot.SlotName == Summary.SlotName; });
+	Slots.Insert(Summary, 0);
+}
+
+/**
+ * FirstProyect2.SaveFileBench [SizesMB...] (defaults to 1, 10 and 100)
+ * Builds a world snapshot of enemy-like records of about each size and writes it in the save file
+ * format with every compression, then reads it back: file size, encode (compress + CRC), disk
+ * write, disk read and decode (CRC + decompress) times. Ends with listing 1000 slots from an index.
+ */
+static void RunSaveFileBenchmark(const TArray<FString>& Args)
+{
+	TArray<int32> SizesMB;
+	for (const FString& Arg : Args)
+	{
+		SizesMB.Add(FMath::Max(FCString::Atoi(*Arg), 1));
+	}
+	if (SizesMB.Num() == 0)
+	{
+		SizesMB = { 1, 10, 100 };
+	}
+
+	const FString Path = FPaths::Combine(FPaths::ProfilingDir(), TEXT("SaveFileBench.sav"));
+	const ESaveCompression Compressions[] = { ESaveCompression::None, ESaveCompression::Zlib, ESaveCompression::LZ4 };
+	const TCHAR* CompressionNames[] = { TEXT("none"), TEXT("zlib"), TEXT("lz4") };
+
+	FSaveSlotSummary Summary;
+	Summary.SlotName = TEXT("Bench");
+	Summary.Timestamp = FDateTime::UtcNow();
+
+	for (const int32 SizeMB : SizesMB)
+	{
+		// Health, status and transform like an AEnemy record, on a coarse grid like a real level
+		FRandomStream Stream(1337);
+		FWorldSnapshot Snapshot;
+		TArray<uint8> Payload;
+		const int64 TargetBytes = int64(SizeMB) * 1024 * 1024;
+		int32 NumRecords = 0;
+		while (Payload.Num() < TargetBytes)
+		{
+			const int32 Batch = FMath::Max<int32>((TargetBytes - Payload.Num()) / 96, 1024);
+			for (int32 i = 0; i < Batch; i++, NumRecords++)
+			{
+				TArray<uint8>& Record = Snapshot.Records.Add(FString::Printf(TEXT("Level_%d:Enemy_C_%d"), NumRecords % 16, NumRecords));
+				FMemoryWriter Writer(Record);
+				float Health = Stream.FRand() < 0.7f ? 100.f : FMath::RoundToFloat(Stream.FRandRange(0.f, 100.f));
+				uint8 Status = (uint8)Stream.RandRange(0, 3);
+				FTransform Transform(FRotator(0.f, Stream.RandRange(0, 7) * 45.f, 0.f), FVector(Stream.RandRange(-400, 400) * 25.f, Stream.RandRange(-400, 400) * 25.f, 90.f));
+				Writer << Health << Status << Transform;
+			}
+			Payload.Reset();
+			Snapshot.Save(Payload);
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("SaveFileBench: %d records, %.2f MB snapshot"), NumRecords, Payload.Num() / (1024.0 * 1024.0));
+
+		for (int32 Method = 0; Method < UE_ARRAY_COUNT(Compressions); Method++)
+		{
+			double StartTime = FPlatformTime::Seconds();
+			TArray<uint8> FileBytes;
+			FSaveFileHeader::Write(Summary, Payload, Compressions[Method], FileBytes);
+			const double EncodeTime = FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			const bool bWritten = FFileHelper::SaveArrayToFile(FileBytes, *Path);
+			const double WriteTime = FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			TArray<uint8> ReadBytes;
+			const bool bRead = bWritten && FFileHelper::LoadFileToArray(ReadBytes, *Path);
+			const double ReadTime = FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			FSaveFileHeader Header;
+			TArray<uint8> Decoded;
+			const bool bDecoded = bRead && FSaveFileHeader::Read(ReadBytes, Header, Decoded);
+			const double DecodeTime = FPlatformTime::Seconds() - StartTime;
+
+			UE_LOG(LogTemp, Display, TEXT("  %-4s %8.2f MB (%5.1f%%)  encode %8.3f ms  write %8.3f ms  read %8.3f ms  decode %8.3f ms%s"),
+				CompressionNames[Method], FileBytes.Num() / (1024.0 * 1024.0), 100.0 * FileBytes.Num() / FMath::Max(Payload.Num(), 1),
+				EncodeTime * 1000.0, WriteTime * 1000.0, ReadTime * 1000.0, DecodeTime * 1000.0,
+				bDecoded && Decoded == Payload ? TEXT("") : TEXT("  MISMATCH"));
+		}
+	}
+
+	FSaveSlotIndex Index;
+	for (int32 i = 0; i < 1000; i++)
+	{
+		Summary.SlotName = FString::Printf(TEXT("Slot%04d"), i);
+		Summary.MapName = TEXT("SunTemple");
+		Summary.Health = 100.f;
+		Summary.MaxHealth = 100.f;
+		Summary.Coins = i;
+		Index.Update(Summary);
+	}
+	TArray<uint8> IndexBytes;
+	Index.Save(IndexBytes);
+	FFileHelper::SaveArrayToFile(IndexBytes, *Path);
+
+	const double StartTime = FPlatformTime::Seconds();
+	TArray<uint8> ReadIndexBytes;
+	FSaveSlotIndex ReadIndex;
+	const bool bListed = FFileHelper::LoadFileToArray(ReadIndexBytes, *Path) && ReadIndex.Load(ReadIndexBytes);
+	const double ListTime = FPlatformTime::Seconds() - StartTime;
+	UE_LOG(LogTemp, Display, TEXT("  slot index, %d slots in %d bytes: read + parse %8.3f ms%s"), ReadIndex.Slots.Num(), IndexBytes.Num(), ListTime * 1000.0, bListed ? TEXT("") : TEXT("  FAILED"));
+
+	IFileManager::Get().Delete(*Path);
+}
+
+static FAutoConsoleCommand SaveFileBenchCommand(
+	TEXT("FirstProyect2.SaveFileBench"),
+	TEXT("Benchmarks save file size and load time per compression. Args: [SizesMB...]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunSaveFileBenchmark));
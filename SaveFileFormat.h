@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SaveFileFormat.generated.h"
+
+/** What the pause menu shows for a slot, readable without loading the slot */
+USTRUCT(BlueprintType)
+struct FSaveSlotSummary
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	FString SlotName;
+
+	/** UTC */
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	FDateTime Timestamp;
+
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	FString MapName;
+
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	float Health = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	float MaxHealth = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	int32 Coins = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	FName WeaponId;
+
+	friend FArchive& operator<<(FArchive& Ar, FSaveSlotSummary& Summary);
+};
+
+enum class ESaveCompression : uint8
+{
+	None,
+	Zlib,
+	LZ4,
+};
+
+/**
+ * Save file layout: a small fixed header, the slot summary, then the payload compressed as a
+ * single block.
+ *
+ *   Magic "FPSG", Version, Compression, UncompressedSize, CompressedSize, PayloadCrc, Summary, HeaderCrc
+ *
+ * HeaderCrc covers everything before it, so a damaged size or summary is rejected before anything
+ * is allocated or shown in the slot list. PayloadCrc covers the compressed bytes, so a damaged
+ * payload is rejected before decompressing it.
+ */
+struct FSaveFileHeader
+{
+	int32 Version = 0;
+	ESaveCompression Compression = ESaveCompression::None;
+	int32 UncompressedSize = 0;
+	int32 CompressedSize = 0;
+	uint32 PayloadCrc = 0;
+
+	FSaveSlotSummary Summary;
+
+	/** Compression is picked by FirstProyect2.SaveCompression */
+	static ESaveCompression GetDefaultCompression();
+
+	static void Write(const FSaveSlotSummary& Summary, const TArray<uint8>& Payload, ESaveCompression Compression, TArray<uint8>& OutBytes);
+
+	/** Parses and checks the header, Bytes can be just the start of the file */
+	static bool ReadHeader(const TArray<uint8>& Bytes, FSaveFileHeader& OutHeader);
+
+	/** Checks the CRC and decompresses */
+	static bool Read(const TArray<uint8>& Bytes, FSaveFileHeader& OutHeader, TArray<uint8>& OutPayload);
+
+	/** False for files written before this format, which are a bare payload */
+	static bool HasHeader(const TArray<uint8>& Bytes);
+};
+
+/** Summaries of every slot, kept in its own small file so listing slots is one read */
+struct FSaveSlotIndex
+{
+	TArray<FSaveSlotSummary> Slots;
+
+	void Save(TArray<uint8>& OutBytes);
+	bool Load(const TArray<uint8>& Bytes);
+
+	/** Replaces the slot's summary, newest first */
+	void Update(const FSaveSlotSummary& Summary);
+};
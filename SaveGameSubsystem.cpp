@@ -0,0 +1,401 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SaveGameSubsystem.h"
+#include "FirstProyect2.h"
+#include "FirstSaveGame.h"
+#include "Kismet/GameplayStatics.h"
+#include "PlatformFeatures.h"
+#include "SaveGameSystem.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+namespace SaveGame
+{
+	/** Slot holding the FSaveSlotIndex, user 0 */
+	static const TCHAR* SlotIndexName = TEXT("SlotIndex");
+
+	/** Enough for the header and any summary, all the rebuild reads of each slot */
+	static const int64 HeaderReadSize = 1024;
+}
+
+DECLARE_CYCLE_STAT(TEXT("SaveGame Snapshot"), STAT_SaveGameSnapshot, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("SaveGame Worker IO"), STAT_SaveGameWorkerIO, STATGROUP_FirstProyect2);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Save Snapshot (ms)"), STAT_LastSaveSnapshotMs, STATGROUP_FirstProyect2);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Save Serialize (ms)"), STAT_LastSaveSerializeMs, STATGROUP_FirstProyect2);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Save IO (ms)"), STAT_LastSaveIOMs, STATGROUP_FirstProyect2);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Load IO (ms)"), STAT_LastLoadIOMs, STATGROUP_FirstProyect2);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Save Size (KB)"), STAT_LastSaveSizeKB, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Saves Coalesced"), STAT_SavesCoalesced, STATGROUP_FirstProyect2);
+
+USaveGameSubsystem::USaveGameSubsystem()
+{
+	bSlotIndexLoaded = false;
+	bSlotIndexDirty = false;
+	bSlotIndexWriteInFlight = false;
+}
+
+void USaveGameSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	NumWorkersBusy.Increment();
+
+	FThreadSafeCounter* WorkersBusy = &NumWorkersBusy;
+	TWeakObjectPtr<USaveGameSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, WorkersBusy]()
+	{
+		FSaveSlotIndex Loaded;
+		bool bRebuilt = false;
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SaveGameWorkerIO);
+
+			TArray<uint8> Bytes;
+			ISaveGameSystem* SaveSystem = IPlatformFeaturesModule::Get().GetSaveGameSystem();
+			const bool bRead = SaveSystem && SaveSystem->DoesSaveGameExist(SaveGame::SlotIndexName, 0) && SaveSystem->LoadGame(false, SaveGame::SlotIndexName, 0, Bytes);
+			if (!bRead || !Loaded.Load(Bytes))
+			{
+				Loaded = FSaveSlotIndex();
+				RebuildSlotIndex(Loaded);
+				bRebuilt = true;
+			}
+		}
+		WorkersBusy->Decrement();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Loaded = MoveTemp(Loaded), bRebuilt]() mutable
+		{
+			if (USaveGameSubsystem* Saves = WeakThis.Get())
+			{
+				Saves->OnSlotIndexLoaded(Loaded, bRebuilt);
+			}
+		});
+	});
+}
+
+void USaveGameSubsystem::Deinitialize()
+{
+	// Workers read snapshots kept alive by this object
+	while (NumWorkersBusy.GetValue() > 0)
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	if (bSlotIndexLoaded && bSlotIndexDirty)
+	{
+		TArray<uint8> Bytes;
+		SlotIndex.Save(Bytes);
+		if (ISaveGameSystem* SaveSystem = IPlatformFeaturesModule::Get().GetSaveGameSystem())
+		{
+			SaveSystem->SaveGame(false, SaveGame::SlotIndexName, 0, Bytes);
+		}
+	}
+
+	Slots.Reset();
+	Snapshots.Reset();
+	PendingSlotLists.Reset();
+
+	Super::Deinitialize();
+}
+
+void USaveGameSubsystem::SaveAsync(const FString& SlotName, int32 UserIndex, TFunctionRef<void(UFirstSaveGame&)> Fill, FOnAsyncSaveComplete OnComplete)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	UFirstSaveGame* Snapshot = nullptr;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SaveGameSnapshot);
+
+		Snapshot = NewObject<UFirstSaveGame>(this);
+		Snapshot->PlayerName = SlotName;
+		Snapshot->UserIndex = UserIndex;
+		Fill(*Snapshot);
+	}
+	Snapshots.Add(Snapshot);
+
+	SET_FLOAT_STAT(STAT_LastSaveSnapshotMs, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	FSlotWrites& Slot = Slots.FindOrAdd(SlotName);
+	if (Slot.InFlight)
+	{
+		if (Slot.Queued)
+		{
+			Snapshots.RemoveSingleSwap(Slot.Queued, false);
+			INC_DWORD_STAT(STAT_SavesCoalesced);
+		}
+		Slot.Queued = Snapshot;
+		Slot.QueuedCallbacks.Add(OnComplete);
+		return;
+	}
+
+	Slot.InFlight = Snapshot;
+	Slot.InFlightCallbacks.Add(OnComplete);
+	StartWrite(SlotName, Snapshot);
+}
+
+void USaveGameSubsystem::StartWrite(const FString& SlotName, UFirstSaveGame* Snapshot)
+{
+	NumWorkersBusy.Increment();
+
+	// Deinitialize waits for the counter, so it outlives every worker
+	FThreadSafeCounter* WorkersBusy = &NumWorkersBusy;
+	TWeakObjectPtr<USaveGameSubsystem> WeakThis(this);
+	const ESaveCompression Compression = FSaveFileHeader::GetDefaultCompression();
+	Async(EAsyncExecution::ThreadPool, [WeakThis, WorkersBusy, SlotName, Snapshot, Compression]()
+	{
+		bool bSuccess = false;
+		double SerializeSeconds = 0.0;
+		double WriteSeconds = 0.0;
+		FSaveSlotSummary Summary;
+		int32 FileSize = 0;
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SaveGameWorkerIO);
+
+			// Nothing else references the snapshot, reading it here is safe
+			double StartTime = FPlatformTime::Seconds();
+			TArray<uint8> Bytes;
+			const bool bSerialized = UGameplayStatics::SaveGameToMemory(Snapshot, Bytes);
+			Summary = MakeSummary(*Snapshot);
+
+			TArray<uint8> FileBytes;
+			FSaveFileHeader::Write(Summary, Bytes, Compression, FileBytes);
+			FileSize = FileBytes.Num();
+			SerializeSeconds = FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			ISaveGameSystem* SaveSystem = IPlatformFeaturesModule::Get().GetSaveGameSystem();
+			bSuccess = bSerialized && SaveSystem && SaveSystem->SaveGame(false, *SlotName, Snapshot->UserIndex, FileBytes);
+			WriteSeconds = FPlatformTime::Seconds() - StartTime;
+		}
+		WorkersBusy->Decrement();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, SlotName, bSuccess, SerializeSeconds, WriteSeconds, Summary, FileSize]()
+		{
+			SET_FLOAT_STAT(STAT_LastSaveSizeKB, FileSize / 1024.f);
+			if (USaveGameSubsystem* Saves = WeakThis.Get())
+			{
+				Saves->OnWriteFinished(SlotName, bSuccess, SerializeSeconds, WriteSeconds, Summary);
+			}
+		});
+	});
+}
+
+FSaveSlotSummary USaveGameSubsystem::MakeSummary(const UFirstSaveGame& SaveGame)
+{
+	FSaveSlotSummary Summary;
+	Summary.SlotName = SaveGame.PlayerName;
+	Summary.Timestamp = FDateTime::UtcNow();
+	Summary.MapName = SaveGame.MapName;
+	Summary.Health = SaveGame.CharacterStats.Health;
+	Summary.MaxHealth = SaveGame.CharacterStats.MaxHealth;
+	Summary.Coins = SaveGame.CharacterStats.Coins;
+	Summary.WeaponId = SaveGame.CharacterStats.WeaponId;
+	return Summary;
+}
+
+void USaveGameSubsystem::OnWriteFinished(FString SlotName, bool bSuccess, double SerializeSeconds, double WriteSeconds, const FSaveSlotSummary& Summary)
+{
+	SET_FLOAT_STAT(STAT_LastSaveSerializeMs, SerializeSeconds * 1000.0);
+	SET_FLOAT_STAT(STAT_LastSaveIOMs, WriteSeconds * 1000.0);
+
+	if (bSuccess)
+	{
+		SlotIndex.Update(Summary);
+		bSlotIndexDirty = true;
+		WriteSlotIndex();
+	}
+
+	FSlotWrites* Slot = Slots.Find(SlotName);
+	if (!Slot) return;
+
+	UE_LOG(LogTemp, Verbose, TEXT("SaveGame: %s %s, serialize %.3f ms, write %.3f ms"), *SlotName, bSuccess ? TEXT("saved") : TEXT("failed"), SerializeSeconds * 1000.0, WriteSeconds * 1000.0);
+	if (!bSuccess)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SaveGame: could not write slot %s"), *SlotName);
+	}
+
+	TArray<FOnAsyncSaveComplete> Callbacks = MoveTemp(Slot->InFlightCallbacks);
+	Snapshots.RemoveSingleSwap(Slot->InFlight, false);
+	Slot->InFlight = nullptr;
+
+	if (Slot->Queued)
+	{
+		Slot->InFlight = Slot->Queued;
+		Slot->InFlightCallbacks = MoveTemp(Slot->QueuedCallbacks);
+		Slot->Queued = nullptr;
+		StartWrite(SlotName, Slot->InFlight);
+	}
+	else
+	{
+		Slots.Remove(SlotName);
+	}
+
+	// Callbacks may save again, Slot is not touched past this point
+	for (FOnAsyncSaveComplete& Callback : Callbacks)
+	{
+		Callback.ExecuteIfBound(bSuccess);
+	}
+	OnSlotSaved.Broadcast(SlotName, bSuccess);
+}
+
+void USaveGameSubsystem::LoadAsync(const FString& SlotName, int32 UserIndex, FOnAsyncLoadComplete OnComplete)
+{
+	if (const FSlotWrites* Slot = Slots.Find(SlotName))
+	{
+		OnComplete.ExecuteIfBound(Slot->Queued ? Slot->Queued : Slot->InFlight);
+		return;
+	}
+
+	NumWorkersBusy.Increment();
+
+	FThreadSafeCounter* WorkersBusy = &NumWorkersBusy;
+	TWeakObjectPtr<USaveGameSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, WorkersBusy, SlotName, UserIndex, OnComplete]()
+	{
+		TArray<uint8> Bytes;
+		bool bRead = false;
+		const double StartTime = FPlatformTime::Seconds();
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SaveGameWorkerIO);
+
+			ISaveGameSystem* SaveSystem = IPlatformFeaturesModule::Get().GetSaveGameSystem();
+			bRead = SaveSystem && SaveSystem->DoesSaveGameExist(*SlotName, UserIndex) && SaveSystem->LoadGame(false, *SlotName, UserIndex, Bytes);
+
+			// Slots from before the header are the bare UFirstSaveGame bytes
+			if (bRead && FSaveFileHeader::HasHeader(Bytes))
+			{
+				FSaveFileHeader Header;
+				TArray<uint8> Payload;
+				bRead = FSaveFileHeader::Read(Bytes, Header, Payload);
+				Bytes = MoveTemp(Payload);
+				if (!bRead)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("SaveGame: slot %s is damaged"), *SlotName);
+				}
+			}
+		}
+		const double ReadSeconds = FPlatformTime::Seconds() - StartTime;
+		WorkersBusy->Decrement();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, bRead, Bytes = MoveTemp(Bytes), ReadSeconds, OnComplete]()
+		{
+			SET_FLOAT_STAT(STAT_LastLoadIOMs, ReadSeconds * 1000.0);
+
+			// Objects can only be created on the game thread
+			UFirstSaveGame* Loaded = bRead && WeakThis.IsValid() ? Cast<UFirstSaveGame>(UGameplayStatics::LoadGameFromMemory(Bytes)) : nullptr;
+			OnComplete.ExecuteIfBound(Loaded);
+		});
+	});
+}
+
+void USaveGameSubsystem::ListSlotsAsync(FOnSlotListReady OnReady)
+{
+	if (bSlotIndexLoaded)
+	{
+		OnReady.ExecuteIfBound(SlotIndex.Slots);
+		return;
+	}
+	PendingSlotLists.Add(OnReady);
+}
+
+void USaveGameSubsystem::OnSlotIndexLoaded(FSaveSlotIndex& Loaded, bool bRebuilt)
+{
+	// Saves that finished while the index was read are newer than what the file says
+	for (FSaveSlotSummary& Summary : Loaded.Slots)
+	{
+		if (!SlotIndex.Slots.ContainsByPredicate([&Summary](const FSaveSlotSummary& Slot) { return Slot.SlotName == Summary.SlotName; }))
+		{
+			SlotIndex.Slots.Add(MoveTemp(Summary));
+		}
+	}
+	bSlotIndexLoaded = true;
+	bSlotIndexDirty |= bRebuilt && SlotIndex.Slots.Num() > 0;
+
+	TArray<FOnSlotListReady> Lists = MoveTemp(PendingSlotLists);
+	for (FOnSlotListReady& List : Lists)
+	{
+		List.ExecuteIfBound(SlotIndex.Slots);
+	}
+
+	WriteSlotIndex();
+}
+
+void USaveGameSubsystem::WriteSlotIndex()
+{
+	// A write before the index was read would drop every slot it lists
+	if (!bSlotIndexLoaded || !bSlotIndexDirty || bSlotIndexWriteInFlight) return;
+
+	bSlotIndexDirty = false;
+	bSlotIndexWriteInFlight = true;
+
+	TArray<uint8> Bytes;
+	SlotIndex.Save(Bytes);
+
+	NumWorkersBusy.Increment();
+
+	FThreadSafeCounter* WorkersBusy = &NumWorkersBusy;
+	TWeakObjectPtr<USaveGameSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, WorkersBusy, Bytes = MoveTemp(Bytes)]()
+	{
+		bool bSuccess = false;
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SaveGameWorkerIO);
+
+			ISaveGameSystem* SaveSystem = IPlatformFeaturesModule::Get().GetSaveGameSystem();
+			bSuccess = SaveSystem && SaveSystem->SaveGame(false, SaveGame::SlotIndexName, 0, Bytes);
+		}
+		WorkersBusy->Decrement();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, bSuccess]()
+		{
+			USaveGameSubsystem* Saves = WeakThis.Get();
+			if (!Saves) return;
+
+			Saves->bSlotIndexWriteInFlight = false;
+			Saves->bSlotIndexDirty |= !bSuccess;
+			if (!bSuccess)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("SaveGame: could not write the slot index"));
+				return;
+			}
+			Saves->WriteSlotIndex();
+		});
+	});
+}
+
+void USaveGameSubsystem::RebuildSlotIndex(FSaveSlotIndex& OutIndex)
+{
+	// Only the generic save system keeps slots as Saved/SaveGames/<Slot>.sav, elsewhere the index starts empty
+	const FString SaveDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SaveGames"));
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *FPaths::Combine(SaveDir, TEXT("*.sav")), true, false);
+
+	for (const FString& File : Files)
+	{
+		const FString SlotName = FPaths::GetBaseFilename(File);
+		if (SlotName == SaveGame::SlotIndexName) continue;
+
+		const FString Path = FPaths::Combine(SaveDir, File);
+		TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+		if (!Reader) continue;
+
+		TArray<uint8> Head;
+		Head.SetNumUninitialized(FMath::Min(Reader->TotalSize(), SaveGame::HeaderReadSize));
+		Reader->Serialize(Head.GetData(), Head.Num());
+
+		FSaveFileHeader Header;
+		FSaveSlotSummary& Summary = OutIndex.Slots.AddDefaulted_GetRef();
+		if (FSaveFileHeader::ReadHeader(Head, Header))
+		{
+			Summary = Header.Summary;
+		}
+		else
+		{
+			Summary.Timestamp = IFileManager::Get().GetTimeStamp(*Path);
+		}
+		Summary.SlotName = SlotName;
+	}
+
+	OutIndex.Slots.Sort([](const FSaveSlotSummary& A, const FSaveSlotSummary& B) { return A.Timestamp > B.Timestamp; });
+	UE_LOG(LogTemp, Display, TEXT("SaveGame: rebuilt the slot index from %d slot files"), OutIndex.Slots.Num());
+}
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "SaveFileFormat.h"
+#include "SaveGameSubsystem.generated.h"
+
+class UFirstSaveGame;
+
+DECLARE_DELEGATE_OneParam(FOnAsyncSaveComplete, bool /* bSuccess */);
+DECLARE_DELEGATE_OneParam(FOnAsyncLoadComplete, UFirstSaveGame* /* nullptr when the slot could not be read */);
+DECLARE_DELEGATE_OneParam(FOnSlotListReady, const TArray<FSaveSlotSummary>& /* newest first */);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSaveGameSlotSaved, const FString&, SlotName, bool, bSuccess);
+
+/**
+ * Saves and loads UFirstSaveGame slots without blocking the game thread. A save fills a fresh
+ * snapshot object on the game thread, then serializes and writes it on a worker. A save to a slot
+ * that is still being written replaces any save already waiting for that slot, so at most one
+ * write per slot is in flight and one is queued; every caller's delegate fires with the result of
+ * the write that covered it.
+ *
+ * Slots are written as an FSaveFileHeader with a CRC and the compressed UFirstSaveGame bytes, and
+ * every successful save updates the summary in the SlotIndex slot, so listing slots reads a single
+ * small file. Slots written before the header existed still load.
+ */
+UCLASS()
+class FIRSTPROYECT2_API USaveGameSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	USaveGameSubsystem();
+
+	/** Starts reading the slot index */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Waits for writes still in flight */
+	virtual void Deinitialize() override;
+
+	/** Fill runs right away on the game thread and is what the snapshot stat measures */
+	void SaveAsync(const FString& SlotName, int32 UserIndex, TFunctionRef<void(UFirstSaveGame&)> Fill, FOnAsyncSaveComplete OnComplete = FOnAsyncSaveComplete());
+
+	/** Reads on a worker; a slot with a save in flight or queued completes at once with the newest snapshot */
+	void LoadAsync(const FString& SlotName, int32 UserIndex, FOnAsyncLoadComplete OnComplete);
+
+	bool IsSaving(const FString& SlotName) const { return Slots.Contains(SlotName); }
+
+	/** Completes at once when the slot index has been read, else once it has */
+	void ListSlotsAsync(FOnSlotListReady OnReady);
+
+	/** Newest first, incomplete until IsSlotIndexReady */
+	UFUNCTION(BlueprintPure, Category = "SaveGame")
+	const TArray<FSaveSlotSummary>& GetSlotSummaries() const { return SlotIndex.Slots; }
+
+	UFUNCTION(BlueprintPure, Category = "SaveGame")
+	bool IsSlotIndexReady() const { return bSlotIndexLoaded; }
+
+	UPROPERTY(BlueprintAssignable, Category = "SaveGame")
+	FOnSaveGameSlotSaved OnSlotSaved;
+
+private:
+
+	struct FSlotWrites
+	{
+		UFirstSaveGame* InFlight = nullptr;
+		UFirstSaveGame* Queued = nullptr;
+
+		TArray<FOnAsyncSaveComplete> InFlightCallbacks;
+		TArray<FOnAsyncSaveComplete> QueuedCallbacks;
+	};
+
+	void StartWrite(const FString& SlotName, UFirstSaveGame* Snapshot);
+
+	void OnWriteFinished(FString SlotName, bool bSuccess, double SerializeSeconds, double WriteSeconds, const FSaveSlotSummary& Summary);
+
+	static FSaveSlotSummary MakeSummary(const UFirstSaveGame& SaveGame);
+
+	void OnSlotIndexLoaded(FSaveSlotIndex& Loaded, bool bRebuilt);
+
+	void WriteSlotIndex();
+
+	/** Reads the header of every slot file, for a missing or damaged index. Runs on a worker */
+	static void RebuildSlotIndex(FSaveSlotIndex& OutIndex);
+
+	TMap<FString, FSlotWrites> Slots;
+
+	/** Keeps every snapshot in flight or queued alive */
+	UPROPERTY()
+	TArray<UFirstSaveGame*> Snapshots;
+
+	/** Worker tasks that still read a snapshot or write a file */
+	FThreadSafeCounter NumWorkersBusy;
+
+	FSaveSlotIndex SlotIndex;
+	bool bSlotIndexLoaded;
+
+	/** SlotIndex has summaries the file does not */
+	bool bSlotIndexDirty;
+	bool bSlotIndexWriteInFlight;
+
+	TArray<FOnSlotListReady> PendingSlotLists;
+};
@@ -0,0 +1,6 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SaveableActor.h"
+
+// Add default functionality here for any ISaveableActor functions that are not pure virtual.
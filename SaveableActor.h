@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "SaveableActor.generated.h"
+
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class USaveableActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Actors whose state UWorldStateSubsystem keeps in the world snapshot. Only level placed actors and
+ * the player are recorded; everything spawned at runtime is the spawn volumes' business.
+ */
+class FIRSTPROYECT2_API ISaveableActor
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	 * Writes the actor's state when saving and applies it when loading. The bytes are compared to
+	 * find what changed between autosaves, so write the same bytes for the same state.
+	 */
+	virtual void SerializeSaveState(FArchive& Ar) = 0;
+};
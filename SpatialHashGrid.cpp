@@ -0,0 +1,354 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SpatialHashGrid.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+FSpatialHashGrid::FSpatialHashGrid(float InCellSize)
+{
+	Reset(InCellSize);
+}
+
+void FSpatialHashGrid::Reset(float InCellSize)
+{
+	CellSize = FMath::Max(InCellSize, 1.f);
+	InvCellSize = 1.f / CellSize;
+	NumEntries = 0;
+
+	Entries.Reset();
+	Cells.Reset();
+}
+
+void FSpatialHashGrid::Add(int32 Id, const FVector& Location)
+{
+	check(Id >= 0);
+
+	if (Id >= Entries.Num())
+	{
+		const int32 OldNum = Entries.Num();
+		Entries.SetNumUninitialized(Id + 1);
+		for (int32 i = OldNum; i < Entries.Num(); i++)
+		{
+			Entries[i].IndexInCell = INDEX_NONE;
+		}
+	}
+
+	FEntry& Entry = Entries[Id];
+	if (Entry.IndexInCell != INDEX_NONE)
+	{
+		Update(Id, Location);
+		return;
+	}
+
+	Entry.Location = Location;
+	Entry.Cell = CellOf(Location);
+	AddToCell(Id, Entry);
+	NumEntries++;
+}
+
+void FSpatialHashGrid::Update(int32 Id, const FVector& Location)
+{
+	if (!Contains(Id)) return;
+
+	FEntry& Entry = Entries[Id];
+	Entry.Location = Location;
+
+	const FIntPoint NewCell = CellOf(Location);
+	if (NewCell != Entry.Cell)
+	{
+		RemoveFromCell(Entry);
+		Entry.Cell = NewCell;
+		AddToCell(Id, Entry);
+	}
+}
+
+void FSpatialHashGrid::Remove(int32 Id)
+{
+	if (!Contains(Id)) return;
+
+	FEntry& Entry = Entries[Id];
+	RemoveFromCell(Entry);
+	Entry.IndexInCell = INDEX_NONE;
+	NumEntries--;
+}
+
+bool FSpatialHashGrid::Contains(int32 Id) const
+{
+	return Entries.IsValidIndex(Id) && Entries[Id].IndexInCell != INDEX_NONE;
+}
+
+FVector FSpatialHashGrid::GetLocation(int32 Id) const
+{
+	return Contains(Id) ? Entries[Id].Location : FVector::ZeroVector;
+}
+
+void FSpatialHashGrid::AddToCell(int32 Id, FEntry& Entry)
+{
+	TArray<int32>& Bucket = Cells.FindOrAdd(Entry.Cell);
+	Entry.IndexInCell = Bucket.Add(Id);
+}
+
+void FSpatialHashGrid::RemoveFromCell(const FEntry& Entry)
+{
+	TArray<int32>* Bucket = Cells.Find(Entry.Cell);
+	check(Bucket && Bucket->IsValidIndex(Entry.IndexInCell));
+
+	Bucket->RemoveAtSwap(Entry.IndexInCell, 1, false);
+	if (Bucket->IsValidIndex(Entry.IndexInCell))
+	{
+		// The last id in the bucket was swapped into our slot
+		Entries[(*Bucket)[Entry.IndexInCell]].IndexInCell = Entry.IndexInCell;
+	}
+	else if (Bucket->Num() == 0)
+	{
+		Cells.Remove(Entry.Cell);
+	}
+}
+
+void FSpatialHashGrid::QueryRadius(const FVector& Origin, float Radius, TArray<int32>& OutIds) const
+{
+	QueryRadius(Origin, Radius, OutIds, [](int32) { return true; });
+}
+
+void FSpatialHashGrid::QueryRadius(const FVector& Origin, float Radius, TArray<int32>& OutIds, TFunctionRef<bool(int32)> Filter) const
+{
+	if (NumEntries == 0 || Radius < 0.f) return;
+
+	const float RadiusSq = FMath::Square(Radius);
+	const FIntPoint Min = CellOf(Origin - FVector(Radius));
+	const FIntPoint Max = CellOf(Origin + FVector(Radius));
+
+	const int64 NumCellsInRange = int64(Max.X - Min.X + 1) * int64(Max.Y - Min.Y + 1);
+	if (NumCellsInRange > Cells.Num())
+	{
+		// Sparse grid, walking the occupied buckets is cheaper than probing empty cells
+		for (const TPair<FIntPoint, TArray<int32>>& Pair : Cells)
+		{
+			const FIntPoint& Cell = Pair.Key;
+			if (Cell.X < Min.X || Cell.X > Max.X || Cell.Y < Min.Y || Cell.Y > Max.Y) continue;
+
+			for (int32 Id : Pair.Value)
+			{
+				if (FVector::DistSquared(Entries[Id].Location, Origin) <= RadiusSq && Filter(Id))
+				{
+					OutIds.Add(Id);
+				}
+			}
+		}
+		return;
+	}
+
+	for (int32 X = Min.X; X <= Max.X; X++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			const TArray<int32>* Bucket = Cells.Find(FIntPoint(X, Y));
+			if (!Bucket) continue;
+
+			for (int32 Id : *Bucket)
+			{
+				if (FVector::DistSquared(Entries[Id].Location, Origin) <= RadiusSq && Filter(Id))
+				{
+					OutIds.Add(Id);
+				}
+			}
+		}
+	}
+}
+
+void FSpatialHashGrid::FindKNearest(const FVector& Origin, float MaxRadius, int32 K, TArray<int32>& OutIds, TFunctionRef<bool(int32)> Filter) const
+{
+	OutIds.Reset();
+	if (K <= 0 || NumEntries == 0 || MaxRadius < 0.f) return;
+
+	const FIntPoint Center = CellOf(Origin);
+	const float MaxRadiusSq = FMath::Square(MaxRadius);
+	const int32 MaxRing = FMath::CeilToInt(MaxRadius * InvCellSize);
+
+	TArray<TPair<float, int32>, TInlineAllocator<32>> Candidates;
+
+	auto VisitCell = [&](int32 X, int32 Y)
+	{
+		const TArray<int32>* Bucket = Cells.Find(FIntPoint(X, Y));
+		if (!Bucket) return;
+
+		for (int32 Id : *Bucket)
+		{
+			const float DistSq = FVector::DistSquared(Entries[Id].Location, Origin);
+			if (DistSq <= MaxRadiusSq && Filter(Id))
+			{
+				Candidates.Emplace(DistSq, Id);
+			}
+		}
+	};
+
+	auto ByDistance = [](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; };
+
+	for (int32 Ring = 0; Ring <= MaxRing; Ring++)
+	{
+		if (Ring == 0)
+		{
+			VisitCell(Center.X, Center.Y);
+		}
+		else
+		{
+			for (int32 X = -Ring; X <= Ring; X++)
+			{
+				VisitCell(Center.X + X, Center.Y - Ring);
+				VisitCell(Center.X + X, Center.Y + Ring);
+			}
+			for (int32 Y = -Ring + 1; Y <= Ring - 1; Y++)
+			{
+				VisitCell(Center.X - Ring, Center.Y + Y);
+				VisitCell(Center.X + Ring, Center.Y + Y);
+			}
+		}
+
+		if (Candidates.Num() >= K)
+		{
+			// Every unvisited cell is at least Ring cells away, so once the Kth best is closer than that we are done
+			Candidates.Sort(ByDistance);
+			Candidates.SetNum(K, false);
+			if (Candidates.Last().Key <= FMath::Square(Ring * CellSize)) break;
+		}
+	}
+
+	Candidates.Sort(ByDistance);
+	const int32 NumResults = FMath::Min(K, Candidates.Num());
+	OutIds.Reserve(NumResults);
+	for (int32 i = 0; i < NumResults; i++)
+	{
+		OutIds.Add(Candidates[i].Value);
+	}
+}
+
+int32 FSpatialHashGrid::FindNearest(const FVector& Origin, float MaxRadius, TFunctionRef<bool(int32)> Filter) const
+{
+	TArray<int32> Nearest;
+	FindKNearest(Origin, MaxRadius, 1, Nearest, Filter);
+
+	return Nearest.Num() > 0 ? Nearest[0] : INDEX_NONE;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpatialHashGridTest, "FirstProyect2.SpatialHashGrid", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Random inserts, moves and removes, with every radius and k-nearest query checked against a
+ * brute-force scan of the same points. Points spread over several cells and heights so the 2D
+ * bucketing and the 3D distances are both exercised.
+ */
+bool FSpatialHashGridTest::RunTest(const FString& Parameters)
+{
+	const int32 NumIds = 2000;
+	const int32 NumRounds = 20;
+	const int32 NumQueries = 50;
+	const float HalfExtent = 5000.f;
+
+	FRandomStream Stream(1337);
+	FSpatialHashGrid Grid(500.f);
+
+	TArray<FVector> Locations;
+	TArray<bool> Present;
+	Locations.SetNumZeroed(NumIds);
+	Present.SetNumZeroed(NumIds);
+
+	auto RandomLocation = [&Stream, HalfExtent]()
+	{
+		return FVector(Stream.FRandRange(-HalfExtent, HalfExtent), Stream.FRandRange(-HalfExtent, HalfExtent), Stream.FRandRange(-300.f, 300.f));
+	};
+
+	for (int32 Round = 0; Round < NumRounds; Round++)
+	{
+		for (int32 Id = 0; Id < NumIds; Id++)
+		{
+			const float Roll = Stream.FRand();
+			if (!Present[Id] && Roll < 0.5f)
+			{
+				Locations[Id] = RandomLocation();
+				Grid.Add(Id, Locations[Id]);
+				Present[Id] = true;
+			}
+			else if (Present[Id] && Roll < 0.1f)
+			{
+				Grid.Remove(Id);
+				Present[Id] = false;
+			}
+			else if (Present[Id] && Roll < 0.6f)
+			{
+				// Mix of moves inside a cell and jumps across the map
+				Locations[Id] = Roll < 0.35f ? Locations[Id] + FVector(Stream.FRandRange(-100.f, 100.f), Stream.FRandRange(-100.f, 100.f), 0.f) : RandomLocation();
+				Grid.Update(Id, Locations[Id]);
+			}
+		}
+
+		int32 NumPresent = 0;
+		for (int32 Id = 0; Id < NumIds; Id++)
+		{
+			NumPresent += Present[Id] ? 1 : 0;
+			if (Grid.Contains(Id) != Present[Id])
+			{
+				AddError(FString::Printf(TEXT("Round %d: Contains(%d) is %d, expected %d"), Round, Id, Grid.Contains(Id), Present[Id]));
+				return false;
+			}
+		}
+		TestEqual(TEXT("Num"), Grid.Num(), NumPresent);
+
+		for (int32 Query = 0; Query < NumQueries; Query++)
+		{
+			const FVector Origin = RandomLocation();
+			const float Radius = Stream.FRandRange(0.f, 1500.f);
+			const int32 K = Stream.RandRange(1, 16);
+
+			TArray<TPair<float, int32>> Expected;
+			for (int32 Id = 0; Id < NumIds; Id++)
+			{
+				const float DistSq = FVector::DistSquared(Locations[Id], Origin);
+				if (Present[Id] && DistSq <= Radius * Radius)
+				{
+					Expected.Emplace(DistSq, Id);
+				}
+			}
+			Expected.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+
+			TArray<int32> InRadius;
+			Grid.QueryRadius(Origin, Radius, InRadius);
+			InRadius.Sort();
+			TArray<int32> ExpectedInRadius;
+			for (const TPair<float, int32>& Pair : Expected)
+			{
+				ExpectedInRadius.Add(Pair.Value);
+			}
+			ExpectedInRadius.Sort();
+			if (InRadius != ExpectedInRadius)
+			{
+				AddError(FString::Printf(TEXT("Round %d: QueryRadius found %d ids, brute force %d"), Round, InRadius.Num(), ExpectedInRadius.Num()));
+				return false;
+			}
+
+			// Ties may come back in either order, so the distances are compared instead of the ids
+			TArray<int32> Nearest;
+			Grid.FindKNearest(Origin, Radius, K, Nearest, [](int32) { return true; });
+			const int32 NumExpected = FMath::Min(K, Expected.Num());
+			if (Nearest.Num() != NumExpected)
+			{
+				AddError(FString::Printf(TEXT("Round %d: FindKNearest returned %d ids, expected %d"), Round, Nearest.Num(), NumExpected));
+				return false;
+			}
+			for (int32 i = 0; i < NumExpected; i++)
+			{
+				if (!FMath::IsNearlyEqual(FVector::DistSquared(Locations[Nearest[i]], Origin), Expected[i].Key, 1.f))
+				{
+					AddError(FString::Printf(TEXT("Round %d: FindKNearest result %d is id %d, not the %dth nearest"), Round, i, Nearest[i], i + 1));
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif
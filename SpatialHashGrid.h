@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform 2D grid hash of points keyed by caller supplied integer ids.
+ * Cells are bucketed on X/Y only, distances are measured in full 3D.
+ * Add, Update and Remove are O(1); Update only touches the buckets when the point changes cell.
+ */
+struct FIRSTPROYECT2_API FSpatialHashGrid
+{
+public:
+
+	explicit FSpatialHashGrid(float InCellSize = 500.f);
+
+	/** Drops every entry and changes the cell size */
+	void Reset(float InCellSize);
+
+	void Add(int32 Id, const FVector& Location);
+
+	void Update(int32 Id, const FVector& Location);
+
+	void Remove(int32 Id);
+
+	bool Contains(int32 Id) const;
+
+	FVector GetLocation(int32 Id) const;
+
+	/** Appends every id within Radius of Origin that passes Filter (if bound) */
+	void QueryRadius(const FVector& Origin, float Radius, TArray<int32>& OutIds, TFunctionRef<bool(int32)> Filter) const;
+	void QueryRadius(const FVector& Origin, float Radius, TArray<int32>& OutIds) const;
+
+	/** Fills OutIds with up to K ids sorted by distance, searching no further than MaxRadius */
+	void FindKNearest(const FVector& Origin, float MaxRadius, int32 K, TArray<int32>& OutIds, TFunctionRef<bool(int32)> Filter) const;
+
+	/** Returns INDEX_NONE when nothing within MaxRadius passes Filter */
+	int32 FindNearest(const FVector& Origin, float MaxRadius, TFunctionRef<bool(int32)> Filter) const;
+
+	FORCEINLINE float GetCellSize() const { return CellSize; }
+	FORCEINLINE int32 Num() const { return NumEntries; }
+
+private:
+
+	struct FEntry
+	{
+		FVector Location;
+		FIntPoint Cell;
+		int32 IndexInCell;
+	};
+
+	FORCEINLINE FIntPoint CellOf(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X * InvCellSize), FMath::FloorToInt(Location.Y * InvCellSize));
+	}
+
+	void AddToCell(int32 Id, FEntry& Entry);
+	void RemoveFromCell(const FEntry& Entry);
+
+	float CellSize;
+	float InvCellSize;
+	int32 NumEntries;
+
+	/** Indexed by id, IndexInCell == INDEX_NONE marks a free slot */
+	TArray<FEntry> Entries;
+
+	TMap<FIntPoint, TArray<int32>> Cells;
+};
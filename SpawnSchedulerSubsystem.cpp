@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SpawnSchedulerSubsystem.h"
+#include "FirstProyect2.h"
+#include "SpawnVolume.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Scheduler"), STAT_SpawnScheduler, STATGROUP_FirstProyect2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawn Queue Depth"), STAT_SpawnQueueDepth, STATGROUP_FirstProyect2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawns This Frame"), STAT_SpawnsThisFrame, STATGROUP_FirstProyect2);
+
+static TAutoConsoleVariable<int32> CVarSpawnBudgetUs(
+	TEXT("FirstProyect2.SpawnBudgetUs"),
+	1500,
+	TEXT("Microseconds per frame the spawn scheduler may spend spawning queued actors."),
+	ECVF_Default);
+
+namespace SpawnScheduler
+{
+	struct FClosestFirst
+	{
+		template<typename RequestType>
+		bool operator()(const RequestType& A, const RequestType& B) const
+		{
+			return A.DistanceSq < B.DistanceSq || (A.DistanceSq == B.DistanceSq && A.Sequence < B.Sequence);
+		}
+	};
+}
+
+USpawnSchedulerSubsystem::USpawnSchedulerSubsystem()
+{
+	NextSequence = 0;
+}
+
+void USpawnSchedulerSubsystem::Deinitialize()
+{
+	Queue.Reset();
+
+	Super::Deinitialize();
+}
+
+ETickableTickType USpawnSchedulerSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId USpawnSchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpawnSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+float USpawnSchedulerSubsystem::DistanceSqToNearestPlayer(const FVector& Location) const
+{
+	float DistanceSq = BIG_NUMBER;
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		DistanceSq = FMath::Min(DistanceSq, FVector::DistSquared(Location, PlayerLocation));
+	}
+	return DistanceSq;
+}
+
+void USpawnSchedulerSubsystem::Enqueue(ASpawnVolume* Volume, UClass* Class, const FVector& Location)
+{
+	FSpawnRequest Request;
+	Request.Volume = Volume;
+	Request.Class = Class;
+	Request.Location = Location;
+	Request.Sequence = NextSequence++;
+	Request.DistanceSq = DistanceSqToNearestPlayer(Location);
+
+	Queue.HeapPush(Request, SpawnScheduler::FClosestFirst());
+
+	SET_DWORD_STAT(STAT_SpawnQueueDepth, Queue.Num());
+}
+
+void USpawnSchedulerSubsystem::UpdatePriorities()
+{
+	PlayerLocations.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		if (Pawn)
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+
+	for (FSpawnRequest& Request : Queue)
+	{
+		Request.DistanceSq = DistanceSqToNearestPlayer(Request.Location);
+	}
+	Queue.Heapify(SpawnScheduler::FClosestFirst());
+}
+
+void USpawnSchedulerSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnScheduler);
+
+	UpdatePriorities();
+
+	const double Budget = FMath::Max(CVarSpawnBudgetUs.GetValueOnGameThread(), 0) / 1000000.0;
+	const double StartTime = FPlatformTime::Seconds();
+	int32 NumSpawned = 0;
+
+	while (Queue.Num() > 0)
+	{
+		// Popped before spawning, the spawn or a wave delegate may queue more requests
+		FSpawnRequest Request;
+		Queue.HeapPop(Request, SpawnScheduler::FClosestFirst(), false);
+
+		ASpawnVolume* Volume = Request.Volume.Get();
+		UClass* Class = Request.Class.Get();
+		if (!Volume) continue;
+
+		const bool bSpawned = Class && Volume->SpawnImmediate(Class, Request.Location) != nullptr;
+		NumSpawned += bSpawned ? 1 : 0;
+		Volume->OnScheduledSpawnFinished(bSpawned);
+
+		if (FPlatformTime::Seconds() - StartTime >= Budget) break;
+	}
+
+	SET_DWORD_STAT(STAT_SpawnQueueDepth, Queue.Num());
+	SET_DWORD_STAT(STAT_SpawnsThisFrame, NumSpawned);
+}
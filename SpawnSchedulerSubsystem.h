@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SpawnSchedulerSubsystem.generated.h"
+
+/**
+ * Queue of spawn requests from every ASpawnVolume, drained closest-to-a-player first within a
+ * per-frame time budget (FirstProyect2.SpawnBudgetUs). At least one request is spawned per frame
+ * so a single expensive actor cannot stall the queue.
+ */
+UCLASS()
+class FIRSTPROYECT2_API USpawnSchedulerSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	USpawnSchedulerSubsystem();
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return Queue.Num() > 0; }
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** Volume->SpawnImmediate(Class, Location) runs on a later frame, or this one if budget is left */
+	void Enqueue(class ASpawnVolume* Volume, UClass* Class, const FVector& Location);
+
+	FORCEINLINE int32 NumPending() const { return Queue.Num(); }
+
+private:
+
+	struct FSpawnRequest
+	{
+		TWeakObjectPtr<ASpawnVolume> Volume;
+		TWeakObjectPtr<UClass> Class;
+		FVector Location;
+
+		/** Enqueue order, ties on distance spawn first come first served */
+		uint32 Sequence;
+		float DistanceSq;
+	};
+
+	/** Re-scores every request against the current player positions and restores the heap */
+	void UpdatePriorities();
+
+	float DistanceSqToNearestPlayer(const FVector& Location) const;
+
+	/** Binary heap, closest request on top */
+	TArray<FSpawnRequest> Queue;
+
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+
+	uint32 NextSequence;
+};
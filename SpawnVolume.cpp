@@ -8,6 +8,9 @@
 #include "Critter.h"
 #include "Enemy.h"
 #include "AIController.h"
+#include "ActorPoolSubsystem.h"
+#include "SpawnSchedulerSubsystem.h"
+#include "RandomStreamSubsystem.h"
 
 // Sets default values
 ASpawnVolume::ASpawnVolume()
@@ -17,6 +20,13 @@ ASpawnVolume::ASpawnVolume()
 
 	SpawningBox = CreateDefaultSubobject<UBoxComponent>(TEXT("SpawningBox"));
 
+	bOverrideNavigationMode = false;
+	NavigationMode = EEnemyNavigationMode::ENM_PathFollowing;
+
+	bTimeSliceSpawns = true;
+	PendingSpawns = 0;
+	WaveSpawnCount = 0;
+
 
 
 }
@@ -34,6 +44,14 @@ void ASpawnVolume::BeginPlay()
 		SpawnArray.Add(Actor_4);
 		SpawnArray.Add(Actor_5);
 	}
+
+	if (UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>())
+	{
+		for (const TPair<TSubclassOf<AActor>, int32>& Prewarm : PoolPrewarmCounts)
+		{
+			Pool->Prewarm(Prewarm.Key, Prewarm.Value, GetActorTransform());
+		}
+	}
 	
 }
 
@@ -50,7 +68,11 @@ FVector ASpawnVolume::GetSpawnPoint()
 	FVector Extent = SpawningBox->GetScaledBoxExtent();
 	FVector Origin = SpawningBox->GetComponentLocation();
 
-	FVector Point = UKismetMathLibrary::RandomPointInBoundingBox(Origin, Extent);
+	FRandomStream& Stream = URandomStreamSubsystem::GetStream(this, TEXT("SpawnPoint"));
+	FVector Point;
+	Point.X = Stream.FRandRange(Origin.X - Extent.X, Origin.X + Extent.X);
+	Point.Y = Stream.FRandRange(Origin.Y - Extent.Y, Origin.Y + Extent.Y);
+	Point.Z = Stream.FRandRange(Origin.Z - Extent.Z, Origin.Z + Extent.Z);
 
 	return Point;
 }
@@ -61,25 +83,67 @@ void ASpawnVolume::SpawnOurActor_Implementation(UClass* ToSpawn, const FVector&
 {
 	if (ToSpawn)
 	{
-		UWorld* World = GetWorld();
-		FActorSpawnParameters SpawnParams;
+		USpawnSchedulerSubsystem* Scheduler = GetWorld() ? GetWorld()->GetSubsystem<USpawnSchedulerSubsystem>() : nullptr;
+		if (bTimeSliceSpawns && Scheduler)
+		{
+			PendingSpawns++;
+			Scheduler->Enqueue(this, ToSpawn, Location);
+		}
+		else
+		{
+			SpawnImmediate(ToSpawn, Location);
+		}
+	}
+}
+
+AActor* ASpawnVolume::SpawnImmediate(UClass* ToSpawn, const FVector& Location)
+{
+	UWorld* World = GetWorld();
+	if (!ToSpawn || !World) return nullptr;
+
+	FActorSpawnParameters SpawnParams;
+
+	UActorPoolSubsystem* Pool = World->GetSubsystem<UActorPoolSubsystem>();
+	AActor* Actor = Pool ? Pool->AcquireActor(ToSpawn, FTransform(FRotator(0.f), Location))
+		: World->SpawnActor<AActor>(ToSpawn, Location, FRotator(0.f), SpawnParams);
+	AEnemy* Enemy = Cast<AEnemy>(Actor);
 
-		if (World)
+	if (Enemy)
+	{
+		// Recycled enemies keep the controller they were first given
+		if (!Enemy->GetController())
+		{
+			Enemy->SpawnDefaultController();
+		}
+
+		AAIController* AICont = Cast<AAIController>(Enemy->GetController());
+		if (AICont)
 		{
-			AActor* Actor = World->SpawnActor<AActor>(ToSpawn, Location, FRotator(0.f), SpawnParams);
-			AEnemy* Enemy = Cast<AEnemy>(Actor);
-
-			if (Enemy)
-			{
-				Enemy->SpawnDefaultController();
-
-				AAIController* AICont = Cast<AAIController>(Enemy->GetController());
-				if (AICont)
-				{
-					Enemy->AIController = AICont;
-				}
-			}
+			Enemy->AIController = AICont;
 		}
+
+		if (bOverrideNavigationMode)
+		{
+			Enemy->NavigationMode = NavigationMode;
+		}
+	}
+
+	return Actor;
+}
+
+void ASpawnVolume::OnScheduledSpawnFinished(bool bSpawned)
+{
+	PendingSpawns = FMath::Max(PendingSpawns - 1, 0);
+	if (bSpawned)
+	{
+		WaveSpawnCount++;
+	}
+
+	if (PendingSpawns == 0)
+	{
+		const int32 NumSpawned = WaveSpawnCount;
+		WaveSpawnCount = 0;
+		OnSpawnWaveComplete.Broadcast(this, NumSpawned);
 	}
 }
 
@@ -87,7 +151,7 @@ TSubclassOf<AActor> ASpawnVolume::GetSpawnActor()
 {
 	if (SpawnArray.Num() > 0)
 	{
-		int32 Selection = FMath::RandRange(0, SpawnArray.Num() - 1);
+		int32 Selection = URandomStreamSubsystem::GetStream(this, TEXT("SpawnActor")).RandRange(0, SpawnArray.Num() - 1);
 
 		return SpawnArray[Selection];
 	}
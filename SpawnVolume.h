@@ -4,8 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Enemy.h"
 #include "SpawnVolume.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSpawnWaveComplete, class ASpawnVolume*, Volume, int32, NumSpawned);
+
 UCLASS()
 class FIRSTPROYECT2_API ASpawnVolume : public AActor
 {
@@ -35,6 +38,25 @@ public:
 
 	TArray<TSubclassOf<AActor>>SpawnArray;
 
+	/** SpawnOurActor queues into USpawnSchedulerSubsystem instead of spawning in the calling frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	bool bTimeSliceSpawns;
+
+	/** Fired once every queued spawn of this volume has been processed */
+	UPROPERTY(BlueprintAssignable, Category = "Spawning")
+	FOnSpawnWaveComplete OnSpawnWaveComplete;
+
+	/** Instances per class created hidden in BeginPlay, so SpawnOurActor rarely has to spawn */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning|Pooling")
+	TMap<TSubclassOf<AActor>, int32> PoolPrewarmCounts;
+
+	/** Spawned enemies use NavigationMode instead of their class default */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning|AI")
+	bool bOverrideNavigationMode;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning|AI", meta = (EditCondition = "bOverrideNavigationMode"))
+	EEnemyNavigationMode NavigationMode;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -52,4 +74,21 @@ public:
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Spawning")
 	void SpawnOurActor(UClass* ToSpawn, const FVector& Location);
 
+	/** Spawns (or acquires from the pool) and sets up the actor right now */
+	AActor* SpawnImmediate(UClass* ToSpawn, const FVector& Location);
+
+	/** Called by the spawn scheduler for every request of this volume it processed */
+	void OnScheduledSpawnFinished(bool bSpawned);
+
+	UFUNCTION(BlueprintPure, Category = "Spawning")
+	FORCEINLINE int32 GetPendingSpawns() const { return PendingSpawns; }
+
+private:
+
+	/** Requests still in the scheduler queue */
+	int32 PendingSpawns;
+
+	/** Actors spawned since the last wave completed */
+	int32 WaveSpawnCount;
+
 };
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Built by CMakeLists.txt only, the Unreal Build Tool also picks up this file and skips it
+#ifdef COMBATCORE_STANDALONE
+
+#include "CombatCore.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace CombatCore;
+
+namespace
+{
+	/** Paired duellists standing next to each other, an odd one out has no target */
+	std::vector<FCombatant> MakeArena(int32_t NumCombatants)
+	{
+		std::mt19937 Random(1337);
+		std::uniform_real_distribution<float> Position(-20000.f, 20000.f);
+		std::uniform_real_distribution<float> Unit(0.f, 1.f);
+
+		std::vector<FCombatant> Combatants(NumCombatants);
+		for (int32_t i = 0; i < NumCombatants; i++)
+		{
+			FCombatant& Combatant = Combatants[i];
+			Combatant.X = Position(Random);
+			Combatant.Y = Position(Random);
+			Combatant.MaxHealth = 100.f;
+			Combatant.Health = 50.f + 50.f * Unit(Random);
+			Combatant.Stamina.Stamina = 150.f * Unit(Random);
+			Combatant.Damage = 0.1f + 0.9f * Unit(Random);
+			Combatant.bSprintHeld = Unit(Random) < 0.5f;
+			Combatant.bMoving = Unit(Random) < 0.8f;
+
+			const int32_t Partner = i ^ 1;
+			if (Partner < NumCombatants)
+			{
+				Combatant.Target = Partner;
+			}
+			if (i & 1)
+			{
+				Combatant.X = Combatants[i - 1].X + 100.f;
+				Combatant.Y = Combatants[i - 1].Y;
+			}
+		}
+		return Combatants;
+	}
+}
+
+/** One 60 Hz StepSimulation over the whole arena, the arena is rebuilt outside the timing when everyone is dead */
+static void BM_StepSimulation(benchmark::State& State)
+{
+	const int32_t NumCombatants = static_cast<int32_t>(State.range(0));
+	const FStaminaRules Rules;
+	std::vector<FCombatant> Combatants = MakeArena(NumCombatants);
+
+	int64_t Steps = 0;
+	for (auto _ : State)
+	{
+		const FStepResult Result = StepSimulation(Combatants, Rules, 150.f, 1.f / 60.f);
+		benchmark::DoNotOptimize(Result);
+
+		if (++Steps % 6000 == 0)
+		{
+			State.PauseTiming();
+			Combatants = MakeArena(NumCombatants);
+			State.ResumeTiming();
+		}
+	}
+
+	State.SetItemsProcessed(State.iterations() * NumCombatants);
+}
+BENCHMARK(BM_StepSimulation)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+/** The old per-frame stamina update of one character */
+static void BM_StepStamina(benchmark::State& State)
+{
+	const FStaminaRules Rules;
+	FStamina Stamina;
+	Stamina.Stamina = Rules.MaxStamina;
+
+	int64_t Frame = 0;
+	for (auto _ : State)
+	{
+		// Sprint for 4 s, rest for 4 s
+		const bool bSprintHeld = (Frame++ / 240) % 2 == 0;
+		benchmark::DoNotOptimize(StepStamina(Stamina, Rules, bSprintHeld, true, 1.f / 60.f));
+	}
+}
+BENCHMARK(BM_StepStamina);
+
+/** Reading the lazy timeline, what the HUD pays per frame instead */
+static void BM_EvaluateStamina(benchmark::State& State)
+{
+	const FStaminaRules Rules;
+	FStaminaTimeline Timeline;
+	Timeline.Stamina = Rules.MaxStamina;
+	SetStaminaInput(Timeline, Rules, 0.0, true, true);
+
+	double Now = 0.0;
+	for (auto _ : State)
+	{
+		Now += 1.0 / 60.0;
+		benchmark::DoNotOptimize(EvaluateStamina(Timeline, Rules, Now));
+	}
+}
+BENCHMARK(BM_EvaluateStamina);
+
+#endif
@@ -0,0 +1,270 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Built by CMakeLists.txt only, the Unreal Build Tool also picks up this file and skips it
+#ifdef COMBATCORE_STANDALONE
+
+#include "CombatCore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace CombatCore;
+
+TEST(CombatCoreStamina, SprintDrainsAndCrossesMinimum)
+{
+	const FStaminaRules Rules;
+	FStamina State;
+	State.Stamina = 60.f;
+
+	EXPECT_TRUE(StepStamina(State, Rules, true, true, 0.2f));
+	EXPECT_FLOAT_EQ(State.Stamina, 55.f);
+	EXPECT_EQ(State.Status, EStaminaStatus::Normal);
+
+	EXPECT_TRUE(StepStamina(State, Rules, true, true, 0.2f));
+	EXPECT_FLOAT_EQ(State.Stamina, 50.f);
+	EXPECT_EQ(State.Status, EStaminaStatus::BelowMinimum);
+}
+
+TEST(CombatCoreStamina, StandingStillDoesNotSprint)
+{
+	const FStaminaRules Rules;
+	FStamina State;
+	State.Stamina = 100.f;
+
+	EXPECT_FALSE(StepStamina(State, Rules, true, false, 1.f));
+	EXPECT_FLOAT_EQ(State.Stamina, 125.f);
+}
+
+TEST(CombatCoreStamina, RecoveryClampsAtMax)
+{
+	const FStaminaRules Rules;
+	FStamina State;
+	State.Stamina = Rules.MaxStamina - 1.f;
+
+	EXPECT_FALSE(StepStamina(State, Rules, false, true, 1.f));
+	EXPECT_FLOAT_EQ(State.Stamina, Rules.MaxStamina);
+}
+
+TEST(CombatCoreStamina, ExhaustionHoldsUntilSprintIsReleased)
+{
+	const FStaminaRules Rules;
+	FStamina State;
+	State.Stamina = 1.f;
+	State.Status = EStaminaStatus::BelowMinimum;
+
+	EXPECT_FALSE(StepStamina(State, Rules, true, true, 0.1f));
+	EXPECT_EQ(State.Status, EStaminaStatus::Exhausted);
+	EXPECT_FLOAT_EQ(State.Stamina, 0.f);
+
+	EXPECT_FALSE(StepStamina(State, Rules, true, true, 1.f));
+	EXPECT_EQ(State.Status, EStaminaStatus::Exhausted);
+	EXPECT_FLOAT_EQ(State.Stamina, 0.f);
+
+	EXPECT_FALSE(StepStamina(State, Rules, false, true, 1.f));
+	EXPECT_EQ(State.Status, EStaminaStatus::ExhaustedRecovering);
+
+	// Sprinting stays locked out until the minimum is regained
+	EXPECT_FALSE(StepStamina(State, Rules, true, true, 0.5f));
+	EXPECT_EQ(State.Status, EStaminaStatus::ExhaustedRecovering);
+	EXPECT_FALSE(StepStamina(State, Rules, true, true, 1.f));
+	EXPECT_EQ(State.Status, EStaminaStatus::Normal);
+}
+
+TEST(CombatCoreStaminaTimeline, TransitionTimesAreExact)
+{
+	const FStaminaRules Rules;
+	FStaminaTimeline Timeline;
+	Timeline.Stamina = 100.f;
+	SetStaminaInput(Timeline, Rules, 0.0, true, true);
+
+	// 50 above the minimum at 25 per second
+	EXPECT_DOUBLE_EQ(TimeToNextStaminaTransition(Timeline, Rules), 2.0);
+	EXPECT_TRUE(IsSprinting(Timeline));
+
+	AdvanceStamina(Timeline, Rules, 3.0);
+	EXPECT_EQ(Timeline.Status, EStaminaStatus::BelowMinimum);
+	EXPECT_FLOAT_EQ(Timeline.Stamina, 25.f);
+
+	AdvanceStamina(Timeline, Rules, 10.0);
+	EXPECT_EQ(Timeline.Status, EStaminaStatus::Exhausted);
+	EXPECT_FLOAT_EQ(Timeline.Stamina, 0.f);
+	EXPECT_FALSE(IsSprinting(Timeline));
+	EXPECT_LT(TimeToNextStaminaTransition(Timeline, Rules), 0.0);
+}
+
+TEST(CombatCoreStaminaTimeline, EvaluateDoesNotMoveTheAnchor)
+{
+	const FStaminaRules Rules;
+	FStaminaTimeline Timeline;
+	Timeline.Stamina = 100.f;
+
+	EXPECT_FLOAT_EQ(EvaluateStamina(Timeline, Rules, 1.0), 125.f);
+	EXPECT_FLOAT_EQ(EvaluateStamina(Timeline, Rules, 10.0), Rules.MaxStamina);
+	EXPECT_DOUBLE_EQ(Timeline.AnchorTime, 0.0);
+	EXPECT_FLOAT_EQ(Timeline.Stamina, 100.f);
+}
+
+TEST(CombatCoreStaminaTimeline, StopsChangingWhenFullOrHeldExhausted)
+{
+	const FStaminaRules Rules;
+	FStaminaTimeline Timeline;
+	Timeline.Stamina = Rules.MaxStamina;
+	EXPECT_FALSE(IsStaminaChanging(Timeline, Rules));
+
+	SetStaminaInput(Timeline, Rules, 0.0, true, true);
+	EXPECT_TRUE(IsStaminaChanging(Timeline, Rules));
+
+	AdvanceStamina(Timeline, Rules, 60.0);
+	EXPECT_EQ(Timeline.Status, EStaminaStatus::Exhausted);
+	EXPECT_FALSE(IsStaminaChanging(Timeline, Rules));
+
+	SetStaminaInput(Timeline, Rules, 60.0, false, true);
+	EXPECT_TRUE(IsStaminaChanging(Timeline, Rules));
+}
+
+/**
+ * Replays random sprint and movement input traces at random frame rates through both the lazy
+ * stamina timeline and the frame-stepped state machine and checks they never drift apart by more
+ * than two frames of drain.
+ */
+TEST(CombatCoreStaminaTimeline, MatchesFrameSteppedModel)
+{
+	const int32_t NumTraces = 1000;
+	const double Seconds = 60.0;
+
+	const float MinDeltaTime = 1.f / 120.f;
+	const float MaxDeltaTime = 1.f / 30.f;
+	const float ToggleChance = 0.03f;
+
+	const FStaminaRules Rules;
+	const float Tolerance = 2.f * Rules.DrainRate * MaxDeltaTime;
+
+	std::mt19937 Random(1337);
+	std::uniform_real_distribution<float> Unit(0.f, 1.f);
+	std::uniform_real_distribution<float> FrameTime(MinDeltaTime, MaxDeltaTime);
+
+	float WorstError = 0.f;
+	int32_t WorstTrace = -1;
+	int32_t NumFailed = 0;
+
+	for (int32_t Trace = 0; Trace < NumTraces; Trace++)
+	{
+		FStamina Stepped;
+		Stepped.Stamina = Rules.MaxStamina * Unit(Random);
+
+		FStaminaTimeline Lazy;
+		Lazy.Stamina = Stepped.Stamina;
+
+		bool bSprintHeld = false;
+		bool bMoving = false;
+		double Time = 0.0;
+		float TraceError = 0.f;
+
+		while (Time < Seconds)
+		{
+			const float DeltaTime = FrameTime(Random);
+			bSprintHeld = Unit(Random) < ToggleChance ? !bSprintHeld : bSprintHeld;
+			bMoving = Unit(Random) < ToggleChance ? !bMoving : bMoving;
+
+			// Same as AMain: the input of a frame counts from the start of that frame
+			if (bSprintHeld != Lazy.bSprintHeld || bMoving != Lazy.bMoving)
+			{
+				SetStaminaInput(Lazy, Rules, Time, bSprintHeld, bMoving);
+			}
+
+			Time += DeltaTime;
+			StepStamina(Stepped, Rules, bSprintHeld, bMoving, DeltaTime);
+
+			TraceError = std::max(TraceError, std::fabs(EvaluateStamina(Lazy, Rules, Time) - Stepped.Stamina));
+		}
+
+		if (TraceError > WorstError)
+		{
+			WorstError = TraceError;
+			WorstTrace = Trace;
+		}
+		NumFailed += TraceError > Tolerance ? 1 : 0;
+	}
+
+	EXPECT_EQ(NumFailed, 0) << "worst error " << WorstError << " in trace " << WorstTrace << ", tolerance " << Tolerance;
+}
+
+TEST(CombatCoreDamage, ApplyDamageReportsLethalHits)
+{
+	float Health = 20.f;
+	EXPECT_FALSE(ApplyDamage(Health, 15.f));
+	EXPECT_FLOAT_EQ(Health, 5.f);
+	EXPECT_TRUE(ApplyDamage(Health, 5.f));
+	EXPECT_FLOAT_EQ(Health, 0.f);
+}
+
+TEST(CombatCoreDamage, HealClampsAndDeadTargetsTakeNoHits)
+{
+	float Health = 90.f;
+	Heal(Health, 100.f, 25.f);
+	EXPECT_FLOAT_EQ(Health, 100.f);
+
+	EXPECT_FLOAT_EQ(ResolveHitDamage(10.f, 1.f), 10.f);
+	EXPECT_FLOAT_EQ(ResolveHitDamage(10.f, 0.f), 0.f);
+}
+
+TEST(CombatCoreSimulation, FindNearestTargetSkipsSelfAndDead)
+{
+	std::vector<FCombatant> Combatants(4);
+	for (FCombatant& Combatant : Combatants)
+	{
+		Combatant.Health = 100.f;
+	}
+	Combatants[1].X = 50.f;
+	Combatants[1].Health = 0.f;
+	Combatants[2].X = 80.f;
+	Combatants[3].X = 500.f;
+
+	EXPECT_EQ(FindNearestTarget(Combatants, 0, 100.f), 2);
+	EXPECT_EQ(FindNearestTarget(Combatants, 3, 100.f), -1);
+}
+
+TEST(CombatCoreSimulation, DuelEndsInOneKillAndClearsTheTarget)
+{
+	std::vector<FCombatant> Combatants(2);
+	Combatants[0].Health = 100.f;
+	Combatants[0].Damage = 30.f;
+	Combatants[0].Target = 1;
+	Combatants[1].X = 100.f;
+	Combatants[1].Health = 50.f;
+	Combatants[1].Damage = 1.f;
+	Combatants[1].Target = 0;
+
+	const FStaminaRules Rules;
+	FStepResult Total;
+	for (int32_t Step = 0; Step < 5; Step++)
+	{
+		const FStepResult Result = StepSimulation(Combatants, Rules, 150.f, 1.f / 60.f);
+		Total.Hits += Result.Hits;
+		Total.Kills += Result.Kills;
+	}
+
+	EXPECT_EQ(Total.Kills, 1);
+	EXPECT_EQ(Total.Hits, 3);
+	EXPECT_LE(Combatants[1].Health, 0.f);
+	EXPECT_FLOAT_EQ(Combatants[0].Health, 99.f);
+	EXPECT_EQ(Combatants[0].Target, -1);
+}
+
+TEST(CombatCoreSimulation, OutOfRangeTargetsAreNotHit)
+{
+	std::vector<FCombatant> Combatants(2);
+	Combatants[0].Health = 100.f;
+	Combatants[0].Damage = 10.f;
+	Combatants[0].Target = 1;
+	Combatants[1].X = 200.f;
+	Combatants[1].Health = 100.f;
+
+	const FStepResult Result = StepSimulation(Combatants, FStaminaRules(), 150.f, 1.f / 60.f);
+	EXPECT_EQ(Result.Hits, 0);
+	EXPECT_FLOAT_EQ(Combatants[1].Health, 100.f);
+}
+
+#endif
@@ -0,0 +1,295 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TimingWheel.h"
+#include "Misc/AutomationTest.h"
+
+FTimingWheel::FTimingWheel(float InTickInterval)
+{
+	Reset(InTickInterval);
+}
+
+void FTimingWheel::Reset(float InTickInterval)
+{
+	TickInterval = FMath::Max(InTickInterval, KINDA_SMALL_NUMBER);
+	Accumulator = 0.f;
+	CurrentTick = 0;
+
+	NumActive = 0;
+	LastFiredCount = 0;
+
+	Nodes.Reset();
+	FreeHead = INDEX_NONE;
+
+	Buckets.Init(INDEX_NONE, NumLevels * SlotsPerLevel);
+	FireScratch.Reset();
+}
+
+int32 FTimingWheel::AllocateNode()
+{
+	int32 Index = FreeHead;
+	if (Index != INDEX_NONE)
+	{
+		FreeHead = Nodes[Index].Next;
+	}
+	else
+	{
+		Index = Nodes.AddDefaulted();
+		Nodes[Index].Generation = 1;
+	}
+
+	FNode& Node = Nodes[Index];
+	Node.Prev = INDEX_NONE;
+	Node.Next = INDEX_NONE;
+	Node.Bucket = INDEX_NONE;
+	return Index;
+}
+
+void FTimingWheel::FreeNode(int32 Index)
+{
+	FNode& Node = Nodes[Index];
+	Node.Callback.Unbind();
+	Node.Bucket = INDEX_NONE;
+	Node.Prev = INDEX_NONE;
+
+	// Bumping the generation is what makes every outstanding handle to this node stale
+	Node.Generation++;
+	if (Node.Generation == 0)
+	{
+		Node.Generation = 1;
+	}
+
+	Node.Next = FreeHead;
+	FreeHead = Index;
+}
+
+void FTimingWheel::Link(int32 Index)
+{
+	FNode& Node = Nodes[Index];
+
+	// Anything past the outermost wheel waits in its last slot and cascades in from there
+	const uint64 MaxDelta = (uint64(1) << (SlotBits * NumLevels)) - 1;
+	if (Node.FireTick - CurrentTick > MaxDelta)
+	{
+		Node.FireTick = CurrentTick + MaxDelta;
+	}
+
+	const uint64 Delta = Node.FireTick - CurrentTick;
+	int32 Level = 0;
+	while (Level < NumLevels - 1 && Delta >= (uint64(1) << (SlotBits * (Level + 1))))
+	{
+		Level++;
+	}
+
+	const int32 Slot = int32((Node.FireTick >> (SlotBits * Level)) & (SlotsPerLevel - 1));
+	Node.Bucket = Level * SlotsPerLevel + Slot;
+
+	int32& Head = Buckets[Node.Bucket];
+	Node.Prev = INDEX_NONE;
+	Node.Next = Head;
+	if (Head != INDEX_NONE)
+	{
+		Nodes[Head].Prev = Index;
+	}
+	Head = Index;
+}
+
+void FTimingWheel::Unlink(int32 Index)
+{
+	FNode& Node = Nodes[Index];
+
+	if (Node.Prev != INDEX_NONE)
+	{
+		Nodes[Node.Prev].Next = Node.Next;
+	}
+	else
+	{
+		Buckets[Node.Bucket] = Node.Next;
+	}
+
+	if (Node.Next != INDEX_NONE)
+	{
+		Nodes[Node.Next].Prev = Node.Prev;
+	}
+
+	Node.Prev = INDEX_NONE;
+	Node.Next = INDEX_NONE;
+	Node.Bucket = INDEX_NONE;
+}
+
+void FTimingWheel::Schedule(FTimingWheelHandle& InOutHandle, float Delay, FSimpleDelegate Callback)
+{
+	Cancel(InOutHandle);
+
+	// Count from the real current time, not the last whole tick, and never fire in the same tick
+	const uint64 Ticks = uint64(FMath::Max(1.0, FMath::CeilToDouble((double(Accumulator) + FMath::Max(Delay, 0.f)) / TickInterval)));
+
+	const int32 Index = AllocateNode();
+	FNode& Node = Nodes[Index];
+	Node.Callback = MoveTemp(Callback);
+	Node.FireTick = CurrentTick + Ticks;
+	Link(Index);
+
+	NumActive++;
+
+	InOutHandle.Index = Index;
+	InOutHandle.Generation = Nodes[Index].Generation;
+}
+
+void FTimingWheel::Cancel(FTimingWheelHandle& InOutHandle)
+{
+	if (IsActive(InOutHandle))
+	{
+		// A firing node is no longer linked, freeing it is enough for the batch to skip it
+		if (Nodes[InOutHandle.Index].Bucket != FiringBucket)
+		{
+			Unlink(InOutHandle.Index);
+		}
+		FreeNode(InOutHandle.Index);
+		NumActive--;
+	}
+	InOutHandle.Invalidate();
+}
+
+bool FTimingWheel::IsActive(const FTimingWheelHandle& Handle) const
+{
+	return Nodes.IsValidIndex(Handle.Index)
+		&& Nodes[Handle.Index].Generation == Handle.Generation
+		&& Nodes[Handle.Index].Bucket != INDEX_NONE;
+}
+
+float FTimingWheel::GetTimeRemaining(const FTimingWheelHandle& Handle) const
+{
+	if (!IsActive(Handle)) return -1.f;
+
+	const uint64 Ticks = Nodes[Handle.Index].FireTick - CurrentTick;
+	return FMath::Max(float(Ticks) * TickInterval - Accumulator, 0.f);
+}
+
+void FTimingWheel::Advance(float DeltaTime)
+{
+	LastFiredCount = 0;
+	Accumulator += FMath::Max(DeltaTime, 0.f);
+
+	if (NumActive == 0)
+	{
+		// Nothing to cascade or fire, just keep the tick count in step with time
+		const uint64 Ticks = uint64(Accumulator / TickInterval);
+		CurrentTick += Ticks;
+		Accumulator -= Ticks * TickInterval;
+		return;
+	}
+
+	while (Accumulator >= TickInterval)
+	{
+		Accumulator -= TickInterval;
+		StepTick();
+	}
+}
+
+void FTimingWheel::Cascade(int32 Level)
+{
+	const int32 Bucket = Level * SlotsPerLevel + int32((CurrentTick >> (SlotBits * Level)) & (SlotsPerLevel - 1));
+
+	int32 Index = Buckets[Bucket];
+	Buckets[Bucket] = INDEX_NONE;
+
+	while (Index != INDEX_NONE)
+	{
+		const int32 Next = Nodes[Index].Next;
+		Link(Index);
+		Index = Next;
+	}
+}
+
+void FTimingWheel::StepTick()
+{
+	CurrentTick++;
+
+	// Every level whose lower bits all wrapped hands its current bucket down, outermost first
+	int32 TopLevel = 0;
+	for (int32 Level = 1; Level < NumLevels; Level++)
+	{
+		const uint64 LowerMask = (uint64(1) << (SlotBits * Level)) - 1;
+		if (CurrentTick & LowerMask) break;
+		TopLevel = Level;
+	}
+	for (int32 Level = TopLevel; Level >= 1; Level--)
+	{
+		Cascade(Level);
+	}
+
+	const int32 Bucket = int32(CurrentTick & (SlotsPerLevel - 1));
+	int32 Index = Buckets[Bucket];
+	if (Index == INDEX_NONE) return;
+
+	// Detach the whole bucket first so callbacks can freely schedule, and cancel timers of this batch
+	Buckets[Bucket] = INDEX_NONE;
+	FireScratch.Reset();
+	while (Index != INDEX_NONE)
+	{
+		FNode& Node = Nodes[Index];
+		const int32 Next = Node.Next;
+		Node.Bucket = FiringBucket;
+		Node.Prev = INDEX_NONE;
+		Node.Next = INDEX_NONE;
+		FireScratch.Add(Index);
+		Index = Next;
+	}
+
+	TArray<int32> Batch = MoveTemp(FireScratch);
+	for (const int32 FireIndex : Batch)
+	{
+		// Cancelled by an earlier callback of this batch, or freed and reused since
+		if (!Nodes.IsValidIndex(FireIndex) || Nodes[FireIndex].Bucket != FiringBucket) continue;
+
+		FSimpleDelegate Callback = MoveTemp(Nodes[FireIndex].Callback);
+		FreeNode(FireIndex);
+		NumActive--;
+		LastFiredCount++;
+
+		Callback.ExecuteIfBound();
+	}
+	Batch.Reset();
+	FireScratch = MoveTemp(Batch);
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTimingWheelCancelInBatchTest, "FirstProyect2.TimingWheel.CancelInBatch", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Two timers due in the same tick cancel each other from their callbacks. Whichever runs first
+ * must stop the other, like clearing an FTimerManager timer that is due in the same frame.
+ */
+bool FTimingWheelCancelInBatchTest::RunTest(const FString& Parameters)
+{
+	FTimingWheel Wheel(0.1f);
+
+	FTimingWheelHandle HandleA;
+	FTimingWheelHandle HandleB;
+	int32 FiredA = 0;
+	int32 FiredB = 0;
+
+	Wheel.Schedule(HandleA, 0.5f, FSimpleDelegate::CreateLambda([&]() { FiredA++; Wheel.Cancel(HandleB); }));
+	Wheel.Schedule(HandleB, 0.5f, FSimpleDelegate::CreateLambda([&]() { FiredB++; Wheel.Cancel(HandleA); }));
+
+	Wheel.Advance(1.f);
+
+	TestEqual(TEXT("Exactly one of the two timers fired"), FiredA + FiredB, 1);
+	TestEqual(TEXT("The wheel counts only the timer that fired"), Wheel.GetLastFiredCount(), 1);
+	TestEqual(TEXT("No timer is left active"), Wheel.Num(), 0);
+	TestFalse(TEXT("Handle A is not active"), Wheel.IsActive(HandleA));
+	TestFalse(TEXT("Handle B is not active"), Wheel.IsActive(HandleB));
+
+	// The cancelled node went back to the free list, the wheel still schedules and fires normally
+	int32 FiredC = 0;
+	FTimingWheelHandle HandleC;
+	Wheel.Schedule(HandleC, 0.2f, FSimpleDelegate::CreateLambda([&FiredC]() { FiredC++; }));
+	Wheel.Advance(1.f);
+	TestEqual(TEXT("A timer scheduled afterwards fires once"), FiredC, 1);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Stored inline by the owner, a default constructed handle never refers to a timer */
+struct FTimingWheelHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+
+	FORCEINLINE bool IsSet() const { return Index != INDEX_NONE; }
+	FORCEINLINE void Invalidate() { Index = INDEX_NONE; Generation = 0; }
+};
+
+/**
+ * Hierarchical timing wheel: NumLevels wheels of SlotsPerLevel buckets, each level covering
+ * SlotsPerLevel times the span of the one below. Timers live in a pooled array of nodes linked
+ * into their bucket, so Schedule and Cancel are O(1) and Advance only visits the due bucket
+ * (plus a cascade of one higher level bucket every SlotsPerLevel ticks).
+ * Delays are rounded up to whole ticks of TickInterval.
+ */
+struct FIRSTPROYECT2_API FTimingWheel
+{
+public:
+
+	explicit FTimingWheel(float InTickInterval = 1.f / 60.f);
+
+	/** Drops every timer without firing it */
+	void Reset(float InTickInterval);
+
+	/** Replaces whatever InOutHandle referred to, Callback runs once after Delay seconds */
+	void Schedule(FTimingWheelHandle& InOutHandle, float Delay, FSimpleDelegate Callback);
+
+	/** No-op for stale or unset handles, always leaves the handle unset. A timer due in the batch being fired is dropped too */
+	void Cancel(FTimingWheelHandle& InOutHandle);
+
+	bool IsActive(const FTimingWheelHandle& Handle) const;
+
+	/** Seconds until the timer fires, -1 when the handle is not active */
+	float GetTimeRemaining(const FTimingWheelHandle& Handle) const;
+
+	/** Moves time forward and fires every due bucket, each bucket as one batch */
+	void Advance(float DeltaTime);
+
+	FORCEINLINE int32 Num() const { return NumActive; }
+	FORCEINLINE float GetTickInterval() const { return TickInterval; }
+
+	/** Callbacks run by the last Advance */
+	FORCEINLINE int32 GetLastFiredCount() const { return LastFiredCount; }
+
+	static constexpr int32 SlotBits = 6;
+	static constexpr int32 SlotsPerLevel = 1 << SlotBits;
+	static constexpr int32 NumLevels = 4;
+
+private:
+
+	struct FNode
+	{
+		FSimpleDelegate Callback;
+		uint64 FireTick;
+		int32 Prev;
+		int32 Next;
+		uint32 Generation;
+		int32 Bucket;
+	};
+
+	int32 AllocateNode();
+	void FreeNode(int32 Index);
+
+	void Link(int32 Index);
+	void Unlink(int32 Index);
+
+	/** Re-links every node of a higher level bucket relative to the current tick */
+	void Cascade(int32 Level);
+
+	void StepTick();
+
+	float TickInterval;
+	float Accumulator;
+	uint64 CurrentTick;
+
+	int32 NumActive;
+	int32 LastFiredCount;
+
+	TArray<FNode> Nodes;
+	int32 FreeHead;
+
+	/** Head node of every bucket, NumLevels * SlotsPerLevel */
+	TArray<int32> Buckets;
+
+	/** Bucket of nodes that are due in the batch being fired, they stay allocated until they run */
+	static constexpr int32 FiringBucket = -2;
+
+	/** Reused by every batch so firing does not allocate */
+	TArray<int32> FireScratch;
+};
@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TimingWheelSubsystem.h"
+#include "FirstProyect2.h"
+#include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Timing Wheel Advance"), STAT_TimingWheelAdvance, STATGROUP_FirstProyect2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Timing Wheel Active Timers"), STAT_TimingWheelNum, STATGROUP_FirstProyect2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Timing Wheel Fired"), STAT_TimingWheelFired, STATGROUP_FirstProyect2);
+
+UTimingWheelSubsystem::UTimingWheelSubsystem()
+{
+	TickInterval = 1.f / 60.f;
+}
+
+void UTimingWheelSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Wheel.Reset(TickInterval);
+}
+
+void UTimingWheelSubsystem::Deinitialize()
+{
+	Wheel.Reset(TickInterval);
+
+	Super::Deinitialize();
+}
+
+ETickableTickType UTimingWheelSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UTimingWheelSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTimingWheelSubsystem, STATGROUP_Tickables);
+}
+
+void UTimingWheelSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TimingWheelAdvance);
+
+	Wheel.Advance(DeltaTime);
+
+	SET_DWORD_STAT(STAT_TimingWheelNum, Wheel.Num());
+	SET_DWORD_STAT(STAT_TimingWheelFired, Wheel.GetLastFiredCount());
+}
+
+void UTimingWheelSubsystem::SetTimer(FTimingWheelHandle& InOutHandle, float Delay, FSimpleDelegate Callback)
+{
+	Wheel.Schedule(InOutHandle, Delay, MoveTemp(Callback));
+}
+
+void UTimingWheelSubsystem::ClearTimer(FTimingWheelHandle& InOutHandle)
+{
+	Wheel.Cancel(InOutHandle);
+}
+
+bool UTimingWheelSubsystem::IsTimerActive(const FTimingWheelHandle& Handle) const
+{
+	return Wheel.IsActive(Handle);
+}
+
+float UTimingWheelSubsystem::GetTimerRemaining(const FTimingWheelHandle& Handle) const
+{
+	return Wheel.GetTimeRemaining(Handle);
+}
+
+/**
+ * FirstProyect2.TimingWheelBench [NumTimers...] (defaults to 10000 and 100000)
+ * Schedules NumTimers one-shot timers between 0.5s and 10s, re-arms a quarter of them the way
+ * enemies re-arm attacks, then runs 60Hz frames until everything fired. FTimerManager only ticks
+ * once per engine frame, so GFrameCounter is stepped for it and restored afterwards.
+ */
+static void RunTimingWheelBenchmark(const TArray<FString>& Args)
+{
+	TArray<int32> Counts;
+	for (const FString& Arg : Args)
+	{
+		Counts.Add(FMath::Max(FCString::Atoi(*Arg), 1));
+	}
+	if (Counts.Num() == 0)
+	{
+		Counts.Add(10000);
+		Counts.Add(100000);
+	}
+
+	const float FrameTime = 1.f / 60.f;
+	const int32 NumFrames = FMath::CeilToInt(10.5f / FrameTime);
+
+	for (const int32 NumTimers : Counts)
+	{
+		FRandomStream Stream(1337);
+		TArray<float> Delays;
+		Delays.Reserve(NumTimers);
+		for (int32 i = 0; i < NumTimers; i++)
+		{
+			Delays.Add(Stream.FRandRange(0.5f, 10.f));
+		}
+		const int32 NumRearms = NumTimers / 4;
+
+		int32 Fired = 0;
+		FSimpleDelegate WheelCallback = FSimpleDelegate::CreateLambda([&Fired]() { Fired++; });
+		FTimerDelegate ManagerCallback = FTimerDelegate::CreateLambda([&Fired]() { Fired++; });
+
+		// Timing wheel
+		FTimingWheel Wheel(FrameTime);
+		TArray<FTimingWheelHandle> WheelHandles;
+		WheelHandles.SetNum(NumTimers);
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumTimers; i++)
+		{
+			Wheel.Schedule(WheelHandles[i], Delays[i], WheelCallback);
+		}
+		const double WheelSchedule = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumRearms; i++)
+		{
+			Wheel.Schedule(WheelHandles[i * 4], Delays[i], WheelCallback);
+		}
+		const double WheelRearm = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			Wheel.Advance(FrameTime);
+		}
+		const double WheelAdvance = FPlatformTime::Seconds() - StartTime;
+		const int32 WheelFired = Fired;
+
+		// FTimerManager
+		Fired = 0;
+		FTimerManager TimerManager;
+		TArray<FTimerHandle> ManagerHandles;
+		ManagerHandles.SetNum(NumTimers);
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumTimers; i++)
+		{
+			TimerManager.SetTimer(ManagerHandles[i], ManagerCallback, Delays[i], false);
+		}
+		const double ManagerSchedule = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumRearms; i++)
+		{
+			TimerManager.SetTimer(ManagerHandles[i * 4], ManagerCallback, Delays[i], false);
+		}
+		const double ManagerRearm = FPlatformTime::Seconds() - StartTime;
+
+		const uint64 SavedFrameCounter = GFrameCounter;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			GFrameCounter++;
+			TimerManager.Tick(FrameTime);
+		}
+		const double ManagerAdvance = FPlatformTime::Seconds() - StartTime;
+		GFrameCounter = SavedFrameCounter;
+		const int32 ManagerFired = Fired;
+
+		UE_LOG(LogTemp, Display, TEXT("TimingWheelBench: %d timers, %d re-armed, %d frames"), NumTimers, NumRearms, NumFrames);
+		UE_LOG(LogTemp, Display, TEXT("  wheel    schedule %8.3f ms  re-arm %8.3f ms  advance %8.3f ms (%d fired)"), WheelSchedule * 1000.0, WheelRearm * 1000.0, WheelAdvance * 1000.0, WheelFired);
+		UE_LOG(LogTemp, Display, TEXT("  manager  schedule %8.3f ms  re-arm %8.3f ms  advance %8.3f ms (%d fired)"), ManagerSchedule * 1000.0, ManagerRearm * 1000.0, ManagerAdvance * 1000.0, ManagerFired);
+	}
+}
+
+static FAutoConsoleCommand TimingWheelBenchCommand(
+	TEXT("FirstProyect2.TimingWheelBench"),
+	TEXT("Benchmarks the gameplay timing wheel against FTimerManager. Args: [NumTimers...]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunTimingWheelBenchmark));
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "TimingWheel.h"
+#include "TimingWheelSubsystem.generated.h"
+
+/**
+ * Gameplay timers on a hierarchical timing wheel instead of the world timer manager heap.
+ * Owners keep an FTimingWheelHandle as a member; callbacks are bound weakly to the owner, so a
+ * destroyed actor's timer simply does nothing when it comes due.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UTimingWheelSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UTimingWheelSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return Wheel.Num() > 0; }
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** One-shot timer, replaces whatever InOutHandle was scheduled for */
+	void SetTimer(FTimingWheelHandle& InOutHandle, float Delay, FSimpleDelegate Callback);
+
+	template<class UserClass>
+	void SetTimer(FTimingWheelHandle& InOutHandle, UserClass* Object, void (UserClass::*Method)(), float Delay)
+	{
+		SetTimer(InOutHandle, Delay, FSimpleDelegate::CreateUObject(Object, Method));
+	}
+
+	void ClearTimer(FTimingWheelHandle& InOutHandle);
+
+	bool IsTimerActive(const FTimingWheelHandle& Handle) const;
+
+	float GetTimerRemaining(const FTimingWheelHandle& Handle) const;
+
+	/** Resolution of every timer in seconds */
+	float TickInterval;
+
+private:
+
+	FTimingWheel Wheel;
+};
@@ -10,6 +10,10 @@
 #include "Particles/ParticleSystemComponent.h"
 #include "Components/BoxComponent.h"
 #include "Enemy.h"
+#include "FXManagerSubsystem.h"
+#include "CombatCore.h"
+#include "DamageQueueSubsystem.h"
+#include "WeaponTraceComponent.h"
 
 AWeapon::AWeapon()
 {
@@ -19,9 +23,12 @@ AWeapon::AWeapon()
 	CombatCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("CombatCollision"));
 	CombatCollision->SetupAttachment(GetRootComponent()); 
 
+	WeaponTrace = CreateDefaultSubobject<UWeaponTraceComponent>(TEXT("WeaponTrace"));
+
 	
 
 	bWeaponParticles = false;
+	SwingCount = 0;
 
 	WeaponState = EWeaponState::EWS_Pickup;
 
@@ -39,6 +46,9 @@ void AWeapon::BeginPlay()
 	CombatCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
 	CombatCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 	CombatCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
+
+	WeaponTrace->SetTraceVolume(CombatCollision);
+	WeaponTrace->OnHit.AddUObject(this, &AWeapon::OnTraceHit);
 }
 
 void AWeapon::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -105,28 +115,48 @@ void AWeapon::CombatOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AAc
 		AEnemy* Enemy = Cast<AEnemy>(OtherActor);
 		if (Enemy)
 		{
-			if (Enemy->HitParticles)
-			{
-				const USkeletalMeshSocket* WeaponSocket = SkeletalMesh->GetSocketByName("WeaponSocket");
-				if (WeaponSocket)
-				{
-					FVector SocketLocation = WeaponSocket->GetSocketLocation(SkeletalMesh);
-					UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Enemy->HitParticles, GetActorLocation(), FRotator(0.f), false);
-				}
-				
-			}
-			if (Enemy->HitSound)
-			{
-				UGameplayStatics::PlaySound2D(this, Enemy->HitSound);
-			}
-			if (DamageTypeClass)
-			{
-				UGameplayStatics::ApplyDamage(Enemy, Damage, WeaponInstigator, this, DamageTypeClass);
-			}
+			const USkeletalMeshSocket* WeaponSocket = SkeletalMesh->GetSocketByName("WeaponSocket");
+			HitEnemy(Enemy, WeaponSocket ? WeaponSocket->GetSocketLocation(SkeletalMesh) : GetActorLocation());
 		}
 	}
 }
 
+void AWeapon::OnTraceHit(AActor* HitActor, const FHitResult& Hit)
+{
+	AEnemy* Enemy = Cast<AEnemy>(HitActor);
+	if (Enemy)
+	{
+		HitEnemy(Enemy, Hit.ImpactPoint);
+	}
+}
+
+void AWeapon::HitEnemy(AEnemy* Enemy, const FVector& HitLocation)
+{
+	const float HitDamage = CombatCore::ResolveHitDamage(Damage, Enemy->Health);
+	if (!DamageTypeClass || HitDamage <= 0.f) return;
+
+	FQueuedHit Hit;
+	Hit.Target = Enemy;
+	Hit.Instigator = WeaponInstigator;
+	Hit.Causer = this;
+	Hit.DamageType = DamageTypeClass;
+	Hit.Amount = HitDamage;
+	Hit.HitLocation = HitLocation;
+
+	// Hits after the first on this enemy in the same swing play no effects either
+	if (!UDamageQueueSubsystem::QueueOrApply(GetWorld(), Hit, SwingCount)) return;
+
+	UFXManagerSubsystem* FX = GetWorld()->GetSubsystem<UFXManagerSubsystem>();
+	if (Enemy->HitParticles && FX)
+	{
+		FX->SpawnEmitter(Enemy->HitParticles, HitLocation);
+	}
+	if (Enemy->HitSound && FX)
+	{
+		FX->PlaySound2D(Enemy->HitSound, HitLocation);
+	}
+}
+
 void AWeapon::CombatOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
 
@@ -134,11 +164,38 @@ void AWeapon::CombatOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActo
 
 void AWeapon::ActivateCollision()
 {
-	CombatCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	
+	SwingCount++;
+	if (WeaponTrace->CanTrace())
+	{
+		WeaponTrace->BeginSwing();
+	}
+	else
+	{
+		CombatCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	}
 }
 
 void AWeapon::DeactivateCollision()
 {
+	WeaponTrace->EndSwing();
 	CombatCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-}
\ No newline at end of file
+}
+
+void AWeapon::OnAcquiredFromPool_Implementation()
+{
+	Super::OnAcquiredFromPool_Implementation();
+
+	// Equip() changed these for the hand, a recycled weapon starts out as a pickup again
+	SkeletalMesh->SetCollisionResponseToChannels(GetClass()->GetDefaultObject<AWeapon>()->SkeletalMesh->GetCollisionResponseToChannels());
+	SetWeaponState(EWeaponState::EWS_Pickup);
+}
+
+void AWeapon::OnReleasedToPool_Implementation()
+{
+	Super::OnReleasedToPool_Implementation();
+
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	DeactivateCollision();
+	SetInstigator(nullptr);
+	SetWeaponState(EWeaponState::EWS_Pickup);
+}
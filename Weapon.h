@@ -29,6 +29,9 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "SaveData")
 	FString Name;
 
+	/** Key of this weapon in UWeaponRegistrySubsystem */
+	FORCEINLINE FName GetWeaponId() const { return FName(*Name); }
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Item")
 	EWeaponState WeaponState;
 
@@ -47,6 +50,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item | Combat")
 	class UBoxComponent* CombatCollision;
 
+	/** Sweeps CombatCollision along the swing, its overlaps are only used when the box has no extent */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item | Combat")
+	class UWeaponTraceComponent* WeaponTrace;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Combat")
 	float Damage;
 
@@ -72,6 +79,11 @@ public:
 	UFUNCTION()
 	void CombatOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 
+	void OnTraceHit(AActor* HitActor, const FHitResult& Hit);
+
+	/** Queues the damage and plays the hit effects, unless Enemy was already hit this swing */
+	void HitEnemy(class AEnemy* Enemy, const FVector& HitLocation);
+
 	UFUNCTION(BlueprintCallable)
 	void ActivateCollision();
 
@@ -85,4 +97,11 @@ public:
 	AController* WeaponInstigator;
 
 	FORCEINLINE void SetInstigator(AController* Inst) { WeaponInstigator = Inst; }
+
+	/** Bumped by ActivateCollision, a target is damaged once per swing */
+	int32 SwingCount;
+
+	// IPoolable
+	virtual void OnAcquiredFromPool_Implementation() override;
+	virtual void OnReleasedToPool_Implementation() override;
 };
@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "WeaponRegistry.generated.h"
+
+/**
+ * Every weapon the player can save with, by id. Classes are soft references, so nothing here is
+ * loaded until UWeaponRegistrySubsystem asks for it.
+ */
+UCLASS(BlueprintType)
+class FIRSTPROYECT2_API UWeaponRegistry : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapons")
+	TMap<FName, TSoftClassPtr<class AWeapon>> Weapons;
+};
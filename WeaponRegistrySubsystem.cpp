@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponRegistrySubsystem.h"
+#include "FirstProyect2.h"
+#include "WeaponRegistry.h"
+#include "ItemStorage.h"
+#include "Weapon.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon Class Loads"), STAT_WeaponClassLoads, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon Class Already Loaded"), STAT_WeaponClassHits, STATGROUP_FirstProyect2);
+
+UWeaponRegistrySubsystem::UWeaponRegistrySubsystem()
+{
+}
+
+void UWeaponRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (Registry.IsNull()) return;
+
+	// Only soft references inside, loading the asset itself is cheap
+	if (const UWeaponRegistry* RegistryAsset = Registry.LoadSynchronous())
+	{
+		Weapons.Append(RegistryAsset->Weapons);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("WeaponRegistry: could not load %s"), *Registry.ToString());
+	}
+}
+
+void UWeaponRegistrySubsystem::Deinitialize()
+{
+	for (TPair<FName, TSharedPtr<FStreamableHandle>>& Handle : Handles)
+	{
+		if (Handle.Value.IsValid())
+		{
+			Handle.Value->CancelHandle();
+		}
+	}
+	Handles.Reset();
+	PendingRequests.Reset();
+	Weapons.Reset();
+
+	Super::Deinitialize();
+}
+
+void UWeaponRegistrySubsystem::RegisterStorage(TSubclassOf<AItemStorage> Storage)
+{
+	if (!Storage) return;
+
+	for (const TPair<FString, TSubclassOf<AWeapon>>& Entry : Storage->GetDefaultObject<AItemStorage>()->WeaponMap)
+	{
+		const FName WeaponId(*Entry.Key);
+		if (!Weapons.Contains(WeaponId))
+		{
+			Weapons.Add(WeaponId, TSoftClassPtr<AWeapon>(Entry.Value.Get()));
+		}
+	}
+}
+
+TSubclassOf<AWeapon> UWeaponRegistrySubsystem::FindLoadedWeaponClass(FName WeaponId) const
+{
+	const TSoftClassPtr<AWeapon>* Weapon = Weapons.Find(WeaponId);
+	return Weapon ? Weapon->Get() : nullptr;
+}
+
+void UWeaponRegistrySubsystem::PreloadWeapon(FName WeaponId)
+{
+	const TSoftClassPtr<AWeapon>* Weapon = Weapons.Find(WeaponId);
+	if (!Weapon || Weapon->IsNull() || Handles.Contains(WeaponId)) return;
+
+	INC_DWORD_STAT(STAT_WeaponClassLoads);
+
+	// Also holds a class that is already loaded, so it survives the garbage collection of a level change
+	Handles.Add(WeaponId, Streamable.RequestAsyncLoad(Weapon->ToSoftObjectPath(),
+		FStreamableDelegate::CreateUObject(this, &UWeaponRegistrySubsystem::OnWeaponLoaded, WeaponId)));
+}
+
+void UWeaponRegistrySubsystem::RequestWeaponClass(FName WeaponId, FOnWeaponClassLoaded OnLoaded)
+{
+	if (TSubclassOf<AWeapon> Loaded = FindLoadedWeaponClass(WeaponId))
+	{
+		INC_DWORD_STAT(STAT_WeaponClassHits);
+		PreloadWeapon(WeaponId);
+		OnLoaded.ExecuteIfBound(Loaded);
+		return;
+	}
+
+	const TSoftClassPtr<AWeapon>* Weapon = Weapons.Find(WeaponId);
+	if (!Weapon || Weapon->IsNull())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("WeaponRegistry: no weapon registered as %s"), *WeaponId.ToString());
+		OnLoaded.ExecuteIfBound(nullptr);
+		return;
+	}
+
+	PendingRequests.FindOrAdd(WeaponId).Add(OnLoaded);
+	PreloadWeapon(WeaponId);
+}
+
+void UWeaponRegistrySubsystem::OnWeaponLoaded(FName WeaponId)
+{
+	TArray<FOnWeaponClassLoaded> Requests;
+	PendingRequests.RemoveAndCopyValue(WeaponId, Requests);
+
+	const TSubclassOf<AWeapon> Loaded = FindLoadedWeaponClass(WeaponId);
+	if (!Loaded)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("WeaponRegistry: could not load %s"), *WeaponId.ToString());
+		Handles.Remove(WeaponId);
+	}
+
+	for (FOnWeaponClassLoaded& Request : Requests)
+	{
+		Request.ExecuteIfBound(Loaded);
+	}
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "Templates/SubclassOf.h"
+#include "WeaponRegistrySubsystem.generated.h"
+
+class AWeapon;
+class AItemStorage;
+class UWeaponRegistry;
+
+DECLARE_DELEGATE_OneParam(FOnWeaponClassLoaded, TSubclassOf<AWeapon> /* nullptr for an unknown id or a failed load */);
+
+/**
+ * Weapon classes by FName id for saving and loading the equipped weapon. Entries come from the
+ * UWeaponRegistry set in DefaultGame.ini and from the legacy AItemStorage blueprint's WeaponMap,
+ * read from its class default object. Classes load asynchronously and stay loaded once requested,
+ * so a weapon preloaded before a level change is ready when the next level equips it.
+ *
+ * [/Script/FirstProyect2.WeaponRegistrySubsystem]
+ * Registry=/Game/Data/DA_WeaponRegistry.DA_WeaponRegistry
+ */
+UCLASS(Config = Game)
+class FIRSTPROYECT2_API UWeaponRegistrySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UWeaponRegistrySubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Adds the entries of Storage's WeaponMap that the registry asset does not already have */
+	void RegisterStorage(TSubclassOf<AItemStorage> Storage);
+
+	bool IsRegistered(FName WeaponId) const { return Weapons.Contains(WeaponId); }
+
+	/** The class when it is already in memory, never loads */
+	TSubclassOf<AWeapon> FindLoadedWeaponClass(FName WeaponId) const;
+
+	/** Starts loading the class in the background if it is not loaded yet */
+	void PreloadWeapon(FName WeaponId);
+
+	/** Calls OnLoaded right away when the class is in memory, else once the async load is done */
+	void RequestWeaponClass(FName WeaponId, FOnWeaponClassLoaded OnLoaded);
+
+private:
+
+	void OnWeaponLoaded(FName WeaponId);
+
+	UPROPERTY(Config)
+	TSoftObjectPtr<UWeaponRegistry> Registry;
+
+	TMap<FName, TSoftClassPtr<AWeapon>> Weapons;
+
+	FStreamableManager Streamable;
+
+	/** One per requested weapon, keeps the class loaded */
+	TMap<FName, TSharedPtr<FStreamableHandle>> Handles;
+
+	/** Requests waiting for a load in flight */
+	TMap<FName, TArray<FOnWeaponClassLoaded>> PendingRequests;
+};
@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponTraceComponent.h"
+#include "FirstProyect2.h"
+#include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+DECLARE_CYCLE_STAT(TEXT("Weapon Trace"), STAT_WeaponTrace, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon Trace Sweeps"), STAT_WeaponTraceSweeps, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon Trace Hits"), STAT_WeaponTraceHits, STATGROUP_FirstProyect2);
+
+UWeaponTraceComponent::UWeaponTraceComponent()
+{
+	// After animation, so the hit box is where this frame's pose put it
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	MaxSweepAngle = 15.f;
+	SwingId = 0;
+	bSwinging = false;
+}
+
+void UWeaponTraceComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	TraceDelegate.BindUObject(this, &UWeaponTraceComponent::OnTraceCompleted);
+}
+
+void UWeaponTraceComponent::SetTraceVolume(UBoxComponent* Volume)
+{
+	TraceVolume = Volume;
+}
+
+bool UWeaponTraceComponent::CanTrace() const
+{
+	const UBoxComponent* Volume = TraceVolume.Get();
+	return Volume && !Volume->GetScaledBoxExtent().IsNearlyZero();
+}
+
+void UWeaponTraceComponent::BuildSweeps(const FTransform& From, const FTransform& To, float MaxAngle, TArray<FWeaponSweep>& OutSweeps)
+{
+	const FQuat FromRotation = From.GetRotation();
+	const FQuat ToRotation = To.GetRotation();
+
+	// A box sweep cannot turn, so a turning swing is cut into steps each swept at its middle rotation
+	const float AngleDegrees = FMath::RadiansToDegrees(FromRotation.AngularDistance(ToRotation));
+	const int32 NumSteps = FMath::Clamp(FMath::CeilToInt(AngleDegrees / FMath::Max(MaxAngle, 1.f)), 1, 16);
+
+	OutSweeps.SetNumUninitialized(NumSteps);
+	for (int32 i = 0; i < NumSteps; i++)
+	{
+		const float Alpha0 = (float)i / NumSteps;
+		const float Alpha1 = (float)(i + 1) / NumSteps;
+
+		FWeaponSweep& Sweep = OutSweeps[i];
+		Sweep.Start = FMath::Lerp(From.GetLocation(), To.GetLocation(), Alpha0);
+		Sweep.End = FMath::Lerp(From.GetLocation(), To.GetLocation(), Alpha1);
+		Sweep.Rotation = FQuat::Slerp(FromRotation, ToRotation, (Alpha0 + Alpha1) * 0.5f);
+	}
+}
+
+void UWeaponTraceComponent::BeginSwing()
+{
+	SwingId++;
+	HitActors.Reset();
+	if (const UBoxComponent* Volume = TraceVolume.Get())
+	{
+		PreviousTransform = Volume->GetComponentTransform();
+	}
+
+	bSwinging = true;
+	SetComponentTickEnabled(true);
+}
+
+void UWeaponTraceComponent::EndSwing()
+{
+	bSwinging = false;
+	SetComponentTickEnabled(false);
+}
+
+void UWeaponTraceComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WeaponTrace);
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UWorld* World = GetWorld();
+	const UBoxComponent* Volume = TraceVolume.Get();
+	if (!bSwinging || !World || !Volume) return;
+
+	const FTransform CurrentTransform = Volume->GetComponentTransform();
+	BuildSweeps(PreviousTransform, CurrentTransform, MaxSweepAngle, Sweeps);
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(WeaponTrace), false, GetOwner());
+	if (AActor* Wielder = GetOwner() ? GetOwner()->GetAttachParentActor() : nullptr)
+	{
+		Params.AddIgnoredActor(Wielder);
+	}
+	const FCollisionObjectQueryParams ObjectParams(ECC_Pawn);
+	const FCollisionShape Shape = FCollisionShape::MakeBox(Volume->GetScaledBoxExtent());
+
+	// Queued into the world's async trace batch, which runs them together on worker threads
+	for (const FWeaponSweep& Sweep : Sweeps)
+	{
+		World->AsyncSweepByObjectType(EAsyncTraceType::Multi, Sweep.Start, Sweep.End, Sweep.Rotation, ObjectParams, Shape, Params, &TraceDelegate, SwingId);
+	}
+	INC_DWORD_STAT_BY(STAT_WeaponTraceSweeps, Sweeps.Num());
+
+	PreviousTransform = CurrentTransform;
+}
+
+void UWeaponTraceComponent::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	if (Datum.UserData != SwingId) return;
+
+	for (const FHitResult& Hit : Datum.OutHits)
+	{
+		AActor* HitActor = Hit.GetActor();
+		if (!HitActor || HitActors.Contains(HitActor)) continue;
+
+		HitActors.Add(HitActor);
+		INC_DWORD_STAT(STAT_WeaponTraceHits);
+
+		OnHit.Broadcast(HitActor, Hit);
+	}
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponTraceSweepTest, "FirstProyect2.WeaponTrace.BladeSweep", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * A blade held at the origin swings 90 degrees of yaw over three frames. Its sweeps run as real
+ * world queries against pawn capsules: one at the blade's mid-length that the tip passes 30 units
+ * clear of, one just beyond the tip. A sphere swept along the tip path, the old trace, has to miss
+ * the first.
+ */
+bool FWeaponTraceSweepTest::RunTest(const FString& Parameters)
+{
+	const FVector Extent(50.f, 5.f, 5.f);
+	const float BladeLength = Extent.X * 2.f;
+	const float TargetRadius = 20.f;
+
+	// Box center at mid-length, the hand sits at the origin and the tip at BladeLength
+	auto BladeTransform = [&Extent](float YawDegrees)
+	{
+		const FQuat Rotation(FVector::UpVector, FMath::DegreesToRadians(YawDegrees));
+		return FTransform(Rotation, Rotation.RotateVector(FVector(Extent.X, 0.f, 0.f)));
+	};
+
+	TArray<FWeaponSweep> Sweeps;
+	TArray<FWeaponSweep> FrameSweeps;
+	for (float Yaw = -45.f; Yaw < 45.f; Yaw += 30.f)
+	{
+		const FTransform From = BladeTransform(Yaw);
+		const FTransform To = BladeTransform(Yaw + 30.f);
+		UWeaponTraceComponent::BuildSweeps(From, To, 15.f, FrameSweeps);
+
+		TestEqual(TEXT("A 30 degree frame is cut into 15 degree sweeps"), FrameSweeps.Num(), 2);
+		TestTrue(TEXT("The first sweep starts at the previous transform"), FrameSweeps[0].Start.Equals(From.GetLocation()));
+		TestTrue(TEXT("The last sweep ends at the current transform"), FrameSweeps.Last().End.Equals(To.GetLocation()));
+		TestTrue(TEXT("The second sweep turns the box to three quarters of the frame"),
+			FrameSweeps[1].Rotation.Equals(FQuat(FVector::UpVector, FMath::DegreesToRadians(Yaw + 22.5f)), KINDA_SMALL_NUMBER));
+		Sweeps.Append(FrameSweeps);
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	auto SpawnTarget = [World, TargetRadius](const FVector& Location)
+	{
+		AActor* Target = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location));
+		UCapsuleComponent* Capsule = NewObject<UCapsuleComponent>(Target);
+		Capsule->InitCapsuleSize(TargetRadius, 90.f);
+		Capsule->SetCollisionObjectType(ECC_Pawn);
+		Capsule->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+		Capsule->SetCollisionResponseToAllChannels(ECR_Block);
+		Target->SetRootComponent(Capsule);
+		Capsule->SetWorldLocation(Location);
+		Capsule->RegisterComponent();
+		return Target;
+	};
+
+	// Same queries TickComponent hands to the async batch, run synchronously
+	auto SweepHits = [World](const TArray<FWeaponSweep>& WorldSweeps, const FCollisionShape& Shape, const AActor* Target)
+	{
+		const FCollisionObjectQueryParams ObjectParams(ECC_Pawn);
+		const FCollisionQueryParams Params(SCENE_QUERY_STAT(WeaponTrace), false);
+		for (const FWeaponSweep& Sweep : WorldSweeps)
+		{
+			TArray<FHitResult> Hits;
+			World->SweepMultiByObjectType(Hits, Sweep.Start, Sweep.End, Sweep.Rotation, ObjectParams, Shape, Params);
+			if (Hits.ContainsByPredicate([Target](const FHitResult& Hit) { return Hit.GetActor() == Target; })) return true;
+		}
+		return false;
+	};
+
+	const AActor* MidTarget = SpawnTarget(FVector(BladeLength * 0.5f, 0.f, 0.f));
+	const AActor* FarTarget = SpawnTarget(FVector(BladeLength + TargetRadius + 10.f, 0.f, 0.f));
+
+	TestTrue(TEXT("The swept blade hits a target at its mid-length"), SweepHits(Sweeps, FCollisionShape::MakeBox(Extent), MidTarget));
+	TestFalse(TEXT("The swept blade misses a target beyond its tip"), SweepHits(Sweeps, FCollisionShape::MakeBox(Extent), FarTarget));
+
+	TArray<FWeaponSweep> TipSweeps;
+	for (const FWeaponSweep& Sweep : Sweeps)
+	{
+		const FVector TipOffset = Sweep.Rotation.RotateVector(FVector(Extent.X, 0.f, 0.f));
+		TipSweeps.Add({ Sweep.Start + TipOffset, Sweep.End + TipOffset, FQuat::Identity });
+	}
+	TestFalse(TEXT("A sphere swept along the tip misses the mid-length target"), SweepHits(TipSweeps, FCollisionShape::MakeSphere(20.f), MidTarget));
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "WorldCollision.h"
+#include "WeaponTraceComponent.generated.h"
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnWeaponTraceHit, AActor* /*HitActor*/, const FHitResult& /*Hit*/);
+
+/** One straight box sweep of a swing, the box keeps Rotation while its center moves from Start to End */
+struct FWeaponSweep
+{
+	FVector Start;
+	FVector End;
+	FQuat Rotation;
+};
+
+/**
+ * Sweeps the weapon's hit box from where it was last frame to where it is now while a swing is
+ * active, so fast swings at low frame rates cannot pass through a target and the whole blade hits,
+ * not just its tip. Sweeps go through the world's async trace batch and their results arrive the
+ * next frame. Every actor is reported at most once per swing.
+ */
+UCLASS(ClassGroup = (Combat), meta = (BlueprintSpawnableComponent))
+class FIRSTPROYECT2_API UWeaponTraceComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:	
+	UWeaponTraceComponent();
+
+	/** A frame's movement is split into sweeps that each turn the box by at most this many degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	float MaxSweepAngle;
+
+	/** Box that is swept, its scaled extent and rotation are read every frame */
+	void SetTraceVolume(class UBoxComponent* Volume);
+
+	/** False without a box to sweep, the owner then falls back to overlaps */
+	bool CanTrace() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	void BeginSwing();
+
+	/** Sweeps already in flight still report their hits */
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	void EndSwing();
+
+	FORCEINLINE bool IsSwinging() const { return bSwinging; }
+
+	FOnWeaponTraceHit OnHit;
+
+	/** Splits the box's movement between two transforms into straight sweeps, turning at most MaxAngle degrees each */
+	static void BuildSweeps(const FTransform& From, const FTransform& To, float MaxAngle, TArray<FWeaponSweep>& OutSweeps);
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+private:
+
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	TWeakObjectPtr<class UBoxComponent> TraceVolume;
+
+	/** Box transform of the last sweep */
+	FTransform PreviousTransform;
+
+	TArray<FWeaponSweep> Sweeps;
+
+	/** Actors already reported this swing */
+	TSet<TWeakObjectPtr<AActor>> HitActors;
+
+	FTraceDelegate TraceDelegate;
+
+	/** Passed with every sweep as user data, results of an older swing are dropped */
+	uint32 SwingId;
+
+	bool bSwinging;
+};
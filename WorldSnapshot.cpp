@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WorldSnapshot.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace WorldSnapshot
+{
+	/** "FPWS" */
+	static const uint32 SnapshotMagic = 0x53575046;
+	/** "FPWJ" */
+	static const uint32 JournalMagic = 0x4A575046;
+	static const int32 FileVersion = 1;
+}
+
+void FWorldSnapshot::Save(TArray<uint8>& OutBytes)
+{
+	FMemoryWriter Writer(OutBytes);
+
+	uint32 Magic = WorldSnapshot::SnapshotMagic;
+	int32 Version = WorldSnapshot::FileVersion;
+	uint32 SavedGeneration = Generation;
+	Writer << Magic << Version << SavedGeneration;
+	Writer << Records;
+}
+
+bool FWorldSnapshot::Load(const TArray<uint8>& Bytes)
+{
+	FMemoryReader Reader(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Reader << Magic << Version;
+	if (Magic != WorldSnapshot::SnapshotMagic || Version != WorldSnapshot::FileVersion) return false;
+
+	Reader << Generation;
+	Reader << Records;
+	return !Reader.IsError();
+}
+
+void FWorldSnapshot::SaveJournalHeader(TArray<uint8>& OutBytes) const
+{
+	FMemoryWriter Writer(OutBytes);
+
+	uint32 Magic = WorldSnapshot::JournalMagic;
+	int32 Version = WorldSnapshot::FileVersion;
+	uint32 SavedGeneration = Generation;
+	Writer << Magic << Version << SavedGeneration;
+}
+
+int32 FWorldSnapshot::ReplayJournal(const TArray<uint8>& Bytes, int64& OutValidBytes)
+{
+	FMemoryReader Reader(Bytes);
+	OutValidBytes = 0;
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	uint32 JournalGeneration = 0;
+	Reader << Magic << Version << JournalGeneration;
+	if (Reader.IsError() || Magic != WorldSnapshot::JournalMagic || Version != WorldSnapshot::FileVersion || JournalGeneration != Generation)
+	{
+		return INDEX_NONE;
+	}
+
+	OutValidBytes = Reader.Tell();
+	int32 NumApplied = 0;
+	while (Reader.Tell() + (int64)sizeof(int32) <= Reader.TotalSize())
+	{
+		int32 Size = 0;
+		Reader << Size;
+
+		// Torn tail of an append that did not finish, everything before it is intact
+		if (Size <= 0 || Reader.Tell() + Size > Reader.TotalSize()) break;
+
+		TArray<uint8> EntryBytes(Bytes.GetData() + Reader.Tell(), Size);
+		Reader.Seek(Reader.Tell() + Size);
+
+		FMemoryReader EntryReader(EntryBytes);
+		FWorldDelta Delta;
+		Delta.Serialize(EntryReader);
+		if (EntryReader.IsError()) break;
+
+		Delta.ApplyTo(*this);
+		NumApplied++;
+		OutValidBytes = Reader.Tell();
+	}
+	return NumApplied;
+}
+
+FWorldDelta FWorldDelta::Diff(const FWorldSnapshot& From, const FWorldSnapshot& To)
+{
+	FWorldDelta Delta;
+	for (const TPair<FString, TArray<uint8>>& Record : To.Records)
+	{
+		const TArray<uint8>* Previous = From.Records.Find(Record.Key);
+		if (!Previous || *Previous != Record.Value)
+		{
+			Delta.Upserts.Add(Record.Key, Record.Value);
+		}
+	}
+	for (const TPair<FString, TArray<uint8>>& Record : From.Records)
+	{
+		if (!To.Records.Contains(Record.Key))
+		{
+			Delta.Removals.Add(Record.Key);
+		}
+	}
+	return Delta;
+}
+
+void FWorldDelta::ApplyTo(FWorldSnapshot& Snapshot) const
+{
+	for (const TPair<FString, TArray<uint8>>& Record : Upserts)
+	{
+		Snapshot.Records.Add(Record.Key, Record.Value);
+	}
+	for (const FString& Key : Removals)
+	{
+		Snapshot.Records.Remove(Key);
+	}
+}
+
+void FWorldDelta::AppendJournalEntry(TArray<uint8>& OutBytes)
+{
+	TArray<uint8> EntryBytes;
+	FMemoryWriter EntryWriter(EntryBytes);
+	Serialize(EntryWriter);
+
+	FMemoryWriter Writer(OutBytes);
+	Writer.Seek(OutBytes.Num());
+
+	int32 Size = EntryBytes.Num();
+	Writer << Size;
+	Writer.Serialize(EntryBytes.GetData(), EntryBytes.Num());
+}
+
+void FWorldDelta::Serialize(FArchive& Ar)
+{
+	Ar << Sequence;
+	Ar << Upserts;
+	Ar << Removals;
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Serialized state of every saveable actor in a world, one opaque record per actor.
+ *
+ * File layout (.world):  Magic "FPWS", Version, Generation, Records
+ * Journal (.journal):    Magic "FPWJ", Version, Generation, then entries of
+ *                        [int32 Size][FWorldDelta, Size bytes]
+ *
+ * A journal only applies to the snapshot with the same Generation, so a journal left behind by a
+ * compaction that never finished is ignored instead of replayed onto the wrong snapshot.
+ */
+struct FWorldSnapshot
+{
+	/** Bumped every time a full snapshot is written */
+	uint32 Generation = 0;
+
+	TMap<FString, TArray<uint8>> Records;
+
+	void Save(TArray<uint8>& OutBytes);
+
+	/** False for a file of another format or version */
+	bool Load(const TArray<uint8>& Bytes);
+
+	/** Header of an empty journal for this snapshot */
+	void SaveJournalHeader(TArray<uint8>& OutBytes) const;
+
+	/**
+	 * Applies the entries of a journal written against this snapshot. Stops at the first entry that
+	 * was not written completely or does not read back. Returns the number of entries applied,
+	 * INDEX_NONE when the journal belongs to another generation. OutValidBytes is where the last
+	 * applied entry ends, anything after it is never replayed.
+	 */
+	int32 ReplayJournal(const TArray<uint8>& Bytes, int64& OutValidBytes);
+};
+
+/** What changed between two snapshots, one journal entry */
+struct FWorldDelta
+{
+	int32 Sequence = 0;
+
+	TMap<FString, TArray<uint8>> Upserts;
+	TArray<FString> Removals;
+
+	static FWorldDelta Diff(const FWorldSnapshot& From, const FWorldSnapshot& To);
+
+	bool IsEmpty() const { return Upserts.Num() == 0 && Removals.Num() == 0; }
+
+	void ApplyTo(FWorldSnapshot& Snapshot) const;
+
+	/** Appends this delta as one size-prefixed journal entry */
+	void AppendJournalEntry(TArray<uint8>& OutBytes);
+
+	void Serialize(FArchive& Ar);
+};
@@ -0,0 +1,465 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WorldStateSubsystem.h"
+#include "FirstProyect2.h"
+#include "SaveFileFormat.h"
+#include "SaveableActor.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Async/Async.h"
+
+DECLARE_CYCLE_STAT(TEXT("World State Capture"), STAT_WorldStateCapture, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("World State Apply"), STAT_WorldStateApply, STATGROUP_FirstProyect2);
+DECLARE_CYCLE_STAT(TEXT("World State Worker IO"), STAT_WorldStateWorkerIO, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("World Snapshot Bytes"), STAT_WorldSnapshotBytes, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("World Journal Bytes"), STAT_WorldJournalBytes, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("World Journal Entries"), STAT_WorldJournalEntries, STATGROUP_FirstProyect2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("World Journal Compactions"), STAT_WorldJournalCompactions, STATGROUP_FirstProyect2);
+
+static TAutoConsoleVariable<float> CVarAutosaveInterval(
+	TEXT("FirstProyect2.AutosaveInterval"),
+	30.f,
+	TEXT("Seconds between world state autosaves once the world has been saved or loaded. 0 disables autosaves."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarJournalCompactRatio(
+	TEXT("FirstProyect2.JournalCompactRatio"),
+	0.5f,
+	TEXT("An autosave writes a full world snapshot instead of a journal entry once the journal would grow past this fraction of the snapshot."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarJournalMaxEntries(
+	TEXT("FirstProyect2.JournalMaxEntries"),
+	64,
+	TEXT("An autosave writes a full world snapshot instead of a journal entry once the journal holds this many entries."),
+	ECVF_Default);
+
+UWorldStateSubsystem::UWorldStateSubsystem()
+{
+	bHasCommitted = false;
+	NextSequence = 0;
+	SnapshotBytes = 0;
+	JournalBytes = 0;
+	NumJournalEntries = 0;
+	bForceCompaction = false;
+	TimeSinceAutosave = 0.f;
+	bWriteInFlight = false;
+}
+
+void UWorldStateSubsystem::Deinitialize()
+{
+	while (NumWorkersBusy.GetValue() > 0)
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	// The completion of the last worker write never runs now, whatever is left goes out in order
+	for (const FPendingWrite& Write : PendingWrites)
+	{
+		WriteFile(Write);
+	}
+	PendingWrites.Reset();
+	Committed = FWorldSnapshot();
+
+	Super::Deinitialize();
+}
+
+bool UWorldStateSubsystem::IsTickable() const
+{
+	return bHasCommitted && CVarAutosaveInterval.GetValueOnGameThread() > 0.f;
+}
+
+ETickableTickType UWorldStateSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UWorldStateSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWorldStateSubsystem, STATGROUP_Tickables);
+}
+
+void UWorldStateSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceAutosave += DeltaTime;
+	if (TimeSinceAutosave < CVarAutosaveInterval.GetValueOnGameThread()) return;
+
+	Autosave();
+}
+
+FString UWorldStateSubsystem::GetRecordKey(const AActor* Actor)
+{
+	if (!Actor) return FString();
+
+	const APawn* Pawn = Cast<APawn>(Actor);
+	if (Pawn && Pawn->IsPlayerControlled()) return TEXT("Player");
+
+	// Spawned actors get new names every run, only what the level itself holds can be found again
+	if (!Actor->HasAnyFlags(RF_WasLoaded)) return FString();
+
+	return UWorld::RemovePIEPrefix(Actor->GetOutermost()->GetName()) + TEXT(":") + Actor->GetName();
+}
+
+void UWorldStateSubsystem::BindSlot(const FString& InSlotName)
+{
+	if (InSlotName == SlotName) return;
+	SlotName = InSlotName;
+
+	// Queued writes still go to the old slot's files, they carry their own paths
+	bHasCommitted = false;
+	Committed = FWorldSnapshot();
+	bForceCompaction = false;
+	NextSequence = 0;
+	SnapshotBytes = 0;
+	JournalBytes = 0;
+	NumJournalEntries = 0;
+}
+
+FString UWorldStateSubsystem::GetFileBase() const
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SaveGames"),
+		FString::Printf(TEXT("%s-%s"), *SlotName, *UGameplayStatics::GetCurrentLevelName(GetWorld())));
+}
+
+void UWorldStateSubsystem::Capture(FWorldSnapshot& OutSnapshot) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_WorldStateCapture);
+
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		ISaveableActor* Saveable = Cast<ISaveableActor>(*It);
+		if (!Saveable || It->IsPendingKillPending()) continue;
+
+		const FString Key = GetRecordKey(*It);
+		if (Key.IsEmpty()) continue;
+
+		TArray<uint8>& Bytes = OutSnapshot.Records.Add(Key);
+		FMemoryWriter Writer(Bytes);
+		Saveable->SerializeSaveState(Writer);
+	}
+}
+
+void UWorldStateSubsystem::Apply(const FWorldSnapshot& Snapshot, bool bRestorePlayer)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WorldStateApply);
+
+	int32 NumApplied = 0;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		ISaveableActor* Saveable = Cast<ISaveableActor>(*It);
+		if (!Saveable || It->IsPendingKillPending()) continue;
+
+		const FString Key = GetRecordKey(*It);
+		if (Key.IsEmpty() || (!bRestorePlayer && Key == TEXT("Player"))) continue;
+
+		if (const TArray<uint8>* Bytes = Snapshot.Records.Find(Key))
+		{
+			FMemoryReader Reader(*Bytes);
+			Saveable->SerializeSaveState(Reader);
+			NumApplied++;
+		}
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("WorldState: restored %d of %d records"), NumApplied, Snapshot.Records.Num());
+}
+
+void UWorldStateSubsystem::SaveSnapshot(const FString& InSlotName)
+{
+	BindSlot(InSlotName);
+
+	FWorldSnapshot Snapshot;
+	Capture(Snapshot);
+	WriteSnapshot(Snapshot);
+}
+
+void UWorldStateSubsystem::Autosave()
+{
+	TimeSinceAutosave = 0.f;
+
+	// Nothing was saved or loaded yet, there is no slot to write to
+	if (SlotName.IsEmpty()) return;
+
+	FWorldSnapshot Current;
+	Capture(Current);
+
+	if (!bHasCommitted || SnapshotBytes == 0 || bForceCompaction)
+	{
+		WriteSnapshot(Current);
+		return;
+	}
+
+	Current.Generation = Committed.Generation;
+	FWorldDelta Delta = FWorldDelta::Diff(Committed, Current);
+	if (Delta.IsEmpty()) return;
+
+	Delta.Sequence = NextSequence;
+	TArray<uint8> Entry;
+	Delta.AppendJournalEntry(Entry);
+
+	// Replaying a long journal costs more than writing the snapshot again
+	const bool bCompact = JournalBytes + Entry.Num() > (int64)(SnapshotBytes * CVarJournalCompactRatio.GetValueOnGameThread())
+		|| NumJournalEntries + 1 > CVarJournalMaxEntries.GetValueOnGameThread();
+	if (bCompact)
+	{
+		INC_DWORD_STAT(STAT_WorldJournalCompactions);
+		WriteSnapshot(Current);
+		return;
+	}
+
+	NextSequence++;
+	NumJournalEntries++;
+	JournalBytes += Entry.Num();
+	SET_DWORD_STAT(STAT_WorldJournalBytes, JournalBytes);
+	SET_DWORD_STAT(STAT_WorldJournalEntries, NumJournalEntries);
+
+	Committed = MoveTemp(Current);
+	QueueWrite(GetFileBase() + TEXT(".journal"), MoveTemp(Entry), true);
+}
+
+void UWorldStateSubsystem::WriteSnapshot(FWorldSnapshot& Snapshot)
+{
+	// Any journal still on disk belongs to the previous generation and is ignored from now on
+	uint32 Generation = HashCombine(GetTypeHash(FDateTime::UtcNow().GetTicks()), Committed.Generation);
+	Snapshot.Generation = Generation != Committed.Generation ? Generation : Generation + 1;
+
+	TArray<uint8> SnapshotData;
+	Snapshot.Save(SnapshotData);
+	TArray<uint8> JournalHeader;
+	Snapshot.SaveJournalHeader(JournalHeader);
+
+	bHasCommitted = true;
+	bForceCompaction = false;
+	NextSequence = 0;
+	NumJournalEntries = 0;
+	SnapshotBytes = SnapshotData.Num();
+	JournalBytes = JournalHeader.Num();
+	SET_DWORD_STAT(STAT_WorldSnapshotBytes, SnapshotBytes);
+	SET_DWORD_STAT(STAT_WorldJournalBytes, JournalBytes);
+	SET_DWORD_STAT(STAT_WorldJournalEntries, 0);
+
+	Committed = MoveTemp(Snapshot);
+	TimeSinceAutosave = 0.f;
+
+	const FString FileBase = GetFileBase();
+	QueueWrite(FileBase + TEXT(".world"), MoveTemp(SnapshotData), false, true);
+	QueueWrite(FileBase + TEXT(".journal"), MoveTemp(JournalHeader), false);
+}
+
+void UWorldStateSubsystem::QueueWrite(const FString& Path, TArray<uint8>&& Bytes, bool bAppend, bool bCompress)
+{
+	FPendingWrite& Write = PendingWrites.AddDefaulted_GetRef();
+	Write.Path = Path;
+	Write.Bytes = MoveTemp(Bytes);
+	Write.bAppend = bAppend;
+	Write.bCompress = bCompress;
+
+	StartNextWrite();
+}
+
+void UWorldStateSubsystem::StartNextWrite()
+{
+	if (bWriteInFlight || PendingWrites.Num() == 0) return;
+	bWriteInFlight = true;
+
+	FPendingWrite Write = MoveTemp(PendingWrites[0]);
+	PendingWrites.RemoveAt(0, 1, false);
+
+	NumWorkersBusy.Increment();
+
+	// Deinitialize waits for the counter, so it outlives every worker
+	FThreadSafeCounter* WorkersBusy = &NumWorkersBusy;
+	TWeakObjectPtr<UWorldStateSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, WorkersBusy, Write = MoveTemp(Write)]()
+	{
+		bool bSuccess = false;
+		{
+			SCOPE_CYCLE_COUNTER(STAT_WorldStateWorkerIO);
+			bSuccess = WriteFile(Write);
+		}
+		if (!bSuccess)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("WorldState: could not write %s"), *Write.Path);
+		}
+		const bool bJournal = Write.bAppend;
+		WorkersBusy->Decrement();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, bSuccess, bJournal]()
+		{
+			if (UWorldStateSubsystem* WorldState = WeakThis.Get())
+			{
+				WorldState->OnWriteFinished(bSuccess, bJournal);
+			}
+		});
+	});
+}
+
+void UWorldStateSubsystem::OnWriteFinished(bool bSuccess, bool bJournal)
+{
+	// The journal on disk is missing this entry, the next autosave rewrites everything
+	bForceCompaction |= bJournal && !bSuccess;
+
+	bWriteInFlight = false;
+	StartNextWrite();
+}
+
+bool UWorldStateSubsystem::WriteFile(const FPendingWrite& Write)
+{
+	if (Write.bAppend)
+	{
+		return FFileHelper::SaveArrayToFile(Write.Bytes, *Write.Path, &IFileManager::Get(), FILEWRITE_Append);
+	}
+
+	TArray<uint8> FileBytes;
+	if (Write.bCompress)
+	{
+		FSaveSlotSummary Summary;
+		Summary.SlotName = FPaths::GetBaseFilename(Write.Path);
+		Summary.Timestamp = FDateTime::UtcNow();
+		FSaveFileHeader::Write(Summary, Write.Bytes, FSaveFileHeader::GetDefaultCompression(), FileBytes);
+	}
+
+	// Replaced in one move, a crash mid-write leaves the old file intact
+	const FString TempPath = Write.Path + TEXT(".tmp");
+	return FFileHelper::SaveArrayToFile(Write.bCompress ? FileBytes : Write.Bytes, *TempPath) && IFileManager::Get().Move(*Write.Path, *TempPath, true);
+}
+
+void UWorldStateSubsystem::RestoreAsync(const FString& InSlotName, bool bRestorePlayer)
+{
+	BindSlot(InSlotName);
+
+	// Queued writes are not on disk yet, but Committed already holds what they will write
+	if (bHasCommitted)
+	{
+		Apply(Committed, bRestorePlayer);
+		return;
+	}
+
+	NumWorkersBusy.Increment();
+
+	const FString FileBase = GetFileBase();
+	FThreadSafeCounter* WorkersBusy = &NumWorkersBusy;
+	TWeakObjectPtr<UWorldStateSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, WorkersBusy, FileBase, InSlotName, bRestorePlayer]()
+	{
+		FWorldSnapshot Loaded;
+		int64 LoadedSnapshotBytes = 0;
+		int64 LoadedJournalBytes = 0;
+		bool bJournalDamaged = false;
+		int32 NumEntries = 0;
+		{
+			SCOPE_CYCLE_COUNTER(STAT_WorldStateWorkerIO);
+
+			TArray<uint8> Bytes;
+			FSaveFileHeader Header;
+			TArray<uint8> SnapshotData;
+			bool bRead = FFileHelper::LoadFileToArray(Bytes, *(FileBase + TEXT(".world")), FILEREAD_Silent);
+			if (bRead && FSaveFileHeader::HasHeader(Bytes))
+			{
+				bRead = FSaveFileHeader::Read(Bytes, Header, SnapshotData);
+				Bytes = MoveTemp(SnapshotData);
+				if (!bRead)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("WorldState: %s.world is damaged"), *FileBase);
+				}
+			}
+
+			if (bRead && Loaded.Load(Bytes))
+			{
+				LoadedSnapshotBytes = Bytes.Num();
+
+				Bytes.Reset();
+				if (FFileHelper::LoadFileToArray(Bytes, *(FileBase + TEXT(".journal")), FILEREAD_Silent))
+				{
+					NumEntries = Loaded.ReplayJournal(Bytes, LoadedJournalBytes);
+					bJournalDamaged = NumEntries != INDEX_NONE && LoadedJournalBytes < Bytes.Num();
+					if (bJournalDamaged)
+					{
+						UE_LOG(LogTemp, Warning, TEXT("WorldState: %s.journal is damaged after %d entries"), *FileBase, NumEntries);
+					}
+				}
+			}
+			else
+			{
+				Loaded = FWorldSnapshot();
+			}
+		}
+		WorkersBusy->Decrement();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Loaded = MoveTemp(Loaded), LoadedSnapshotBytes, LoadedJournalBytes, bJournalDamaged, NumEntries, InSlotName, bRestorePlayer]() mutable
+		{
+			UWorldStateSubsystem* WorldState = WeakThis.Get();
+			if (!WorldState) return;
+
+			// Another slot was saved or loaded while the files were read
+			if (WorldState->SlotName != InSlotName) return;
+
+			// Saved while the files were read, that save is newer than what was read
+			if (WorldState->bHasCommitted)
+			{
+				WorldState->Apply(WorldState->Committed, bRestorePlayer);
+				return;
+			}
+
+			WorldState->bHasCommitted = true;
+			WorldState->SnapshotBytes = LoadedSnapshotBytes;
+			WorldState->JournalBytes = LoadedJournalBytes;
+			WorldState->NumJournalEntries = FMath::Max(NumEntries, 0);
+			WorldState->NextSequence = WorldState->NumJournalEntries;
+
+			// Entries appended behind a journal of another generation, or behind a damaged entry, would never be replayed
+			WorldState->bForceCompaction = LoadedSnapshotBytes > 0 && (NumEntries == INDEX_NONE || bJournalDamaged);
+			WorldState->TimeSinceAutosave = 0.f;
+
+			SET_DWORD_STAT(STAT_WorldSnapshotBytes, WorldState->SnapshotBytes);
+			SET_DWORD_STAT(STAT_WorldJournalBytes, WorldState->JournalBytes);
+			SET_DWORD_STAT(STAT_WorldJournalEntries, WorldState->NumJournalEntries);
+
+			WorldState->Committed = MoveTemp(Loaded);
+			WorldState->Apply(WorldState->Committed, bRestorePlayer);
+		});
+	});
+}
+
+void UWorldStateSubsystem::DumpState() const
+{
+	UE_LOG(LogTemp, Display, TEXT("WorldState %s: %s, generation %u, %d records"), *GetFileBase(),
+		bHasCommitted ? TEXT("bound") : TEXT("not saved or loaded yet"), Committed.Generation, Committed.Records.Num());
+	UE_LOG(LogTemp, Display, TEXT("  snapshot %lld bytes, journal %lld bytes in %d entries, %d writes queued"),
+		SnapshotBytes, JournalBytes, NumJournalEntries, PendingWrites.Num() + (bWriteInFlight ? 1 : 0));
+
+	for (const TPair<FString, TArray<uint8>>& Record : Committed.Records)
+	{
+		UE_LOG(LogTemp, Display, TEXT("  %-48s %4d bytes"), *Record.Key, Record.Value.Num());
+	}
+}
+
+static FAutoConsoleCommandWithWorld WorldStateDumpCommand(
+	TEXT("FirstProyect2.WorldState"),
+	TEXT("Logs the saved world state records and the snapshot and journal sizes"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UWorldStateSubsystem* WorldState = World ? World->GetSubsystem<UWorldStateSubsystem>() : nullptr)
+		{
+			WorldState->DumpState();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld WorldStateAutosaveCommand(
+	TEXT("FirstProyect2.Autosave"),
+	TEXT("Writes a world state autosave now"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UWorldStateSubsystem* WorldState = World ? World->GetSubsystem<UWorldStateSubsystem>() : nullptr)
+		{
+			WorldState->Autosave();
+		}
+	}));
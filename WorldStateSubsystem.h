@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldSnapshot.h"
+#include "WorldStateSubsystem.generated.h"
+
+/**
+ * Keeps the state of the level placed ISaveableActors and the player in Saved/SaveGames, one
+ * snapshot per save slot and map. A full save writes <Slot>-<Map>.world and starts an empty
+ * journal; autosaves append only the records that changed since the last write to
+ * <Slot>-<Map>.journal. Once the journal outgrows FirstProyect2.JournalCompactRatio of the
+ * snapshot, or FirstProyect2.JournalMaxEntries entries, the next autosave writes a full snapshot
+ * instead. Files are written on a worker, one at a time and in order. Snapshots are stored
+ * compressed behind an FSaveFileHeader; the journal stays raw so it can be appended to.
+ */
+UCLASS()
+class FIRSTPROYECT2_API UWorldStateSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UWorldStateSubsystem();
+
+	/** Writes whatever is still queued */
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** Full snapshot into the files of the slot, truncates the journal; autosaves go to this slot from now on */
+	void SaveSnapshot(const FString& InSlotName);
+
+	/** Journal entry with what changed since the last write, or a full snapshot when it is time to compact */
+	void Autosave();
+
+	/**
+	 * Reads the snapshot and journal of the slot on a worker and applies them; the player's record
+	 * only with bRestorePlayer. Autosaves go to this slot from now on.
+	 */
+	void RestoreAsync(const FString& InSlotName, bool bRestorePlayer);
+
+	/** "Player" for the player, <Package>:<Actor> for level placed actors, empty for anything not saved */
+	static FString GetRecordKey(const AActor* Actor);
+
+	void DumpState() const;
+
+private:
+
+	struct FPendingWrite
+	{
+		FString Path;
+		TArray<uint8> Bytes;
+
+		/** Appends to the journal instead of replacing the file */
+		bool bAppend = false;
+
+		/** Written behind an FSaveFileHeader, compressed on the worker */
+		bool bCompress = false;
+	};
+
+	void Capture(FWorldSnapshot& OutSnapshot) const;
+
+	void Apply(const FWorldSnapshot& Snapshot, bool bRestorePlayer);
+
+	void WriteSnapshot(FWorldSnapshot& Snapshot);
+
+	void QueueWrite(const FString& Path, TArray<uint8>&& Bytes, bool bAppend, bool bCompress = false);
+	void StartNextWrite();
+	void OnWriteFinished(bool bSuccess, bool bJournal);
+
+	static bool WriteFile(const FPendingWrite& Write);
+
+	/** Switches to another slot, whatever was committed for the previous one no longer applies */
+	void BindSlot(const FString& InSlotName);
+
+	FString GetFileBase() const;
+
+	/** Slot the files belong to, set by the first save or load */
+	FString SlotName;
+
+	/** State the files on disk hold once every queued write is done */
+	FWorldSnapshot Committed;
+	bool bHasCommitted;
+
+	int32 NextSequence;
+	int64 SnapshotBytes;
+	int64 JournalBytes;
+	int32 NumJournalEntries;
+
+	/** A journal append failed, the journal on disk no longer matches Committed */
+	bool bForceCompaction;
+
+	float TimeSinceAutosave;
+
+	TArray<FPendingWrite> PendingWrites;
+	bool bWriteInFlight;
+
+	/** Worker tasks that still write or read a file */
+	FThreadSafeCounter NumWorkersBusy;
+};